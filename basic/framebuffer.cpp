@@ -1,13 +1,37 @@
 #include "basic/framebuffer.h"
 
+#include "basic/render_state.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
+std::vector<int> object_id_readback::unique_ids() const {
+  std::vector<int> result;
+  for (int id : ids) {
+    if (id != -1) {
+      result.push_back(id);
+    }
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
 framebuffer::framebuffer(int _width, int _height)
     : m_width(_width), m_height(_height) {
   create_framebuffer(_width, _height);
 }
 
-framebuffer::~framebuffer() { destroy_framebuffer(); }
+framebuffer::~framebuffer() {
+  cancel_object_id_requests();
+  for (auto &slot : m_readbacks) {
+    if (slot.buffer != 0) {
+      render_state::instance().forget_buffer(slot.buffer);
+      glDeleteBuffers(1, &slot.buffer);
+    }
+  }
+  destroy_framebuffer();
+}
 
 void framebuffer::create_framebuffer(int _width, int _height) {
   m_width = _width;
@@ -19,7 +43,7 @@ void framebuffer::create_framebuffer(int _width, int _height) {
 
   // Create color texture
   glGenTextures(1, &m_color_texture);
-  glBindTexture(GL_TEXTURE_2D, m_color_texture);
+  render_state::instance().bind_texture(GL_TEXTURE_2D, m_color_texture);
   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, _width, _height, 0, GL_RGB,
                GL_UNSIGNED_BYTE, nullptr);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -29,7 +53,7 @@ void framebuffer::create_framebuffer(int _width, int _height) {
 
   // Create object ID texture (one unsigned int per pixel, for picking)
   glGenTextures(1, &m_object_id_texture);
-  glBindTexture(GL_TEXTURE_2D, m_object_id_texture);
+  render_state::instance().bind_texture(GL_TEXTURE_2D, m_object_id_texture);
   glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, _width, _height, 0, GL_RED_INTEGER,
                GL_UNSIGNED_INT, nullptr);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -64,10 +88,12 @@ void framebuffer::destroy_framebuffer() {
     m_FBO = 0;
   }
   if (m_color_texture != 0) {
+    render_state::instance().forget_texture(m_color_texture);
     glDeleteTextures(1, &m_color_texture);
     m_color_texture = 0;
   }
   if (m_object_id_texture != 0) {
+    render_state::instance().forget_texture(m_object_id_texture);
     glDeleteTextures(1, &m_object_id_texture);
     m_object_id_texture = 0;
   }
@@ -82,6 +108,8 @@ void framebuffer::resize(int _width, int _height) {
     return; // No need to resize
   }
 
+  // Requested regions may be outside the new size
+  cancel_object_id_requests();
   destroy_framebuffer();
   create_framebuffer(_width, _height);
 }
@@ -113,6 +141,105 @@ int framebuffer::read_object_id(int x, int y) const {
   return (int)id;
 }
 
+unsigned long long framebuffer::request_object_ids(int x, int y, int width,
+                                                   int height) {
+  const int x0 = std::max(x, 0);
+  const int y0 = std::max(y, 0);
+  const int x1 = std::min(x + width, m_width);
+  const int y1 = std::min(y + height, m_height);
+  if (x1 <= x0 || y1 <= y0) {
+    return 0;
+  }
+  readback_slot *free_slot = nullptr;
+  for (auto &slot : m_readbacks) {
+    if (!slot.fence) {
+      free_slot = &slot;
+      break;
+    }
+  }
+  if (!free_slot) {
+    return 0;
+  }
+
+  readback_slot &slot = *free_slot;
+  const GLsizeiptr size =
+      static_cast<GLsizeiptr>(x1 - x0) * (y1 - y0) * sizeof(unsigned int);
+  if (slot.buffer == 0) {
+    glGenBuffers(1, &slot.buffer);
+  }
+  render_state::instance().bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  if (size > slot.capacity) {
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    slot.capacity = size;
+  }
+  // With a pack buffer bound, glReadPixels queues a copy into it at offset
+  // 0 and returns at once
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, m_FBO);
+  glReadBuffer(GL_COLOR_ATTACHMENT1);
+  glReadPixels(x0, y0, x1 - x0, y1 - y0, GL_RED_INTEGER, GL_UNSIGNED_INT,
+               nullptr);
+  glReadBuffer(GL_COLOR_ATTACHMENT0);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+  render_state::instance().bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  slot.region.x = x0;
+  slot.region.y = y0;
+  slot.region.width = x1 - x0;
+  slot.region.height = y1 - y0;
+  slot.region.serial = ++m_readback_serial;
+  return slot.region.serial;
+}
+
+bool framebuffer::poll_object_ids(object_id_readback &_result) {
+  readback_slot *oldest = nullptr;
+  for (auto &slot : m_readbacks) {
+    if (slot.fence &&
+        (!oldest || slot.region.serial < oldest->region.serial)) {
+      oldest = &slot;
+    }
+  }
+  if (!oldest) {
+    return false;
+  }
+  if (!fence_signaled(oldest->fence)) {
+    return false;
+  }
+  glDeleteSync(oldest->fence);
+  oldest->fence = nullptr;
+
+  _result.x = oldest->region.x;
+  _result.y = oldest->region.y;
+  _result.width = oldest->region.width;
+  _result.height = oldest->region.height;
+  _result.serial = oldest->region.serial;
+  const size_t count = static_cast<size_t>(_result.width) * _result.height;
+  _result.ids.resize(count);
+  render_state::instance().bind_buffer(GL_PIXEL_PACK_BUFFER, oldest->buffer);
+  const void *data =
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                       static_cast<GLsizeiptr>(count * sizeof(unsigned int)),
+                       GL_MAP_READ_BIT);
+  if (data) {
+    // 0xFFFFFFFF, the cleared value, becomes -1 like in read_object_id
+    std::memcpy(_result.ids.data(), data, count * sizeof(unsigned int));
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  } else {
+    std::fill(_result.ids.begin(), _result.ids.end(), -1);
+  }
+  render_state::instance().bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+  return true;
+}
+
+void framebuffer::cancel_object_id_requests() {
+  for (auto &slot : m_readbacks) {
+    if (slot.fence) {
+      glDeleteSync(slot.fence);
+      slot.fence = nullptr;
+    }
+  }
+}
+
 void framebuffer::reset_object_id_texture() {
   // FBO must be bound when calling; we do not unbind so rendering can continue
   // to this FBO
@@ -1,6 +1,21 @@
 #pragma once
 
 #include <glad/gl.h>
+#include <vector>
+
+// Object IDs of a framebuffer region, read back by
+// framebuffer::request_object_ids
+struct object_id_readback {
+  int x = 0; // Region in pixels; (0,0) is bottom-left
+  int y = 0;
+  int width = 0;
+  int height = 0;
+  std::vector<int> ids; // Row by row from the bottom; -1 where no object
+  unsigned long long serial = 0; // Returned by request_object_ids
+
+  // Distinct IDs in the region, without -1, for rectangle selection
+  std::vector<int> unique_ids() const;
+};
 
 // Framebuffer class for rendering to texture
 class framebuffer {
@@ -31,9 +46,24 @@ public:
   void reset_object_id_texture();
 
   // Read object ID at pixel (x, y); (0,0) is bottom-left. Returns 0 if no
-  // object.
+  // object. Waits for the GPU to finish the frame; prefer
+  // request_object_ids.
   int read_object_id(int x, int y) const;
 
+  // Start copying the object IDs of a region into a pixel buffer, without
+  // waiting for the GPU. The region is clipped to the framebuffer. Returns
+  // the request's serial, or 0 if the region is empty or all
+  // k_readback_slots requests are still in flight.
+  unsigned long long request_object_ids(int x, int y, int width = 1,
+                                        int height = 1);
+
+  // Take the oldest finished request, usually one or two frames after it
+  // was made. Returns false if none has finished yet; never blocks.
+  bool poll_object_ids(object_id_readback &_result);
+
+  // Drop requests in flight, e.g. when their pixels no longer exist
+  void cancel_object_id_requests();
+
   // Get framebuffer dimensions
   int get_width() const { return m_width; }
   int get_height() const { return m_height; }
@@ -41,7 +71,18 @@ public:
   // Check if framebuffer is complete
   bool is_complete() const;
 
+  // Requests that can be in flight at once
+  static constexpr int k_readback_slots = 3;
+
 private:
+  // Pixel buffer and fence of one request in flight
+  struct readback_slot {
+    GLuint buffer = 0;
+    GLsizeiptr capacity = 0;
+    GLsync fence = nullptr;
+    object_id_readback region; // ids unused until poll_object_ids
+  };
+
   void create_framebuffer(int _width, int _height);
   void destroy_framebuffer();
 
@@ -51,4 +92,6 @@ private:
   unsigned int m_depth_stencil_RBO = 0;
   int m_width = 0;
   int m_height = 0;
+  readback_slot m_readbacks[k_readback_slots];
+  unsigned long long m_readback_serial = 0;
 };
@@ -4,6 +4,8 @@
 #include "glm/glm.hpp"
 #include "imgui.h"
 
+#include <algorithm>
+
 namespace {
 
 void apply_simple_light_terms(light &_light) {
@@ -91,6 +93,28 @@ void uniform(shader &_shader, const light &_light, std::string _name) {
   _shader.set_uniform((_name + ".outer_cutoff").c_str(), outer_cutoff_cos);
 }
 
+// -----------------------------------------------------------------------------
+void write_block(const light *_lights, size_t _count, light_block &_block) {
+  _block = {};
+  _count = std::min(_count, light_block::k_max_lights);
+  for (size_t i = 0; i < _count; i++) {
+    const light &source = _lights[i];
+    light_block_entry &entry = _block.lights[i];
+    entry.position = source.Position;
+    entry.constant = source.Constant;
+    entry.direction = source.Direction;
+    entry.linear = source.Linear;
+    entry.ambient = source.Ambient;
+    entry.quadratic = source.Quadratic;
+    entry.diffuse = source.Diffuse;
+    entry.cutoff = glm::cos(glm::radians(source.Cutoff));
+    entry.specular = source.Specular;
+    entry.outer_cutoff = glm::cos(glm::radians(source.OuterCutoff));
+    entry.type = static_cast<int>(source.Type);
+  }
+  _block.count = static_cast<int>(_count);
+}
+
 // -----------------------------------------------------------------------------
 void ui(light &_light) {
   constexpr ImGuiTreeNodeFlags root_flags =
@@ -2,6 +2,9 @@
 
 #include "glm/glm.hpp"
 #include "shader.h"
+#include "uniform_buffer.h"
+
+#include <cstddef>
 
 /**
  * @brief Light type
@@ -68,6 +71,16 @@ struct light {
  */
 void uniform(shader &_shader, const light &_light, std::string _name);
 
+// -----------------------------------------------------------------------------
+/**
+ * @brief Fill a light block; lights past light_block::k_max_lights are
+ * dropped
+ * @param _lights Lights of the frame
+ * @param _count Number of lights
+ * @param _block Block to fill
+ */
+void write_block(const light *_lights, size_t _count, light_block &_block);
+
 // -----------------------------------------------------------------------------
 /**
  * @brief UI for a light (type combo, then simple/advanced checkbox, then fields)
@@ -61,6 +61,15 @@ void uniform(shader &_shader, const material &_material, std::string _name) {
   _shader.set_uniform((_name + ".shininess").c_str(), _material.Shininess);
 }
 
+// -----------------------------------------------------------------------------
+void write_block(const material &_material, material_block &_block) {
+  _block = {};
+  _block.ambient = _material.Ambient;
+  _block.shininess = _material.Shininess;
+  _block.diffuse = _material.Diffuse;
+  _block.specular = _material.Specular;
+}
+
 // -----------------------------------------------------------------------------
 void ui(material &_material) {
   constexpr ImGuiTreeNodeFlags root_flags = ImGuiTreeNodeFlags_DefaultOpen;
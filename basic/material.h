@@ -2,6 +2,7 @@
 
 #include "basic/shader.h"
 #include "basic/texture.h"
+#include "basic/uniform_buffer.h"
 #include "glm/glm.hpp"
 
 /**
@@ -45,6 +46,13 @@ struct texture_material {
  */
 void uniform(shader &_shader, const material &_material, std::string _name);
 
+/**
+ * @brief Fill a material block
+ * @param _material The material to write
+ * @param _block Block to fill
+ */
+void write_block(const material &_material, material_block &_block);
+
 /**
  * @brief UI for a material
  * @param _material The material to display in the UI
@@ -0,0 +1,189 @@
+#include "basic/program_binary_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+constexpr char k_magic[8] = {'L', 'O', 'G', 'L', 'P', 'R', 'O', 'G'};
+constexpr std::uint32_t k_version = 1;
+
+struct binary_header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t format; // GLenum from glGetProgramBinary
+  std::uint64_t key;
+  std::uint64_t length; // Bytes of binary after the header
+};
+
+constexpr std::uint64_t k_fnv_offset = 14695981039346656037ull;
+
+std::uint64_t fnv1a(std::uint64_t _hash, const void *_data, size_t _size) {
+  const unsigned char *bytes = static_cast<const unsigned char *>(_data);
+  for (size_t i = 0; i < _size; i++) {
+    _hash ^= bytes[i];
+    _hash *= 1099511628211ull;
+  }
+  return _hash;
+}
+
+std::uint64_t fnv1a(std::uint64_t _hash, const std::string &_text) {
+  // The length keeps "ab" + "c" apart from "a" + "bc"
+  const std::uint64_t length = _text.size();
+  _hash = fnv1a(_hash, &length, sizeof(length));
+  return fnv1a(_hash, _text.data(), _text.size());
+}
+
+std::string gl_string(GLenum _name) {
+  const GLubyte *value = glGetString(_name);
+  return value ? reinterpret_cast<const char *>(value) : "";
+}
+
+// A failed glProgramBinary leaves an error that the next check would blame
+// on an unrelated call
+void clear_gl_errors() {
+  while (glGetError() != GL_NO_ERROR) {
+  }
+}
+
+} // namespace
+
+program_binary_cache &program_binary_cache::instance() {
+  static program_binary_cache cache;
+  return cache;
+}
+
+bool program_binary_cache::is_supported() {
+  if (m_supported < 0) {
+    GLint format_count = 0;
+    if (GLAD_GL_ARB_get_program_binary) {
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    }
+    m_supported = format_count > 0 ? 1 : 0;
+    std::uint64_t hash = k_fnv_offset;
+    hash = fnv1a(hash, gl_string(GL_VENDOR));
+    hash = fnv1a(hash, gl_string(GL_RENDERER));
+    hash = fnv1a(hash, gl_string(GL_VERSION));
+    m_driver_hash = hash;
+  }
+  return m_supported == 1;
+}
+
+std::uint64_t program_binary_cache::make_key(const std::string *_sources,
+                                             size_t _count) {
+  is_supported(); // Sets m_driver_hash
+  std::uint64_t hash =
+      fnv1a(k_fnv_offset, &m_driver_hash, sizeof(m_driver_hash));
+  for (size_t i = 0; i < _count; i++) {
+    hash = fnv1a(hash, _sources[i]);
+  }
+  return hash;
+}
+
+std::string program_binary_cache::file_path(std::uint64_t _key) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.bin",
+                static_cast<unsigned long long>(_key));
+  return (std::filesystem::path(m_directory) / name).string();
+}
+
+GLuint program_binary_cache::load(std::uint64_t _key) {
+  if (!m_enabled || !is_supported()) {
+    m_miss_count++;
+    return 0;
+  }
+  const std::string path = file_path(_key);
+  std::ifstream in(path, std::ios::binary);
+  binary_header header{};
+  if (!in || !in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      std::memcmp(header.magic, k_magic, sizeof(k_magic)) != 0 ||
+      header.version != k_version || header.key != _key ||
+      header.length == 0 || header.length > 0x7fffffffu) {
+    m_miss_count++;
+    return 0;
+  }
+  std::vector<char> binary(static_cast<size_t>(header.length));
+  if (!in.read(binary.data(), static_cast<std::streamsize>(binary.size()))) {
+    m_miss_count++;
+    return 0;
+  }
+  in.close();
+
+  GLuint program = glCreateProgram();
+  glProgramBinary(program, header.format, binary.data(),
+                  static_cast<GLsizei>(binary.size()));
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (linked != GL_TRUE) {
+    // Written by another driver build, or damaged; store() replaces it
+    glDeleteProgram(program);
+    clear_gl_errors();
+    std::remove(path.c_str());
+    m_miss_count++;
+    return 0;
+  }
+  m_hit_count++;
+  return program;
+}
+
+void program_binary_cache::prepare(GLuint _program) {
+  if (m_enabled && is_supported()) {
+    glProgramParameteri(_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+}
+
+bool program_binary_cache::store(std::uint64_t _key, GLuint _program) {
+  if (!m_enabled || !is_supported()) {
+    return false;
+  }
+  GLint length = 0;
+  glGetProgramiv(_program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) {
+    return false;
+  }
+  std::vector<char> binary(static_cast<size_t>(length));
+  GLenum format = 0;
+  GLsizei written_length = 0;
+  glGetProgramBinary(_program, length, &written_length, &format,
+                     binary.data());
+  if (written_length <= 0) {
+    clear_gl_errors();
+    return false;
+  }
+
+  binary_header header{};
+  std::memcpy(header.magic, k_magic, sizeof(k_magic));
+  header.version = k_version;
+  header.format = format;
+  header.key = _key;
+  header.length = static_cast<std::uint64_t>(written_length);
+
+  std::error_code error;
+  std::filesystem::create_directories(m_directory, error);
+  // Write to a temporary file and rename it, so a reader never sees a
+  // partial binary
+  const std::string path = file_path(_key);
+  const std::string temp_path = path + ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      return false;
+    }
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(binary.data(), written_length);
+    if (!out) {
+      out.close();
+      std::remove(temp_path.c_str());
+      return false;
+    }
+  }
+  std::filesystem::rename(temp_path, path, error);
+  if (error) {
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
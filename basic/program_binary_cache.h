@@ -0,0 +1,88 @@
+#pragma once
+
+#include <glad/gl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief On-disk cache of linked shader programs
+ *
+ * Uses GL_ARB_get_program_binary (core in GL 4.1). A program is keyed by a
+ * hash of its stage sources and the GL vendor, renderer and version strings,
+ * so a driver update invalidates the cache. Each program is one file in the
+ * cache directory. Without the extension, or without any binary format,
+ * every load misses and programs are compiled as usual.
+ */
+class program_binary_cache {
+public:
+  /**
+   * @brief Process-wide cache; use it from the GL thread only
+   */
+  static program_binary_cache &instance();
+
+  /**
+   * @brief Whether the context can save and load program binaries. Queried
+   * on first use, so a context must be current.
+   */
+  bool is_supported();
+
+  /**
+   * @brief Key of a program
+   * @param _sources Source of every stage slot, empty for unused stages
+   * @param _count Number of slots
+   */
+  std::uint64_t make_key(const std::string *_sources, size_t _count);
+
+  /**
+   * @brief Create a program from its cached binary
+   * @param _key Key from make_key
+   * @return Linked program, or 0 on a miss. A binary the driver rejects is
+   * deleted and counts as a miss.
+   */
+  GLuint load(std::uint64_t _key);
+
+  /**
+   * @brief Ask the driver to keep the binary of a program about to be linked
+   * @param _program Program that has not been linked yet
+   */
+  void prepare(GLuint _program);
+
+  /**
+   * @brief Save the binary of a linked program
+   * @param _key Key from make_key
+   * @param _program Program prepared with prepare() and linked
+   * @return False if unsupported or the file cannot be written
+   */
+  bool store(std::uint64_t _key, GLuint _program);
+
+  /**
+   * @brief Directory of the cache files, relative to the working directory
+   * by default
+   */
+  void set_directory(const std::string &_directory) {
+    m_directory = _directory;
+  }
+  const std::string &get_directory() const { return m_directory; }
+
+  /**
+   * @brief Loads answered from and missing in the cache so far
+   */
+  size_t get_hit_count() const { return m_hit_count; }
+  size_t get_miss_count() const { return m_miss_count; }
+
+  // Set to false to always compile, e.g. while debugging a driver
+  bool m_enabled = true;
+
+private:
+  program_binary_cache() = default;
+
+  std::string file_path(std::uint64_t _key) const;
+
+  int m_supported = -1; // Not queried yet
+  std::uint64_t m_driver_hash = 0;
+  std::string m_directory = "shader_cache";
+  size_t m_hit_count = 0;
+  size_t m_miss_count = 0;
+};
@@ -0,0 +1,267 @@
+#include "basic/render_state.h"
+
+#include <algorithm>
+#include <iterator>
+
+render_state &render_state::instance() {
+  static render_state state;
+  return state;
+}
+
+render_state::render_state() { invalidate(); }
+
+void render_state::begin_frame() {
+  m_last_issued = m_issued;
+  m_last_skipped = m_skipped;
+  m_issued = 0;
+  m_skipped = 0;
+  invalidate();
+}
+
+void render_state::invalidate() {
+  m_program = k_unknown;
+  m_vertex_array = k_unknown;
+  std::fill(std::begin(m_buffers), std::end(m_buffers), k_unknown);
+  for (buffer_range &range : m_uniform_ranges) {
+    range = {k_unknown, 0, 0};
+  }
+  m_active_unit = k_unknown;
+  for (GLuint(&unit)[2] : m_textures) {
+    unit[0] = unit[1] = k_unknown;
+  }
+  for (auto &capability : m_capabilities) {
+    capability.second = k_unknown;
+  }
+  std::fill(std::begin(m_blend), std::end(m_blend), k_unknown);
+  m_depth_func = k_unknown;
+  m_depth_mask = k_unknown;
+  std::fill(std::begin(m_stencil_func), std::end(m_stencil_func), k_unknown);
+  std::fill(std::begin(m_stencil_op), std::end(m_stencil_op), k_unknown);
+  m_stencil_mask = k_unknown;
+}
+
+template <typename tValue>
+bool render_state::change(tValue &_shadow, tValue _value) {
+  if (m_enabled && _shadow == _value) {
+    m_skipped++;
+    return false;
+  }
+  _shadow = _value;
+  m_issued++;
+  return true;
+}
+
+size_t render_state::buffer_slot(GLenum _target) {
+  for (size_t i = 0; i < k_buffer_target_count; i++) {
+    if (k_buffer_targets[i] == _target) {
+      return i;
+    }
+  }
+  return k_buffer_target_count;
+}
+
+size_t render_state::texture_slot(GLenum _target) {
+  switch (_target) {
+  case GL_TEXTURE_2D:
+    return 0;
+  case GL_TEXTURE_CUBE_MAP:
+    return 1;
+  default:
+    return 2;
+  }
+}
+
+void render_state::use_program(GLuint _program) {
+  if (change(m_program, _program)) {
+    glUseProgram(_program);
+  }
+}
+
+void render_state::bind_vertex_array(GLuint _vertex_array) {
+  if (change(m_vertex_array, _vertex_array)) {
+    glBindVertexArray(_vertex_array);
+    m_buffers[buffer_slot(GL_ELEMENT_ARRAY_BUFFER)] = k_unknown;
+  }
+}
+
+void render_state::bind_buffer(GLenum _target, GLuint _buffer) {
+  const size_t slot = buffer_slot(_target);
+  if (slot == k_buffer_target_count) {
+    m_issued++;
+    glBindBuffer(_target, _buffer);
+    return;
+  }
+  if (change(m_buffers[slot], _buffer)) {
+    glBindBuffer(_target, _buffer);
+  }
+}
+
+void render_state::bind_buffer_range(GLenum _target, GLuint _index,
+                                     GLuint _buffer, GLintptr _offset,
+                                     GLsizeiptr _size) {
+  if (_target == GL_UNIFORM_BUFFER && _index < k_uniform_bindings) {
+    buffer_range &range = m_uniform_ranges[_index];
+    if (m_enabled && range.buffer == _buffer && range.offset == _offset &&
+        range.size == _size) {
+      m_skipped++;
+      return;
+    }
+    range = {_buffer, _offset, _size};
+  }
+  const size_t slot = buffer_slot(_target);
+  if (slot != k_buffer_target_count) {
+    m_buffers[slot] = _buffer;
+  }
+  m_issued++;
+  glBindBufferRange(_target, _index, _buffer, _offset, _size);
+}
+
+void render_state::active_texture(GLuint _unit) {
+  if (change(m_active_unit, _unit)) {
+    glActiveTexture(GL_TEXTURE0 + _unit);
+  }
+}
+
+void render_state::bind_texture(GLuint _unit, GLenum _target,
+                                GLuint _texture) {
+  const size_t slot = texture_slot(_target);
+  if (_unit >= k_texture_units || slot == 2) {
+    active_texture(_unit);
+    m_issued++;
+    glBindTexture(_target, _texture);
+    return;
+  }
+  // Check the binding first, so a bound texture does not switch units
+  if (m_enabled && m_textures[_unit][slot] == _texture) {
+    m_skipped++;
+    return;
+  }
+  active_texture(_unit);
+  m_textures[_unit][slot] = _texture;
+  m_issued++;
+  glBindTexture(_target, _texture);
+}
+
+void render_state::bind_texture(GLenum _target, GLuint _texture) {
+  if (m_active_unit == k_unknown) {
+    active_texture(0);
+  }
+  bind_texture(m_active_unit, _target, _texture);
+}
+
+void render_state::set_enabled(GLenum _capability, bool _enabled) {
+  auto it = std::find_if(m_capabilities.begin(), m_capabilities.end(),
+                         [_capability](const auto &_entry) {
+                           return _entry.first == _capability;
+                         });
+  if (it == m_capabilities.end()) {
+    m_capabilities.emplace_back(_capability, k_unknown);
+    it = m_capabilities.end() - 1;
+  }
+  if (change(it->second, static_cast<GLuint>(_enabled))) {
+    if (_enabled) {
+      glEnable(_capability);
+    } else {
+      glDisable(_capability);
+    }
+  }
+}
+
+void render_state::blend_func(GLenum _source, GLenum _destination) {
+  const bool same = m_blend[0] == _source && m_blend[1] == _destination;
+  if (m_enabled && same) {
+    m_skipped++;
+    return;
+  }
+  m_blend[0] = _source;
+  m_blend[1] = _destination;
+  m_issued++;
+  glBlendFunc(_source, _destination);
+}
+
+void render_state::depth_func(GLenum _function) {
+  if (change(m_depth_func, _function)) {
+    glDepthFunc(_function);
+  }
+}
+
+void render_state::depth_mask(bool _write) {
+  if (change(m_depth_mask, static_cast<GLuint>(_write))) {
+    glDepthMask(_write ? GL_TRUE : GL_FALSE);
+  }
+}
+
+void render_state::stencil_func(GLenum _function, GLint _reference,
+                                GLuint _mask) {
+  const GLuint values[3] = {_function, static_cast<GLuint>(_reference),
+                            _mask};
+  if (m_enabled && std::equal(values, values + 3, m_stencil_func)) {
+    m_skipped++;
+    return;
+  }
+  std::copy(values, values + 3, m_stencil_func);
+  m_issued++;
+  glStencilFunc(_function, _reference, _mask);
+}
+
+void render_state::stencil_op(GLenum _stencil_fail, GLenum _depth_fail,
+                              GLenum _depth_pass) {
+  const GLuint values[3] = {_stencil_fail, _depth_fail, _depth_pass};
+  if (m_enabled && std::equal(values, values + 3, m_stencil_op)) {
+    m_skipped++;
+    return;
+  }
+  std::copy(values, values + 3, m_stencil_op);
+  m_issued++;
+  glStencilOp(_stencil_fail, _depth_fail, _depth_pass);
+}
+
+void render_state::stencil_mask(GLuint _mask) {
+  if (change(m_stencil_mask, _mask)) {
+    glStencilMask(_mask);
+  }
+}
+
+void render_state::forget_program(GLuint _program) {
+  // A deleted program stays in use until another one is, so the shadow is
+  // still right; a new program may reuse the name, so it is dropped
+  if (m_program == _program) {
+    m_program = k_unknown;
+  }
+}
+
+void render_state::forget_vertex_array(GLuint _vertex_array) {
+  if (m_vertex_array == _vertex_array) {
+    m_vertex_array = 0;
+    m_buffers[buffer_slot(GL_ELEMENT_ARRAY_BUFFER)] = k_unknown;
+  }
+}
+
+void render_state::forget_buffer(GLuint _buffer) {
+  for (GLuint &buffer : m_buffers) {
+    if (buffer == _buffer) {
+      buffer = 0;
+    }
+  }
+  for (buffer_range &range : m_uniform_ranges) {
+    if (range.buffer == _buffer) {
+      range = {0, 0, 0};
+    }
+  }
+}
+
+void render_state::forget_texture(GLuint _texture) {
+  for (GLuint(&unit)[2] : m_textures) {
+    for (GLuint &texture : unit) {
+      if (texture == _texture) {
+        texture = 0;
+      }
+    }
+  }
+}
+
+bool fence_signaled(GLsync _fence, GLuint64 _timeout) {
+  const GLenum status =
+      glClientWaitSync(_fence, GL_SYNC_FLUSH_COMMANDS_BIT, _timeout);
+  return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
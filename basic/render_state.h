@@ -0,0 +1,156 @@
+#pragma once
+
+#include <glad/gl.h>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Shadow of the GL state the engine changes most often
+ *
+ * Binding a program, vertex array, buffer or texture, or setting a
+ * capability, blend, depth or stencil state that is already current is
+ * skipped instead of reaching the driver. GL code that bypasses the tracker
+ * must call invalidate() afterwards; every frame starts invalidated, so
+ * state changed between frames, e.g. by the ImGui backend, is not trusted.
+ * Use it from the GL thread only.
+ */
+class render_state {
+public:
+  /**
+   * @brief Process-wide tracker for the one GL context
+   */
+  static render_state &instance();
+
+  /**
+   * @brief Start a frame: keep the last frame's counts and forget all state
+   */
+  void begin_frame();
+
+  /**
+   * @brief Forget all shadowed state, so the next call of each kind is
+   * issued
+   */
+  void invalidate();
+
+  void use_program(GLuint _program);
+  void bind_vertex_array(GLuint _vertex_array);
+
+  /**
+   * @brief Bind a buffer. GL_ELEMENT_ARRAY_BUFFER is part of the bound
+   * vertex array, so it is forgotten when the vertex array changes.
+   */
+  void bind_buffer(GLenum _target, GLuint _buffer);
+
+  /**
+   * @brief Bind a buffer range to an indexed binding point; like GL, this
+   * also binds the buffer to the target itself
+   */
+  void bind_buffer_range(GLenum _target, GLuint _index, GLuint _buffer,
+                         GLintptr _offset, GLsizeiptr _size);
+
+  /**
+   * @brief Bind a texture to a texture unit, making the unit active
+   * @param _unit Unit index, not GL_TEXTURE0 + index
+   */
+  void bind_texture(GLuint _unit, GLenum _target, GLuint _texture);
+
+  /**
+   * @brief Bind a texture to the active unit, e.g. to upload it
+   */
+  void bind_texture(GLenum _target, GLuint _texture);
+
+  void active_texture(GLuint _unit);
+
+  void set_enabled(GLenum _capability, bool _enabled);
+  void enable(GLenum _capability) { set_enabled(_capability, true); }
+  void disable(GLenum _capability) { set_enabled(_capability, false); }
+
+  void blend_func(GLenum _source, GLenum _destination);
+  void depth_func(GLenum _function);
+  void depth_mask(bool _write);
+  void stencil_func(GLenum _function, GLint _reference, GLuint _mask);
+  void stencil_op(GLenum _stencil_fail, GLenum _depth_fail,
+                  GLenum _depth_pass);
+  void stencil_mask(GLuint _mask);
+
+  /**
+   * @brief Update the shadow for an object about to be deleted; GL unbinds
+   * deleted buffers, vertex arrays and textures from the current context
+   */
+  void forget_program(GLuint _program);
+  void forget_vertex_array(GLuint _vertex_array);
+  void forget_buffer(GLuint _buffer);
+  void forget_texture(GLuint _texture);
+
+  /**
+   * @brief Calls that reached the driver and calls that were dropped
+   * during the last complete frame
+   */
+  size_t get_issued_count() const { return m_last_issued; }
+  size_t get_skipped_count() const { return m_last_skipped; }
+
+  // Set to false to issue every call, e.g. to rule the tracker out while
+  // debugging; calls are still counted as issued
+  bool m_enabled = true;
+
+private:
+  render_state();
+
+  // Whether a call changing _shadow to _value must be issued; updates the
+  // shadow and the counters
+  template <typename tValue> bool change(tValue &_shadow, tValue _value);
+
+  static constexpr GLuint k_unknown = 0xffffffffu;
+  static constexpr size_t k_texture_units = 32;
+  static constexpr size_t k_uniform_bindings = 16;
+
+  // Buffer targets tracked by bind_buffer; others are always issued
+  static constexpr GLenum k_buffer_targets[] = {
+      GL_ARRAY_BUFFER,      GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER,
+      GL_PIXEL_PACK_BUFFER, GL_COPY_READ_BUFFER,     GL_COPY_WRITE_BUFFER};
+  static constexpr size_t k_buffer_target_count =
+      sizeof(k_buffer_targets) / sizeof(k_buffer_targets[0]);
+
+  // Index of a target in k_buffer_targets, or k_buffer_target_count
+  static size_t buffer_slot(GLenum _target);
+  // Index of a texture target in m_textures' rows, or 2
+  static size_t texture_slot(GLenum _target);
+
+  GLuint m_program = k_unknown;
+  GLuint m_vertex_array = k_unknown;
+  GLuint m_buffers[k_buffer_target_count];
+  struct buffer_range {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
+  };
+  // GL_UNIFORM_BUFFER binding points; buffer is k_unknown when not known
+  buffer_range m_uniform_ranges[k_uniform_bindings];
+  GLuint m_active_unit = k_unknown;
+  // GL_TEXTURE_2D and GL_TEXTURE_CUBE_MAP binding of every unit
+  GLuint m_textures[k_texture_units][2];
+  // Capability and 0, 1 or k_unknown
+  std::vector<std::pair<GLenum, GLuint>> m_capabilities;
+  GLuint m_blend[2];
+  GLuint m_depth_func = k_unknown;
+  GLuint m_depth_mask = k_unknown;
+  GLuint m_stencil_func[3];
+  GLuint m_stencil_op[3];
+  GLuint m_stencil_mask = k_unknown;
+
+  size_t m_issued = 0;
+  size_t m_skipped = 0;
+  size_t m_last_issued = 0;
+  size_t m_last_skipped = 0;
+};
+
+/**
+ * @brief Whether the GPU has passed _fence, waiting up to _timeout
+ * nanoseconds for it
+ *
+ * The flush makes sure the fence is sent, so the wait can end; a zero
+ * timeout only checks.
+ */
+bool fence_signaled(GLsync _fence, GLuint64 _timeout = 0);
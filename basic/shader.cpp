@@ -1,5 +1,9 @@
 #include "basic/shader.h"
 
+#include "basic/program_binary_cache.h"
+#include "basic/render_state.h"
+#include "basic/uniform_buffer.h"
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -42,8 +46,7 @@ int create_shader_from_source(const std::string &_source, GLenum _shader_type,
   return shader;
 }
 
-int create_shader_from_file(const char *_path, GLenum _shader_type) {
-
+std::string read_shader_file(const char *_path) {
   std::ifstream shader_file(_path);
   if (!shader_file.is_open()) {
     std::stringstream ss;
@@ -55,8 +58,12 @@ int create_shader_from_file(const char *_path, GLenum _shader_type) {
       std::string(std::istreambuf_iterator<char>(shader_file),
                   std::istreambuf_iterator<char>());
   shader_file.close();
+  return shader_source;
+}
 
-  return create_shader_from_source(shader_source, _shader_type, _path);
+int create_shader_from_file(const char *_path, GLenum _shader_type) {
+  return create_shader_from_source(read_shader_file(_path), _shader_type,
+                                   _path);
 }
 
 int create_shader_program_from_shaders(GLuint _vertex_shader,
@@ -86,6 +93,7 @@ int create_shader_program_from_shaders(GLuint _vertex_shader,
     check_gl_error("glAttachShader (tess evaluation)");
   }
 
+  program_binary_cache::instance().prepare(shader_program);
   glLinkProgram(shader_program);
   check_gl_error("glLinkProgram");
 
@@ -125,31 +133,51 @@ int create_shader_program_from_shaders(GLuint _vertex_shader,
   return shader_program;
 }
 
+// Stages in the order of create_program's arrays
+static const GLenum k_stage_types[5] = {
+    GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER,
+    GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER};
+
+// Link a program from the sources of the vertex, fragment, geometry, tess
+// control and tess evaluation stages; empty sources are unused stages.
+// Loads the program binary instead if one is cached for these sources, and
+// caches it otherwise.
+static GLuint create_program(const std::string (&_sources)[5],
+                             const char *const (&_paths)[5]) {
+  auto &cache = program_binary_cache::instance();
+  const std::uint64_t key = cache.make_key(_sources, 5);
+  if (GLuint program = cache.load(key)) {
+    return program;
+  }
+  GLuint stages[5] = {};
+  for (int i = 0; i < 5; i++) {
+    if (!_sources[i].empty()) {
+      stages[i] = create_shader_from_source(_sources[i], k_stage_types[i],
+                                            _paths[i]);
+    }
+  }
+  GLuint program = create_shader_program_from_shaders(
+      stages[0], stages[1], stages[2], stages[3], stages[4]);
+  cache.store(key, program);
+  return program;
+}
+
 shader::shader(const char *_vertex_path, const char *_fragment_path,
                const char *_geometry_path, const char *_tess_control_path,
                const char *_tess_evaluation_path) {
   try {
-
-    GLuint vertex_shader =
-        create_shader_from_file(_vertex_path, GL_VERTEX_SHADER);
-    GLuint fragment_shader =
-        create_shader_from_file(_fragment_path, GL_FRAGMENT_SHADER);
-    GLuint geometry_shader =
-        _geometry_path
-            ? create_shader_from_file(_geometry_path, GL_GEOMETRY_SHADER)
-            : 0;
-    GLuint tess_control_shader =
-        _tess_control_path ? create_shader_from_file(_tess_control_path,
-                                                     GL_TESS_CONTROL_SHADER)
-                           : 0;
-    GLuint tess_evaluation_shader =
-        _tess_evaluation_path
-            ? create_shader_from_file(_tess_evaluation_path,
-                                      GL_TESS_EVALUATION_SHADER)
-            : 0;
-    m_ID = create_shader_program_from_shaders(
-        vertex_shader, fragment_shader, geometry_shader, tess_control_shader,
-        tess_evaluation_shader);
+    const char *const paths[5] = {_vertex_path, _fragment_path,
+                                  _geometry_path, _tess_control_path,
+                                  _tess_evaluation_path};
+    std::string sources[5];
+    for (int i = 0; i < 5; i++) {
+      if (paths[i]) {
+        sources[i] = read_shader_file(paths[i]);
+      }
+    }
+    m_ID = create_program(sources, paths);
+    bind_uniform_blocks(m_ID);
+    load_uniforms();
   } catch (std::exception &e) {
     std::stringstream ss;
     ss << "Failed to create shader program from file: " << _vertex_path << ", "
@@ -159,37 +187,148 @@ shader::shader(const char *_vertex_path, const char *_fragment_path,
   }
 }
 
-shader::~shader() { glDeleteProgram(m_ID); }
+shader::shader(int _shader_program) : m_ID(_shader_program) {
+  bind_uniform_blocks(m_ID);
+  load_uniforms();
+}
 
-void shader::use() { glUseProgram(m_ID); }
+shader::~shader() {
+  render_state::instance().forget_program(m_ID);
+  glDeleteProgram(m_ID);
+}
+
+void shader::use() { render_state::instance().use_program(m_ID); }
 
 shader *shader::shader_from_source(const std::string &_vertex_source,
                                    const std::string &_fragment_source,
                                    const std::string &_geometry_source,
                                    const std::string &_tess_control_source,
                                    const std::string &_tess_evaluation_source) {
+  const std::string sources[5] = {_vertex_source, _fragment_source,
+                                  _geometry_source, _tess_control_source,
+                                  _tess_evaluation_source};
+  const char *const paths[5] = {};
+  return new shader(static_cast<int>(create_program(sources, paths)));
+}
 
-  GLuint vertex_shader =
-      create_shader_from_source(_vertex_source, GL_VERTEX_SHADER, nullptr);
-  GLuint fragment_shader =
-      create_shader_from_source(_fragment_source, GL_FRAGMENT_SHADER, nullptr);
-  GLuint geometry_shader =
-      !_geometry_source.empty()
-          ? create_shader_from_source(_geometry_source, GL_GEOMETRY_SHADER,
-                                      nullptr)
-          : 0;
-  GLuint tess_control_shader =
-      !_tess_control_source.empty()
-          ? create_shader_from_source(_tess_control_source,
-                                      GL_TESS_CONTROL_SHADER, nullptr)
-          : 0;
-  GLuint tess_evaluation_shader =
-      !_tess_evaluation_source.empty()
-          ? create_shader_from_source(_tess_evaluation_source,
-                                      GL_TESS_EVALUATION_SHADER, nullptr)
-          : 0;
-  int shader_program = create_shader_program_from_shaders(
-      vertex_shader, fragment_shader, geometry_shader, tess_control_shader,
-      tess_evaluation_shader);
-  return new shader(shader_program);
-}
\ No newline at end of file
+void shader::load_uniforms() {
+  GLint uniform_count = 0;
+  GLint max_length = 0;
+  glGetProgramiv(m_ID, GL_ACTIVE_UNIFORMS, &uniform_count);
+  glGetProgramiv(m_ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+  struct active_uniform {
+    std::string name;
+    GLint size;
+  };
+  std::vector<active_uniform> uniforms;
+  size_t name_count = 0;
+  std::vector<char> buffer(static_cast<size_t>(max_length) + 1);
+  for (GLint i = 0; i < uniform_count; i++) {
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = 0;
+    glGetActiveUniform(m_ID, static_cast<GLuint>(i),
+                       static_cast<GLsizei>(buffer.size()), &length, &size,
+                       &type, buffer.data());
+    std::string name(buffer.data(), static_cast<size_t>(length));
+    // Arrays are reported as "name[0]" with their size
+    const size_t bracket = name.rfind("[0]");
+    if (bracket != std::string::npos && bracket + 3 == name.size()) {
+      name.resize(bracket);
+      name_count += static_cast<size_t>(size) + 1;
+    } else {
+      size = 0;
+      name_count++;
+    }
+    uniforms.push_back({std::move(name), size});
+  }
+
+  size_t table_size = 8;
+  while (table_size < name_count * 2) {
+    table_size *= 2;
+  }
+  m_uniform_table.assign(table_size, uniform_entry{0, k_empty_slot});
+  m_uniform_names.clear();
+  m_element_locations.clear();
+
+  // Members of uniform blocks have no location and are not added
+  for (const active_uniform &uniform : uniforms) {
+    if (uniform.size == 0) {
+      const GLint location = glGetUniformLocation(m_ID, uniform.name.c_str());
+      if (location >= 0) {
+        add_uniform(uniform.name, location);
+      }
+      continue;
+    }
+    // Element locations need not be consecutive, so each is queried once
+    const size_t first_element = m_element_locations.size();
+    for (GLint i = 0; i < uniform.size; i++) {
+      const std::string element_name =
+          uniform.name + "[" + std::to_string(i) + "]";
+      const GLint location = glGetUniformLocation(m_ID, element_name.c_str());
+      m_element_locations.push_back(location);
+      if (location >= 0) {
+        add_uniform(element_name, location);
+      }
+    }
+    if (m_element_locations[first_element] < 0) {
+      continue;
+    }
+    // The bare array name is element 0, as for glGetUniformLocation
+    uniform_entry &entry =
+        add_uniform(uniform.name, m_element_locations[first_element]);
+    entry.first_element = static_cast<std::uint32_t>(first_element);
+    entry.element_count = static_cast<std::uint32_t>(uniform.size);
+  }
+}
+
+shader::uniform_entry &shader::add_uniform(const std::string &_name,
+                                           GLint _location) {
+  const size_t mask = m_uniform_table.size() - 1;
+  size_t slot = uniform_name::hash(_name.c_str()) & mask;
+  while (m_uniform_table[slot].name != k_empty_slot) {
+    slot = (slot + 1) & mask;
+  }
+  uniform_entry &entry = m_uniform_table[slot];
+  entry.hash = uniform_name::hash(_name.c_str());
+  entry.name = static_cast<std::uint32_t>(m_uniform_names.size());
+  entry.location = _location;
+  m_uniform_names.append(_name.c_str(), _name.size() + 1);
+  return entry;
+}
+
+const shader::uniform_entry *
+shader::find_uniform(const uniform_name &_name) const {
+  if (m_uniform_table.empty()) {
+    return nullptr;
+  }
+  const size_t mask = m_uniform_table.size() - 1;
+  // The table is at most half full, so the probe reaches an empty slot
+  for (size_t slot = _name.get_hash() & mask;; slot = (slot + 1) & mask) {
+    const uniform_entry &entry = m_uniform_table[slot];
+    if (entry.name == k_empty_slot) {
+      return nullptr;
+    }
+    if (entry.hash == _name.get_hash() &&
+        std::strcmp(m_uniform_names.c_str() + entry.name, _name.c_str()) ==
+            0) {
+      return &entry;
+    }
+  }
+}
+
+int shader::get_uniform_location(const uniform_name &_name,
+                                 unsigned _index) const {
+  const uniform_entry *entry = find_uniform(_name);
+  if (!entry) {
+    return -1;
+  }
+  if (entry->element_count == 0) {
+    return _index == 0 ? entry->location : -1;
+  }
+  if (_index >= entry->element_count) {
+    return -1;
+  }
+  return m_element_locations[entry->first_element + _index];
+}
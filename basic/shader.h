@@ -3,13 +3,52 @@
 #include <glad/gl.h>
 #include <glm/glm.hpp>
 
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <vector>
 
+/**
+ * @brief Uniform name and its FNV-1a hash
+ *
+ * Converts implicitly from a string, so set_uniform("uModel", ...) keeps
+ * working. Literals written as "uModel"_uniform are hashed at compile time.
+ * The text is not copied and must outlive the call.
+ */
+class uniform_name {
+public:
+  constexpr uniform_name(const char *_name)
+      : m_name(_name), m_hash(hash(_name)) {}
+  uniform_name(const std::string &_name) : uniform_name(_name.c_str()) {}
+
+  static constexpr std::uint32_t hash(const char *_text) {
+    std::uint32_t value = 2166136261u;
+    for (; *_text; _text++) {
+      value ^= static_cast<unsigned char>(*_text);
+      value *= 16777619u;
+    }
+    return value;
+  }
+
+  constexpr const char *c_str() const { return m_name; }
+  constexpr std::uint32_t get_hash() const { return m_hash; }
+
+private:
+  const char *m_name;
+  std::uint32_t m_hash;
+};
+
+consteval uniform_name operator""_uniform(const char *_name, size_t) {
+  return uniform_name(_name);
+}
+
 /**
  * @brief Shader program wrapper
+ *
+ * After linking, the active uniforms are read once into a hash table, so
+ * setting a uniform looks its location up without asking the driver.
  */
 class shader {
 public:
@@ -38,7 +77,35 @@ public:
   void use();
 
 private:
-  shader(int _shader_program) : m_ID(_shader_program) {}
+  shader(int _shader_program);
+
+  // Table entry; an empty slot has name k_empty_slot
+  struct uniform_entry {
+    std::uint32_t hash = 0;
+    std::uint32_t name = 0; // Offset in m_uniform_names
+    GLint location = -1;
+    // Elements of an array uniform in m_element_locations; 0 otherwise
+    std::uint32_t first_element = 0;
+    std::uint32_t element_count = 0;
+  };
+  static constexpr std::uint32_t k_empty_slot = 0xffffffffu;
+
+  /**
+   * @brief Fill the uniform table from the linked program
+   */
+  void load_uniforms();
+
+  /**
+   * @brief Add a name to the uniform table
+   * @return Its entry
+   */
+  uniform_entry &add_uniform(const std::string &_name, GLint _location);
+
+  /**
+   * @brief Entry of a uniform, or nullptr if the program has no such active
+   * uniform
+   */
+  const uniform_entry *find_uniform(const uniform_name &_name) const;
 
 public:
   // Uniform function template specializations
@@ -147,7 +214,7 @@ public:
    * @param _values Pointer to value(s)
    */
   template <typename tType, unsigned COUNT>
-  void set_uniform(const char *_name, const tType *_values) {
+  void set_uniform(const uniform_name &_name, const tType *_values) {
     uniform_function<tType, COUNT>::call(get_uniform_location(_name), _values);
   }
 
@@ -157,7 +224,7 @@ public:
    * @param _value Value to set (passed by reference)
    */
   template <typename tType>
-  void set_uniform(const char *_name, const tType &_value) {
+  void set_uniform(const uniform_name &_name, const tType &_value) {
     uniform_function<tType, 1>::call(get_uniform_location(_name), &_value);
   }
 
@@ -167,10 +234,11 @@ public:
    * @param _values Vector of values
    */
   template <typename tType, unsigned COUNT>
-  void set_uniform(const char *_name, const std::vector<tType> &_values) {
+  void set_uniform(const uniform_name &_name,
+                   const std::vector<tType> &_values) {
     if (_values.size() != COUNT) {
       throw std::runtime_error("Invalid number of values for uniform " +
-                               std::string(_name));
+                               std::string(_name.c_str()));
     }
     uniform_function<tType, COUNT>::call(get_uniform_location(_name),
                                          _values.data());
@@ -185,7 +253,7 @@ public:
   typename std::enable_if<
       std::conjunction_v<std::is_same<tType, std::decay_t<tArgs>>...>,
       void>::type
-  set_uniform(const char *_name, tArgs... _values) {
+  set_uniform(const uniform_name &_name, tArgs... _values) {
     constexpr unsigned COUNT = sizeof...(_values);
     tType values_array[COUNT] = {static_cast<tType>(_values)...};
     uniform_function<tType, COUNT>::call(get_uniform_location(_name),
@@ -197,8 +265,31 @@ public:
    * @param _name Uniform name
    * @return Uniform location, or -1 if not found
    */
-  int get_uniform_location(const char *_name) const {
-    return glGetUniformLocation(m_ID, _name);
+  int get_uniform_location(const uniform_name &_name) const {
+    const uniform_entry *entry = find_uniform(_name);
+    return entry ? entry->location : -1;
+  }
+
+  /**
+   * @brief Get the location of one element of an array uniform
+   * @param _name Array name without brackets
+   * @param _index Element index
+   * @return Uniform location, or -1 if not found or out of range
+   */
+  int get_uniform_location(const uniform_name &_name, unsigned _index) const;
+
+  /**
+   * @brief Set one element of an array uniform, without building its
+   * "name[index]" string
+   * @param _name Array name without brackets
+   * @param _index Element index
+   * @param _value Value to set
+   */
+  template <typename tType>
+  void set_uniform_element(const uniform_name &_name, unsigned _index,
+                           const tType &_value) {
+    uniform_function<tType, 1>::call(get_uniform_location(_name, _index),
+                                     &_value);
   }
 
   /**
@@ -209,4 +300,11 @@ public:
 
 protected:
   GLuint m_ID = -1; // OpenGL shader program ID
+
+private:
+  // Open addressing with linear probing; the size is a power of two at
+  // least twice the number of names
+  std::vector<uniform_entry> m_uniform_table;
+  std::string m_uniform_names; // Null-terminated names, back to back
+  std::vector<GLint> m_element_locations;
 };
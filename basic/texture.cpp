@@ -1,5 +1,6 @@
 #include "basic/texture.h"
 
+#include "basic/render_state.h"
 #include "glad/gl.h"
 #include "imgui.h"
 #include <iostream>
@@ -10,7 +11,7 @@
 namespace {
 void apply_wrap_mode_impl(unsigned int _texture_type, unsigned int _texture_id,
                           wrap_mode _wrap_mode) {
-  glBindTexture(_texture_type, _texture_id);
+  render_state::instance().bind_texture(_texture_type, _texture_id);
   GLint wrap_mode_gl;
   switch (_wrap_mode) {
   case wrap_mode::k_repeat:
@@ -33,7 +34,7 @@ void apply_wrap_mode_impl(unsigned int _texture_type, unsigned int _texture_id,
 void apply_filter_mode_impl(unsigned int _texture_type,
                             unsigned int _texture_id,
                             filter_mode _filter_mode) {
-  glBindTexture(_texture_type, _texture_id);
+  render_state::instance().bind_texture(_texture_type, _texture_id);
   GLint filter_mode_gl;
   switch (_filter_mode) {
   case filter_mode::k_nearest:
@@ -49,20 +50,47 @@ void apply_filter_mode_impl(unsigned int _texture_type,
 
 } // namespace
 
+void image_data::pixel_deleter::operator()(unsigned char *_pixels) const {
+  stbi_image_free(_pixels);
+}
+
+image_data image_data::load(const char *_path, bool _flip_vertically) {
+  // The thread-local flag keeps concurrent decodes from racing on stb's
+  // global setting.
+  stbi_set_flip_vertically_on_load_thread(_flip_vertically);
+  image_data image;
+  image.pixels.reset(
+      stbi_load(_path, &image.width, &image.height, &image.channels, 0));
+  return image;
+}
+
 texture_2d::texture_2d(const char *_path, wrap_mode _wrap_mode,
                        filter_mode _filter_mode)
     : m_wrap_mode(_wrap_mode), m_filter_mode(_filter_mode) {
-  stbi_set_flip_vertically_on_load(true);
-
-  unsigned char *data =
-      stbi_load(_path, &m_width, &m_height, &m_nr_channels, 0);
-  if (!data) {
+  image_data image = image_data::load(_path);
+  if (!image.pixels) {
     std::cerr << "Failed to load texture: " << _path << std::endl;
     throw std::runtime_error("Failed to load texture");
   }
+  m_width = image.width;
+  m_height = image.height;
+  m_nr_channels = image.channels;
+  upload(image.pixels.get());
+}
 
+texture_2d::texture_2d(const image_data &_image, wrap_mode _wrap_mode,
+                       filter_mode _filter_mode)
+    : m_wrap_mode(_wrap_mode), m_filter_mode(_filter_mode),
+      m_width(_image.width), m_height(_image.height),
+      m_nr_channels(_image.channels) {
+  if (!_image.pixels)
+    throw std::runtime_error("Failed to load texture");
+  upload(_image.pixels.get());
+}
+
+void texture_2d::upload(const unsigned char *_pixels) {
   glGenTextures(1, &m_ID);
-  glBindTexture(GL_TEXTURE_2D, m_ID);
+  render_state::instance().bind_texture(GL_TEXTURE_2D, m_ID);
 
   GLenum format = GL_RGB;
   if (m_nr_channels == 1)
@@ -73,13 +101,11 @@ texture_2d::texture_2d(const char *_path, wrap_mode _wrap_mode,
     format = GL_RGBA;
 
   glTexImage2D(GL_TEXTURE_2D, 0, format, m_width, m_height, 0, format,
-               GL_UNSIGNED_BYTE, data);
+               GL_UNSIGNED_BYTE, _pixels);
   glGenerateMipmap(GL_TEXTURE_2D);
 
-  stbi_image_free(data);
-
-  set_wrap_mode(_wrap_mode);
-  set_filter_mode(_filter_mode);
+  set_wrap_mode(m_wrap_mode);
+  set_filter_mode(m_filter_mode);
 }
 
 texture_2d::texture_2d(const std::array<uint8_t, 4> &_solid_rgba8,
@@ -87,7 +113,7 @@ texture_2d::texture_2d(const std::array<uint8_t, 4> &_solid_rgba8,
     : m_wrap_mode(_wrap_mode), m_filter_mode(_filter_mode),
       m_width(1), m_height(1), m_nr_channels(4) {
   glGenTextures(1, &m_ID);
-  glBindTexture(GL_TEXTURE_2D, m_ID);
+  render_state::instance().bind_texture(GL_TEXTURE_2D, m_ID);
   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE,
                _solid_rgba8.data());
   glGenerateMipmap(GL_TEXTURE_2D);
@@ -95,11 +121,13 @@ texture_2d::texture_2d(const std::array<uint8_t, 4> &_solid_rgba8,
   set_filter_mode(_filter_mode);
 }
 
-texture_2d::~texture_2d() { glDeleteTextures(1, &m_ID); }
+texture_2d::~texture_2d() {
+  render_state::instance().forget_texture(m_ID);
+  glDeleteTextures(1, &m_ID);
+}
 
 void texture_2d::bind(int _slot) const {
-  glActiveTexture(GL_TEXTURE0 + _slot);
-  glBindTexture(GL_TEXTURE_2D, m_ID);
+  render_state::instance().bind_texture(_slot, GL_TEXTURE_2D, m_ID);
 }
 
 void texture_2d::set_wrap_mode(wrap_mode _wrap_mode) {
@@ -149,34 +177,32 @@ void ui(texture_2d &_texture) {
 texture_cube::texture_cube(const std::array<std::string, 6> &_paths,
                            wrap_mode _wrap_mode, filter_mode _filter_mode) {
   glGenTextures(1, &m_ID);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, m_ID);
+  render_state::instance().bind_texture(GL_TEXTURE_CUBE_MAP, m_ID);
 
-  stbi_set_flip_vertically_on_load(false);
-
-  int width, height, nr_channels;
-  unsigned char *data;
   for (int i = 0; i < 6; i++) {
-    data = stbi_load(_paths[i].c_str(), &width, &height, &nr_channels, 0);
+    image_data image = image_data::load(_paths[i].c_str(), false);
     GLenum format = GL_RGB;
-    if (nr_channels == 1)
+    if (image.channels == 1)
       format = GL_RED;
-    else if (nr_channels == 3)
+    else if (image.channels == 3)
       format = GL_RGB;
-    else if (nr_channels == 4)
+    else if (image.channels == 4)
       format = GL_RGBA;
-    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height,
-                 0, format, GL_UNSIGNED_BYTE, data);
-    stbi_image_free(data);
+    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, image.width,
+                 image.height, 0, format, GL_UNSIGNED_BYTE,
+                 image.pixels.get());
   }
   set_wrap_mode(_wrap_mode);
   set_filter_mode(_filter_mode);
 }
 
-texture_cube::~texture_cube() { glDeleteTextures(1, &m_ID); }
+texture_cube::~texture_cube() {
+  render_state::instance().forget_texture(m_ID);
+  glDeleteTextures(1, &m_ID);
+}
 
 void texture_cube::bind(int _slot) const {
-  glActiveTexture(GL_TEXTURE0 + _slot);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, m_ID);
+  render_state::instance().bind_texture(_slot, GL_TEXTURE_CUBE_MAP, m_ID);
 }
 
 void texture_cube::set_wrap_mode(wrap_mode _wrap_mode) {
@@ -4,6 +4,7 @@
 #include <string>
 #include <cstdint>
 #include <glad/gl.h>
+#include <memory>
 
 /**
  * @brief Texture wrap mode
@@ -23,6 +24,35 @@ enum class filter_mode {
   k_linear,
 };
 
+/**
+ * @brief Decoded 8-bit image in CPU memory, waiting to be uploaded
+ */
+struct image_data {
+  struct pixel_deleter {
+    void operator()(unsigned char *_pixels) const;
+  };
+
+  std::unique_ptr<unsigned char, pixel_deleter> pixels;
+  int width = 0;
+  int height = 0;
+  int channels = 0;
+
+  /**
+   * @brief Decode an image file. Safe to call from worker threads.
+   * @param _path Path to image file
+   * @param _flip_vertically Flip rows so the first row is the bottom one
+   * @return Decoded image; pixels is null if decoding failed
+   */
+  static image_data load(const char *_path, bool _flip_vertically = true);
+
+  /**
+   * @brief Size of the pixel data in bytes
+   */
+  size_t size() const {
+    return static_cast<size_t>(width) * height * channels;
+  }
+};
+
 /**
  * @brief 2D texture wrapper
  */
@@ -36,6 +66,15 @@ public:
    */
   texture_2d(const char *_path, wrap_mode _wrap_mode = wrap_mode::k_repeat,
              filter_mode _filter_mode = filter_mode::k_nearest);
+  /**
+   * @brief Upload an image decoded with image_data::load
+   * @param _image Decoded image; must hold pixels
+   * @param _wrap_mode Texture wrap mode
+   * @param _filter_mode Texture filter mode
+   */
+  explicit texture_2d(const image_data &_image,
+                      wrap_mode _wrap_mode = wrap_mode::k_repeat,
+                      filter_mode _filter_mode = filter_mode::k_nearest);
   explicit texture_2d(const std::array<uint8_t, 4> &_solid_rgba8,
                        wrap_mode _wrap_mode = wrap_mode::k_repeat,
                        filter_mode _filter_mode = filter_mode::k_linear);
@@ -104,6 +143,8 @@ public:
   filter_mode get_filter_mode() const { return m_filter_mode; }
 
 protected:
+  void upload(const unsigned char *_pixels);
+
   unsigned int m_ID = -1;
   wrap_mode m_wrap_mode = wrap_mode::k_repeat;
   filter_mode m_filter_mode = filter_mode::k_nearest;
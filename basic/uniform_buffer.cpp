@@ -0,0 +1,45 @@
+#include "basic/uniform_buffer.h"
+
+namespace {
+
+struct block_name {
+  const char *name;
+  uniform_block_binding binding;
+};
+
+constexpr block_name k_block_names[] = {
+    {"CameraBlock", uniform_block_binding::k_camera},
+    {"LightBlock", uniform_block_binding::k_lights},
+    {"MaterialBlock", uniform_block_binding::k_material},
+};
+
+} // namespace
+
+void bind_uniform_blocks(GLuint _program) {
+  for (const block_name &block : k_block_names) {
+    const GLuint index = glGetUniformBlockIndex(_program, block.name);
+    if (index != GL_INVALID_INDEX) {
+      glUniformBlockBinding(_program, index,
+                            static_cast<GLuint>(block.binding));
+    }
+  }
+}
+
+size_t uniform_buffer_offset_alignment() {
+  static size_t alignment = 0;
+  if (alignment == 0) {
+    GLint value = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &value);
+    // The spec allows at most 256
+    alignment = value > 0 ? static_cast<size_t>(value) : 256;
+  }
+  return alignment;
+}
+
+void write_block(const camera &_camera, camera_block &_block) {
+  _block.view = _camera.ViewMatrix;
+  _block.projection = _camera.ProjectionMatrix;
+  _block.view_projection = _camera.ProjectionMatrix * _camera.ViewMatrix;
+  _block.eye_position = _camera.Position;
+  _block.padding = 0.0f;
+}
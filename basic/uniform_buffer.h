@@ -0,0 +1,235 @@
+#pragma once
+
+#include "basic/camera.h"
+#include "basic/render_state.h"
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Binding points of the engine's uniform blocks
+ *
+ * GL 3.3 has no layout(binding = ...) for blocks, so every shader binds the
+ * blocks it declares by name when it is created, see bind_uniform_blocks.
+ */
+enum class uniform_block_binding : GLuint {
+  k_camera = 0,   // CameraBlock, see camera_block
+  k_lights = 1,   // LightBlock, see light_block
+  k_material = 2, // MaterialBlock, see material_block
+};
+
+/**
+ * @brief Bind the engine's blocks declared by a program to their binding
+ * points
+ * @param _program Linked program
+ */
+void bind_uniform_blocks(GLuint _program);
+
+/**
+ * @brief Smallest offset step of glBindBufferRange on GL_UNIFORM_BUFFER
+ */
+size_t uniform_buffer_offset_alignment();
+
+// The structs below mirror std140 blocks byte for byte. std140 aligns a vec3
+// like a vec4 but lets a scalar use its last four bytes, so every vec3 is
+// followed by a float, and a block or array element is padded to 16 bytes.
+
+/**
+ * @brief Per-frame camera, declared in GLSL as
+ * layout(std140) uniform CameraBlock {
+ *   mat4 view;
+ *   mat4 projection;
+ *   mat4 view_projection;
+ *   vec3 eye_position;
+ * };
+ */
+struct camera_block {
+  glm::mat4 view;
+  glm::mat4 projection;
+  glm::mat4 view_projection;
+  glm::vec3 eye_position;
+  float padding;
+};
+
+/**
+ * @brief One light of light_block, declared in GLSL as
+ * struct Light {
+ *   vec3 position; float constant;
+ *   vec3 direction; float linear;
+ *   vec3 ambient; float quadratic;
+ *   vec3 diffuse; float cutoff;
+ *   vec3 specular; float outer_cutoff;
+ *   int type;
+ * };
+ * Cutoffs are cosines.
+ */
+struct light_block_entry {
+  glm::vec3 position;
+  float constant;
+  glm::vec3 direction;
+  float linear;
+  glm::vec3 ambient;
+  float quadratic;
+  glm::vec3 diffuse;
+  float cutoff;
+  glm::vec3 specular;
+  float outer_cutoff;
+  int type;
+  int padding[3];
+};
+
+/**
+ * @brief Lights of a frame, declared in GLSL as
+ * layout(std140) uniform LightBlock {
+ *   Light uLights[8];
+ *   int uLightCount;
+ * };
+ */
+struct light_block {
+  static constexpr size_t k_max_lights = 8;
+
+  light_block_entry lights[k_max_lights];
+  int count;
+  int padding[3];
+};
+
+/**
+ * @brief Color material, declared in GLSL as
+ * struct Material {
+ *   vec3 ambient; float shininess;
+ *   vec3 diffuse;
+ *   vec3 specular;
+ * };
+ * layout(std140) uniform MaterialBlock {
+ *   Material uMaterial;
+ * };
+ */
+struct material_block {
+  glm::vec3 ambient;
+  float shininess;
+  glm::vec3 diffuse;
+  float padding0;
+  glm::vec3 specular;
+  float padding1;
+};
+
+static_assert(offsetof(camera_block, eye_position) == 192);
+static_assert(sizeof(camera_block) == 208);
+static_assert(offsetof(light_block_entry, direction) == 16);
+static_assert(offsetof(light_block_entry, type) == 80);
+static_assert(sizeof(light_block_entry) == 96);
+static_assert(offsetof(light_block, count) == 768);
+static_assert(offsetof(material_block, diffuse) == 16);
+static_assert(offsetof(material_block, specular) == 32);
+static_assert(sizeof(material_block) == 48);
+
+/**
+ * @brief Fill a camera block from a camera's current matrices
+ */
+void write_block(const camera &_camera, camera_block &_block);
+
+/**
+ * @brief Uniform buffer holding one or more blocks of type tBlock
+ *
+ * Blocks are staged on the CPU with set() and sent in one glBufferSubData by
+ * upload(), which skips blocks that did not change. Several blocks, e.g. one
+ * per material, are bound one at a time by index.
+ */
+template <typename tBlock> class uniform_buffer {
+  static_assert(std::is_trivially_copyable_v<tBlock>,
+                "Blocks are copied to the buffer byte for byte");
+  static_assert(sizeof(tBlock) % 16 == 0,
+                "std140 pads a block to a multiple of 16 bytes");
+
+public:
+  /**
+   * @param _binding Binding point bind() uses
+   * @param _count Number of blocks in the buffer
+   */
+  explicit uniform_buffer(uniform_block_binding _binding, size_t _count = 1)
+      : m_binding(static_cast<GLuint>(_binding)), m_count(_count) {
+    m_stride = sizeof(tBlock);
+    if (m_count > 1) {
+      const size_t alignment = uniform_buffer_offset_alignment();
+      m_stride = (m_stride + alignment - 1) / alignment * alignment;
+    }
+    m_staging.assign(m_stride * m_count, 0);
+    m_dirty_begin = m_count;
+    render_state &state = render_state::instance();
+    glGenBuffers(1, &m_buffer);
+    state.bind_buffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(m_staging.size()),
+                 m_staging.data(), GL_DYNAMIC_DRAW);
+    state.bind_buffer(GL_UNIFORM_BUFFER, 0);
+  }
+
+  ~uniform_buffer() {
+    render_state::instance().forget_buffer(m_buffer);
+    glDeleteBuffers(1, &m_buffer);
+  }
+
+  uniform_buffer(const uniform_buffer &) = delete;
+  uniform_buffer &operator=(const uniform_buffer &) = delete;
+
+  /**
+   * @brief Stage a block for the next upload()
+   * @param _index Block index, less than get_count()
+   * @param _block Block data
+   */
+  void set(size_t _index, const tBlock &_block) {
+    unsigned char *target = m_staging.data() + _index * m_stride;
+    if (std::memcmp(target, &_block, sizeof(tBlock)) == 0) {
+      return;
+    }
+    std::memcpy(target, &_block, sizeof(tBlock));
+    m_dirty_begin = std::min(m_dirty_begin, _index);
+    m_dirty_end = std::max(m_dirty_end, _index + 1);
+  }
+
+  /**
+   * @brief Send the blocks changed since the last upload to the GPU
+   */
+  void upload() {
+    if (m_dirty_begin >= m_dirty_end) {
+      return;
+    }
+    const size_t offset = m_dirty_begin * m_stride;
+    const size_t size = (m_dirty_end - m_dirty_begin) * m_stride;
+    render_state &state = render_state::instance();
+    state.bind_buffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(offset),
+                    static_cast<GLsizeiptr>(size), m_staging.data() + offset);
+    state.bind_buffer(GL_UNIFORM_BUFFER, 0);
+    m_dirty_begin = m_count;
+    m_dirty_end = 0;
+  }
+
+  /**
+   * @brief Bind a block to the buffer's binding point
+   * @param _index Block index
+   */
+  void bind(size_t _index = 0) const {
+    render_state::instance().bind_buffer_range(
+        GL_UNIFORM_BUFFER, m_binding, m_buffer,
+        static_cast<GLintptr>(_index * m_stride),
+        static_cast<GLsizeiptr>(sizeof(tBlock)));
+  }
+
+  size_t get_count() const { return m_count; }
+
+private:
+  GLuint m_buffer = 0;
+  GLuint m_binding = 0;
+  size_t m_count = 0;
+  size_t m_stride = 0;
+  std::vector<unsigned char> m_staging;
+  // Range of blocks set() changed; empty when begin >= end
+  size_t m_dirty_begin = 0;
+  size_t m_dirty_end = 0;
+};
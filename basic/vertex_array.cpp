@@ -4,6 +4,35 @@
 #include <stdexcept>
 #include <vector>
 
+namespace {
+size_t attribute_size(const vertex_attribute &_attribute) {
+  switch (_attribute.type) {
+  case GL_FLOAT:
+    return _attribute.size * sizeof(GLfloat);
+  case GL_INT:
+    return _attribute.size * sizeof(GLint);
+  case GL_UNSIGNED_INT:
+    return _attribute.size * sizeof(GLuint);
+  case GL_HALF_FLOAT:
+    return _attribute.size * sizeof(GLhalf);
+  case GL_SHORT:
+    return _attribute.size * sizeof(GLshort);
+  case GL_UNSIGNED_SHORT:
+    return _attribute.size * sizeof(GLushort);
+  case GL_BYTE:
+    return _attribute.size * sizeof(GLbyte);
+  case GL_UNSIGNED_BYTE:
+    return _attribute.size * sizeof(GLubyte);
+  case GL_INT_2_10_10_10_REV:
+  case GL_UNSIGNED_INT_2_10_10_10_REV:
+    // Four components packed into one 32-bit word
+    return sizeof(GLuint);
+  default:
+    throw std::runtime_error("Unsupported vertex attribute type");
+  }
+}
+} // namespace
+
 // -----------------------------------------------------------------------------
 void vertex_array::add_attributes(
     const std::vector<vertex_attribute> &_attributes) {
@@ -12,16 +41,7 @@ void vertex_array::add_attributes(
   std::vector<size_t> attribute_offsets;
   for (auto &attribute : _attributes) {
     attribute_offsets.push_back(total_stride);
-    switch (attribute.type) {
-    case GL_FLOAT:
-      total_stride += attribute.size * sizeof(GLfloat);
-      break;
-    case GL_INT:
-      total_stride += attribute.size * sizeof(GLint);
-      break;
-    default:
-      throw std::runtime_error("Unsupported vertex attribute type");
-    }
+    total_stride += attribute_size(attribute);
   }
   for (size_t i = 0; i < _attributes.size(); i++) {
     glEnableVertexAttribArray(i);
@@ -32,5 +52,11 @@ void vertex_array::add_attributes(
   unbind();
 }
 
-
-
+// -----------------------------------------------------------------------------
+size_t
+vertex_array::stride_of(const std::vector<vertex_attribute> &_attributes) {
+  size_t stride = 0;
+  for (auto &attribute : _attributes)
+    stride += attribute_size(attribute);
+  return stride;
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "basic/render_state.h"
+
 #include <glad/gl.h>
 
 #include <cstddef>
@@ -12,18 +14,25 @@
 class vertex_buffer {
 public:
   vertex_buffer() { glGenBuffers(1, &m_ID); }
-  virtual ~vertex_buffer() { glDeleteBuffers(1, &m_ID); }
+  virtual ~vertex_buffer() {
+    render_state::instance().forget_buffer(m_ID);
+    glDeleteBuffers(1, &m_ID);
+  }
 
 public:
   /**
    * @brief Bind the buffer object
    */
-  void bind() const { glBindBuffer(GL_ARRAY_BUFFER, m_ID); }
+  void bind() const {
+    render_state::instance().bind_buffer(GL_ARRAY_BUFFER, m_ID);
+  }
 
   /**
    * @brief Unbind the buffer object
    */
-  void unbind() const { glBindBuffer(GL_ARRAY_BUFFER, 0); }
+  void unbind() const {
+    render_state::instance().bind_buffer(GL_ARRAY_BUFFER, 0);
+  }
 
   /**
    * @brief Set buffer data
@@ -36,6 +45,16 @@ public:
     glBufferData(GL_ARRAY_BUFFER, size, data, usage);
   }
 
+  /**
+   * @brief Overwrite part of the buffer's data store
+   * @param offset Offset into the buffer in bytes
+   * @param data Pointer to data
+   * @param size Size of data in bytes
+   */
+  void set_sub_data(size_t offset, const void *data, size_t size) const {
+    glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+  }
+
   /**
    * @brief Get OpenGL buffer ID
    * @return Buffer ID
@@ -51,8 +70,10 @@ protected:
  */
 struct vertex_attribute {
   unsigned int size; // Number of components (1-4)
-  unsigned int type; // Data type (GL_FLOAT, GL_INT, etc.)
-  bool normalized;   // Whether values should be normalized
+  unsigned int type; // Data type (GL_FLOAT, GL_HALF_FLOAT, GL_SHORT, etc.)
+  bool normalized;   // Whether integer values map to [0, 1] or [-1, 1]
+
+  bool operator==(const vertex_attribute &) const = default;
 };
 
 /**
@@ -61,18 +82,21 @@ struct vertex_attribute {
 class vertex_array {
 public:
   vertex_array() { glGenVertexArrays(1, &m_ID); }
-  virtual ~vertex_array() { glDeleteVertexArrays(1, &m_ID); }
+  virtual ~vertex_array() {
+    render_state::instance().forget_vertex_array(m_ID);
+    glDeleteVertexArrays(1, &m_ID);
+  }
 
 public:
   /**
    * @brief Bind the vertex array object
    */
-  void bind() const { glBindVertexArray(m_ID); }
+  void bind() const { render_state::instance().bind_vertex_array(m_ID); }
 
   /**
    * @brief Unbind the vertex array object
    */
-  void unbind() const { glBindVertexArray(0); }
+  void unbind() const { render_state::instance().bind_vertex_array(0); }
 
   /**
    * @brief Configure vertex attributes
@@ -80,6 +104,13 @@ public:
    */
   void add_attributes(const std::vector<vertex_attribute> &_attributes);
 
+  /**
+   * @brief Size of one interleaved vertex for an attribute layout
+   * @param _attributes Vector of vertex attribute specifications
+   * @return Stride in bytes
+   */
+  static size_t stride_of(const std::vector<vertex_attribute> &_attributes);
+
   /**
    * @brief Get OpenGL vertex array ID
    * @return Vertex array ID
@@ -96,18 +127,25 @@ protected:
 class index_buffer {
 public:
   index_buffer() { glGenBuffers(1, &m_ID); }
-  virtual ~index_buffer() { glDeleteBuffers(1, &m_ID); }
+  virtual ~index_buffer() {
+    render_state::instance().forget_buffer(m_ID);
+    glDeleteBuffers(1, &m_ID);
+  }
 
 public:
   /**
    * @brief Bind the buffer object
    */
-  void bind() const { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ID); }
+  void bind() const {
+    render_state::instance().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, m_ID);
+  }
 
   /**
    * @brief Unbind the buffer object
    */
-  void unbind() const { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); }
+  void unbind() const {
+    render_state::instance().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  }
 
   /**
    * @brief Set buffer data
@@ -120,6 +158,16 @@ public:
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, usage);
   }
 
+  /**
+   * @brief Overwrite part of the buffer's data store
+   * @param offset Offset into the buffer in bytes
+   * @param data Pointer to data
+   * @param size Size of data in bytes
+   */
+  void set_sub_data(size_t offset, const void *data, size_t size) const {
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, size, data);
+  }
+
   /**
    * @brief Get OpenGL buffer ID
    * @return Buffer ID
@@ -43,14 +43,26 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos) {
     auto real_ypos = ypos - test_suit_ptr->m_viewport_y;
     test_suit_ptr->on_mouse_moved(real_xpos, real_ypos);
 
-    // Check if the mouse is hovering over an object.
+    // Check if the mouse is hovering over an object, on the CPU if the scene
+    // can, otherwise from the object ID attachment a few frames later.
     // Viewport uses top-left origin (y down); framebuffer uses bottom-left (y
     // up).
-    int fb_y = test_suit_ptr->m_scene_framebuffer->get_height() - 1 -
-               static_cast<int>(real_ypos);
-    auto object_id = test_suit_ptr->m_scene_framebuffer->read_object_id(
-        static_cast<int>(real_xpos), fb_y);
-    test_suit_ptr->on_object_hovered(object_id);
+    const framebuffer *scene_framebuffer = test_suit_ptr->m_scene_framebuffer;
+    const int width = scene_framebuffer->get_width();
+    const int height = scene_framebuffer->get_height();
+    int object_id = -1;
+    bool picked = false;
+    if (width > 0 && height > 0) {
+      const float clip_x = static_cast<float>(real_xpos) / width * 2.0f - 1.0f;
+      const float clip_y = 1.0f - static_cast<float>(real_ypos) / height * 2.0f;
+      picked = test_suit_ptr->pick_object(clip_x, clip_y, object_id);
+    }
+    if (picked) {
+      test_suit_ptr->on_object_hovered(object_id);
+    } else {
+      int fb_y = height - 1 - static_cast<int>(real_ypos);
+      test_suit_ptr->request_object_hover(static_cast<int>(real_xpos), fb_y);
+    }
   }
 }
 
@@ -18,6 +18,7 @@
 
 #include "basic/framebuffer.h"
 #include "basic/imgui_font_setup.h"
+#include "basic/render_state.h"
 #include "callbacks.h"
 #include "resource_root.h"
 #include "tests/framework/test_suit.h"
@@ -145,6 +146,8 @@ int main() {
     while (!glfwWindowShouldClose(window)) {
       // Poll and handle events
       glfwPollEvents();
+      // ImGui and raw GL calls change state behind the tracker's back
+      render_state::instance().begin_frame();
 
       // Update test suit
       float current_time = glfwGetTime();
@@ -249,6 +252,9 @@ int main() {
         // Continue to next frame instead of crashing
       }
 
+      // Read back the hovered object ID without waiting for this frame
+      test_suit.process_object_readbacks();
+
       // Unbind framebuffer (back to default)
       scene_framebuffer.unbind();
 
@@ -2,8 +2,12 @@
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 eye_position;
+};
 
 uniform int uSubSenceIndex;
 uniform float uPointSize;
@@ -3,9 +3,11 @@ layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 uniform mat4 model;
 
-layout (std140) uniform uCameraMatrics {
+layout(std140) uniform CameraBlock {
     mat4 view;
     mat4 projection;
+    mat4 view_projection;
+    vec3 eye_position;
 };
 
 uniform int uSubSenceIndex;
@@ -9,8 +9,12 @@ in VS_OUT {
 
 uniform float uShapeFactor;
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 eye_position;
+};
 
 vec4 explode(vec4 position, vec3 normal) {
   float magnitude = uShapeFactor;
@@ -11,8 +11,12 @@ in VS_OUT {
 uniform float uShapeFactor;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 eye_position;
+};
 
 vec3 getNormal()
 {
@@ -1,8 +1,12 @@
 #version 330 core
 layout(location = 0) in vec3 aPos;
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 eye_position;
+};
 
 void main()
 {
@@ -0,0 +1,38 @@
+#version 330 core
+// import_packed_vertex: unorm16 position within the model bounds, unorm16
+// octahedral normal, half float texture coordinates
+layout(location = 0) in vec4 aPos;
+layout(location = 1) in vec2 aNormal;
+layout(location = 2) in vec2 aTexCoords;
+uniform mat4 model;
+layout(std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 eye_position;
+};
+uniform vec3 uPositionOffset;
+uniform vec3 uPositionScale;
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec2 TexCoords;
+
+vec3 decode_octahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+void main()
+{
+    vec3 position = uPositionOffset + aPos.xyz * uPositionScale;
+    vec3 normal = decode_octahedral(aNormal * 2.0 - 1.0);
+    gl_Position = projection * view * model * vec4(position, 1.0);
+    Normal = mat3(transpose(inverse(model))) * normal;
+    FragPos = vec3(model * vec4(position, 1.0));
+    TexCoords = aTexCoords;
+}
@@ -0,0 +1,29 @@
+#version 330 core
+layout(std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 eye_position;
+};
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec4 Color;
+flat in uint Material;
+out vec4 FragColor;
+
+// x ambient, y diffuse, z specular strength, w shininess
+uniform vec4 uMaterials[4];
+
+void main()
+{
+    vec4 material = uMaterials[Material % 4u];
+    vec3 normal = normalize(Normal);
+    vec3 light_direction = normalize(vec3(0.4, 0.7, 0.6));
+    vec3 view_direction = normalize(eye_position - FragPos);
+    vec3 halfway = normalize(light_direction + view_direction);
+    float diffuse = max(dot(normal, light_direction), 0.0);
+    float specular = pow(max(dot(normal, halfway), 0.0), material.w);
+    FragColor = vec4(Color.rgb * (material.x + material.y * diffuse) +
+                     vec3(material.z * specular), Color.a);
+}
@@ -0,0 +1,11 @@
+#version 330 core
+in vec3 Normal;
+out vec4 FragColor;
+
+uniform vec3 uObjectColor;
+
+void main()
+{
+    float diffuse = max(dot(normalize(Normal), normalize(vec3(0.4, 0.7, 0.6))), 0.0);
+    FragColor = vec4(uObjectColor * (0.3 + 0.7 * diffuse), 1.0);
+}
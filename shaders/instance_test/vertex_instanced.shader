@@ -0,0 +1,27 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+layout(location = 3) in mat4 aModel;
+layout(location = 7) in vec4 aColor;
+layout(location = 8) in uint aMaterial;
+layout(std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 eye_position;
+};
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec4 Color;
+flat out uint Material;
+
+void main()
+{
+    vec4 world_position = aModel * vec4(aPos, 1.0);
+    FragPos = world_position.xyz;
+    Normal = mat3(aModel) * aNormal;
+    Color = aColor;
+    Material = aMaterial;
+    gl_Position = projection * view * world_position;
+}
@@ -0,0 +1,18 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+uniform mat4 model;
+layout(std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 eye_position;
+};
+
+out vec3 Normal;
+
+void main()
+{
+    Normal = mat3(model) * aNormal;
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
@@ -9,7 +9,12 @@ uniform float uAmbientStrength;
 in vec3 FragPos;
 in vec3 Normal;
 uniform vec3 uLightPosition;
-uniform vec3 uEyePosition;
+layout(std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 eye_position;
+};
 uniform float uSpecularStrength;
 uniform float uShininess;
 
@@ -22,7 +27,7 @@ void main()
     float diff = max(dot(norm, lightDir), 0.0);
     vec3 diffuse = diff * uLightColor;
 
-    vec3 viewDir = normalize(uEyePosition - FragPos);
+    vec3 viewDir = normalize(eye_position - FragPos);
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), uShininess);
     vec3 specular = uSpecularStrength * spec * uLightColor;
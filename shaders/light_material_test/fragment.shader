@@ -1,73 +1,85 @@
 #version 330 core
 out vec4 FragColor;
 
+// std140 layout of light_block_entry in basic/uniform_buffer.h
 struct Light {
-    int type;
     vec3 position;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-    vec3 direction;
     float constant;
+    vec3 direction;
     float linear;
+    vec3 ambient;
     float quadratic;
+    vec3 diffuse;
     float cutoff;
+    vec3 specular;
     float outer_cutoff;
+    int type;
 };
 
+// std140 layout of material_block in basic/uniform_buffer.h
 struct Material {
     vec3 ambient;
+    float shininess;
     vec3 diffuse;
     vec3 specular;
-    float shininess;
 };
 
-uniform Light uLight;
-uniform Material uMaterial;
-uniform vec3 uEyePosition;
+layout(std140) uniform LightBlock {
+    Light uLights[8];
+    int uLightCount;
+};
+layout(std140) uniform MaterialBlock {
+    Material uMaterial;
+};
+layout(std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 eye_position;
+};
 
 in vec3 FragPos;
 in vec3 Normal;
 
 void main()
 {
-    vec3 ambient = uLight.ambient * uMaterial.ambient;
+    vec3 ambient = uLights[0].ambient * uMaterial.ambient;
 
     vec3 norm = normalize(Normal);
     vec3 lightDir;
-    if (uLight.type == 0)
+    if (uLights[0].type == 0)
     {
-        lightDir = normalize(-uLight.direction);
+        lightDir = normalize(-uLights[0].direction);
     }
-    else if (uLight.type == 1 || uLight.type == 2)
+    else if (uLights[0].type == 1 || uLights[0].type == 2)
     {
-        lightDir = normalize(uLight.position - FragPos);
+        lightDir = normalize(uLights[0].position - FragPos);
     }
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * uLight.diffuse * uMaterial.diffuse;
+    vec3 diffuse = diff * uLights[0].diffuse * uMaterial.diffuse;
 
-    vec3 viewDir = normalize(uEyePosition - FragPos);
+    vec3 viewDir = normalize(eye_position - FragPos);
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), uMaterial.shininess);
-    vec3 specular = uLight.specular * spec * uMaterial.specular;
+    vec3 specular = uLights[0].specular * spec * uMaterial.specular;
 
     // Calculate distance attenuation for point and spot lights
     float attenuation = 1.0;
-    if (uLight.type == 1 || uLight.type == 2)
+    if (uLights[0].type == 1 || uLights[0].type == 2)
     {
-        float distance = length(uLight.position - FragPos);
-        attenuation = 1.0 / (uLight.constant + uLight.linear * distance + uLight.quadratic * distance * distance);
+        float distance = length(uLights[0].position - FragPos);
+        attenuation = 1.0 / (uLights[0].constant + uLights[0].linear * distance + uLights[0].quadratic * distance * distance);
         // Apply attenuation to diffuse and specular (ambient should not be attenuated)
         diffuse *= attenuation;
         specular *= attenuation;
     }
 
     // Apply spot light angle attenuation
-    if (uLight.type == 2)
+    if (uLights[0].type == 2)
     {
-        float theta = dot(lightDir, normalize(-uLight.direction));
-        float epsilon = uLight.cutoff - uLight.outer_cutoff;
-        float intensity = clamp((theta - uLight.outer_cutoff) / epsilon, 0.0, 1.0);
+        float theta = dot(lightDir, normalize(-uLights[0].direction));
+        float epsilon = uLights[0].cutoff - uLights[0].outer_cutoff;
+        float intensity = clamp((theta - uLights[0].outer_cutoff) / epsilon, 0.0, 1.0);
         diffuse *= intensity;
         specular *= intensity;
     }
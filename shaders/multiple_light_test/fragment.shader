@@ -1,30 +1,42 @@
 #version 330 core
 out vec4 FragColor;
 
+// std140 layout of light_block_entry in basic/uniform_buffer.h
 struct Light {
-    int type;
     vec3 position;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-    vec3 direction;
     float constant;
+    vec3 direction;
     float linear;
+    vec3 ambient;
     float quadratic;
+    vec3 diffuse;
     float cutoff;
+    vec3 specular;
     float outer_cutoff;
+    int type;
 };
 
+// std140 layout of material_block in basic/uniform_buffer.h
 struct Material {
     vec3 ambient;
+    float shininess;
     vec3 diffuse;
     vec3 specular;
-    float shininess;
 };
 
-uniform Light uLight[4];
-uniform Material uMaterial;
-uniform vec3 uEyePosition;
+layout(std140) uniform LightBlock {
+    Light uLights[8];
+    int uLightCount;
+};
+layout(std140) uniform MaterialBlock {
+    Material uMaterial;
+};
+layout(std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 eye_position;
+};
 
 in vec3 FragPos;
 in vec3 Normal;
@@ -69,19 +81,19 @@ vec3 cal_spot_light(Light light, vec3 normal, vec3 view_dir)
 void main()
 {
     vec3 result = vec3(0.0);
-    for (int i = 0; i < 4; i++)
+    for (int i = 0; i < uLightCount; i++)
     {
-        if (uLight[i].type == 0)
+        if (uLights[i].type == 0)
         {
-            result += cal_directional_light(uLight[i], Normal, normalize(uEyePosition - FragPos));
+            result += cal_directional_light(uLights[i], Normal, normalize(eye_position - FragPos));
         }
-        else if (uLight[i].type == 1)
+        else if (uLights[i].type == 1)
         {
-            result += cal_point_light(uLight[i], Normal, normalize(uEyePosition - FragPos));
+            result += cal_point_light(uLights[i], Normal, normalize(eye_position - FragPos));
         }
-        else if (uLight[i].type == 2)
+        else if (uLights[i].type == 2)
         {
-            result += cal_spot_light(uLight[i], Normal, normalize(uEyePosition - FragPos));
+            result += cal_spot_light(uLights[i], Normal, normalize(eye_position - FragPos));
         }
     }
     FragColor = vec4(result, 1.0);
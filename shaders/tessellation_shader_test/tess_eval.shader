@@ -2,8 +2,12 @@
 layout(triangles, equal_spacing, ccw) in;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 eye_position;
+};
 uniform float uTime;
 uniform float uAmplitude;
 
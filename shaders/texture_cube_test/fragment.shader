@@ -3,14 +3,19 @@ out vec4 FragColor;
 
 in vec3 FragPos;
 in vec3 Normal;
-uniform vec3 uEyePosition;
+layout(std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 eye_position;
+};
 uniform samplerCube uCubeMap;
 uniform float uRefractRatio;
 uniform int uTestMode;
 
 void main()
 {
-    vec3 I = normalize(FragPos - uEyePosition);
+    vec3 I = normalize(FragPos - eye_position);
     vec3 R = uTestMode == 0 ? refract(I, normalize(Normal), uRefractRatio) : reflect(I, normalize(Normal));
     FragColor = vec4(texture(uCubeMap, R).rgb, 1.0);
 }
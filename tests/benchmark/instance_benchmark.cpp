@@ -0,0 +1,157 @@
+// Headless instance data benchmark.
+//
+// Lays out an instance_field like instance_renderer_scene, writes its
+// per-instance model matrices, colors and materials for a number of frames
+// and prints how many instances per millisecond were prepared, first on the
+// calling thread and then split across a thread_pool. The destination is a
+// plain array standing in for the mapped ring buffer region, so only the CPU
+// side of instanced drawing is measured.
+
+#include "tests/component/instance_field.h"
+#include "tests/component/thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct benchmark_options {
+  int instances = 100000;
+  int frames = 200;
+  int warmup = 20;
+  int grain = 4096;
+  unsigned threads = 0;
+};
+
+void print_usage() {
+  std::printf(
+      "usage: instance_benchmark [options]\n"
+      "  --instances N    instances written per frame (100000)\n"
+      "  --frames F       timed frames of 1/60 s (200)\n"
+      "  --warmup W       untimed frames before timing (20)\n"
+      "  --grain G        instances per job on the thread pool (4096)\n"
+      "  --threads T      worker threads (hardware - 1)\n");
+}
+
+bool parse_options(int _argc, char **_argv, benchmark_options &_options) {
+  for (int i = 1; i < _argc; ++i) {
+    const std::string arg = _argv[i];
+    auto next_int = [&](int &_out) {
+      if (i + 1 >= _argc)
+        return false;
+      _out = std::atoi(_argv[++i]);
+      return true;
+    };
+
+    if (arg == "--instances") {
+      if (!next_int(_options.instances))
+        return false;
+    } else if (arg == "--frames") {
+      if (!next_int(_options.frames))
+        return false;
+    } else if (arg == "--warmup") {
+      if (!next_int(_options.warmup))
+        return false;
+    } else if (arg == "--grain") {
+      if (!next_int(_options.grain))
+        return false;
+    } else if (arg == "--threads") {
+      int threads = 0;
+      if (!next_int(threads))
+        return false;
+      _options.threads = static_cast<unsigned>(std::max(threads, 0));
+    } else {
+      return false;
+    }
+  }
+  return _options.instances >= 1 && _options.frames >= 1 &&
+         _options.warmup >= 0 && _options.grain >= 1;
+}
+
+// FNV-1a over the bit patterns of the last frame's instances, so both runs
+// can be checked to write the same data.
+std::uint64_t checksum(const std::vector<instance_data> &_instances) {
+  std::uint64_t hash = 14695981039346656037ull;
+  for (const instance_data &instance : _instances) {
+    unsigned char bytes[sizeof(instance_data)];
+    std::memcpy(bytes, &instance, sizeof(bytes));
+    for (unsigned char byte : bytes) {
+      hash ^= byte;
+      hash *= 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+struct run_result {
+  double seconds = 0.0;
+  std::uint64_t checksum = 0;
+};
+
+run_result run(const benchmark_options &_options, const instance_field &_field,
+               std::vector<instance_data> &_out, thread_pool *_pool) {
+  const float dt = 1.0f / 60.0f;
+  const auto grain = static_cast<size_t>(_options.grain);
+  for (int i = 0; i < _options.warmup; ++i)
+    _field.write(static_cast<float>(i) * dt, _out.data(), _pool, grain);
+
+  run_result result;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < _options.frames; ++i)
+    _field.write(static_cast<float>(_options.warmup + i) * dt, _out.data(),
+                 _pool, grain);
+  const auto end = std::chrono::steady_clock::now();
+  result.seconds = std::chrono::duration<double>(end - start).count();
+  result.checksum = checksum(_out);
+  return result;
+}
+
+void print_result(const char *_label, const benchmark_options &_options,
+                  const run_result &_result) {
+  const double milliseconds = _result.seconds * 1e3;
+  const double instances =
+      static_cast<double>(_options.instances) * _options.frames;
+  std::printf("%s %.3f ms/frame, %.0f instances/ms, checksum %016llx\n",
+              _label, milliseconds / _options.frames,
+              instances / milliseconds,
+              static_cast<unsigned long long>(_result.checksum));
+}
+
+} // namespace
+
+int main(int _argc, char **_argv) {
+  benchmark_options options;
+  if (!parse_options(_argc, _argv, options)) {
+    print_usage();
+    return 2;
+  }
+
+  instance_field field;
+  field.layout(static_cast<size_t>(options.instances), 0.25f);
+  std::vector<instance_data> instances(field.size());
+
+  const run_result single = run(options, field, instances, nullptr);
+  thread_pool pool(options.threads);
+  const run_result pooled = run(options, field, instances, &pool);
+
+  std::printf("instances:     %d x %zu bytes\n", options.instances,
+              sizeof(instance_data));
+  std::printf("frames:        %d (+%d warmup)\n", options.frames,
+              options.warmup);
+  print_result("1 thread:     ", options, single);
+  std::printf("pool:          %zu workers + caller, grain %d\n",
+              pool.worker_count(), options.grain);
+  print_result("pooled:       ", options, pooled);
+
+  if (single.checksum != pooled.checksum) {
+    std::printf("checksum mismatch between single and pooled runs\n");
+    return 1;
+  }
+  return 0;
+}
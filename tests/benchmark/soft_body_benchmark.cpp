@@ -0,0 +1,379 @@
+// Headless soft-body benchmark.
+//
+// Builds M elliptic loops of N points procedurally (like
+// soft_body_frog_scene::init_frog_loop), steps them for a fixed number of
+// frames and prints the time per frame, the share of it spent in collision,
+// constraint throughput and a checksum of the final state. The checksum only
+// depends on the seed and the options, so a run with --expect fails when the
+// simulation result changes. Floating point results can differ between
+// compilers and SIMD backends; compare checksums produced by the same build
+// configuration.
+
+#include "tests/component/thread_pool.h"
+#include "tests/scenes/soft_body_dirver.h"
+#include "tests/scenes/soft_body_world.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace {
+
+struct benchmark_options {
+  int points = 28;
+  int loops = 16;
+  int frames = 600;
+  int warmup = 60;
+  std::uint32_t seed = 1;
+  soft_body_solver_mode solver = soft_body_solver_mode::k_structure_of_arrays;
+  bool fixed_step = true;
+  int substeps = 8;
+  int iterations = 2;
+  bool collision = true;
+  bool world = false;
+  unsigned threads = 0;
+  bool has_expected = false;
+  std::uint64_t expected = 0;
+};
+
+void print_usage() {
+  std::printf(
+      "usage: soft_body_benchmark [options]\n"
+      "  --points N       points per loop (28)\n"
+      "  --loops M        number of loops (16)\n"
+      "  --frames F       timed frames of 1/60 s (600)\n"
+      "  --warmup W       untimed frames before timing (60)\n"
+      "  --seed S         RNG seed (1)\n"
+      "  --solver aos|soa solver backend (soa)\n"
+      "  --variable       one variable step per frame instead of fixed steps\n"
+      "  --substeps K     substeps per fixed step (8)\n"
+      "  --iterations I   constraint sweeps per substep (2)\n"
+      "  --no-collision   disable collision between loops\n"
+      "  --world          one body per loop, stepped on a thread pool; the\n"
+      "                   bodies do not collide with each other\n"
+      "  --threads T      worker threads for --world (hardware - 1)\n"
+      "  --expect HEX     exit with 1 unless the checksum matches\n");
+}
+
+bool parse_options(int _argc, char **_argv, benchmark_options &_options) {
+  for (int i = 1; i < _argc; ++i) {
+    const std::string arg = _argv[i];
+    auto next = [&]() -> const char * {
+      return i + 1 < _argc ? _argv[++i] : nullptr;
+    };
+    auto next_int = [&](int &_out) {
+      const char *value = next();
+      if (!value)
+        return false;
+      _out = std::atoi(value);
+      return true;
+    };
+
+    if (arg == "--points") {
+      if (!next_int(_options.points))
+        return false;
+    } else if (arg == "--loops") {
+      if (!next_int(_options.loops))
+        return false;
+    } else if (arg == "--frames") {
+      if (!next_int(_options.frames))
+        return false;
+    } else if (arg == "--warmup") {
+      if (!next_int(_options.warmup))
+        return false;
+    } else if (arg == "--seed") {
+      const char *value = next();
+      if (!value)
+        return false;
+      _options.seed =
+          static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+    } else if (arg == "--solver") {
+      const char *value = next();
+      if (!value)
+        return false;
+      if (std::strcmp(value, "aos") == 0)
+        _options.solver = soft_body_solver_mode::k_array_of_structs;
+      else if (std::strcmp(value, "soa") == 0)
+        _options.solver = soft_body_solver_mode::k_structure_of_arrays;
+      else
+        return false;
+    } else if (arg == "--variable") {
+      _options.fixed_step = false;
+    } else if (arg == "--substeps") {
+      if (!next_int(_options.substeps))
+        return false;
+    } else if (arg == "--iterations") {
+      if (!next_int(_options.iterations))
+        return false;
+    } else if (arg == "--no-collision") {
+      _options.collision = false;
+    } else if (arg == "--world") {
+      _options.world = true;
+    } else if (arg == "--threads") {
+      int threads = 0;
+      if (!next_int(threads))
+        return false;
+      _options.threads = static_cast<unsigned>(std::max(threads, 0));
+    } else if (arg == "--expect") {
+      const char *value = next();
+      if (!value)
+        return false;
+      _options.expected = std::strtoull(value, nullptr, 16);
+      _options.has_expected = true;
+    } else {
+      return false;
+    }
+  }
+  // Collision only acts between the islands of one driver, and --world
+  // makes every loop a driver of its own.
+  if (_options.world)
+    _options.collision = false;
+  return _options.points >= 3 && _options.loops >= 1 &&
+         _options.frames >= 1 && _options.warmup >= 0;
+}
+
+// std::uniform_real_distribution is implementation defined; map the raw
+// mt19937 output ourselves so the bodies are the same on every platform.
+float random_range(std::mt19937 &_rng, float _lo, float _hi) {
+  const float unit = static_cast<float>(_rng() >> 8) * (1.0f / 16777216.0f);
+  return _lo + (_hi - _lo) * unit;
+}
+
+int grid_columns(int _loops) {
+  int columns = 1;
+  while (columns * columns < _loops)
+    ++columns;
+  return columns;
+}
+
+// Loops sit in a grid of 0.5 x 0.5 cells; leave headroom above for falling.
+glm::vec2 horizontal_bound(int _loops) {
+  const float half = 0.25f * static_cast<float>(grid_columns(_loops)) + 0.25f;
+  return {-half, half};
+}
+glm::vec2 vertical_bound(int _loops) {
+  const int rows = (_loops + grid_columns(_loops) - 1) / grid_columns(_loops);
+  return {-1.0f, 0.5f * static_cast<float>(rows) + 0.5f};
+}
+
+void add_loop(soft_body_dirver &_driver, int _points, glm::vec2 _center,
+              std::mt19937 &_rng) {
+  const float a = random_range(_rng, 0.10f, 0.16f);
+  const float b = random_range(_rng, 0.12f, 0.20f);
+  soft_body_point prototype;
+  prototype.velocity = glm::vec2(random_range(_rng, -1.0f, 1.0f),
+                                 random_range(_rng, -1.0f, 1.0f));
+  prototype.acceleration = glm::vec2(0.0f, -9.8f);
+
+  const int base = static_cast<int>(_driver.get_points().size());
+  for (int i = 0; i < _points; ++i) {
+    float t = static_cast<float>(i) * 2.0f * 3.14159265f /
+              static_cast<float>(_points);
+    soft_body_point p = prototype;
+    p.position = _center + glm::vec2(a * std::cos(t), b * std::sin(t));
+    _driver.add_point(p);
+  }
+  soft_body_loop loop;
+  for (int i = 0; i < _points; ++i) {
+    soft_body_segment seg;
+    seg.index1 = base + i;
+    seg.index2 = base + (i + 1) % _points;
+    seg.length = glm::length(_driver.get_point(seg.index1).position -
+                             _driver.get_point(seg.index2).position);
+    _driver.add_segment(seg);
+    loop.segment_indices.push_back(
+        static_cast<int>(_driver.get_segments().size()) - 1);
+  }
+  _driver.add_loop(loop);
+}
+
+void configure(soft_body_dirver &_driver, const benchmark_options &_options) {
+  _driver.m_solver_mode = _options.solver;
+  _driver.m_fixed_step = _options.fixed_step;
+  _driver.m_substeps = _options.substeps;
+  _driver.m_substep_iterations = _options.iterations;
+  _driver.m_body_collision = _options.collision;
+}
+
+void build_loops(soft_body_dirver &_driver, const benchmark_options &_options) {
+  std::mt19937 rng(_options.seed);
+  const int columns = grid_columns(_options.loops);
+  const glm::vec2 hb = horizontal_bound(_options.loops);
+  for (int i = 0; i < _options.loops; ++i) {
+    const glm::vec2 center(hb.x + 0.5f * static_cast<float>(i % columns) + 0.5f,
+                           0.5f * static_cast<float>(i / columns));
+    add_loop(_driver, _options.points, center, rng);
+  }
+}
+
+// FNV-1a over the bit patterns of every point's position and velocity.
+struct fnv1a {
+  std::uint64_t hash = 14695981039346656037ull;
+
+  void add(float _value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &_value, sizeof(bits));
+    for (int i = 0; i < 4; ++i) {
+      hash ^= (bits >> (i * 8)) & 0xFFu;
+      hash *= 1099511628211ull;
+    }
+  }
+  void add(const soft_body_dirver &_driver) {
+    for (const auto &p : _driver.get_points()) {
+      add(p.position.x);
+      add(p.position.y);
+      add(p.velocity.x);
+      add(p.velocity.y);
+    }
+  }
+};
+
+// Work counters summed over every driver of the run.
+struct run_counters {
+  size_t sweeps = 0;
+  size_t constraint_solves = 0;
+  size_t broad_phases = 0;
+  double collision_seconds = 0.0;
+
+  void add(const soft_body_dirver &_driver) {
+    sweeps += _driver.get_sweep_count();
+    constraint_solves +=
+        _driver.get_sweep_count() * _driver.get_segments().size();
+    broad_phases += _driver.get_broad_phase_count();
+    collision_seconds += _driver.get_collision_seconds();
+  }
+};
+
+struct run_result {
+  double seconds = 0.0;
+  run_counters counters;
+  std::uint64_t checksum = 0;
+};
+
+// Counters of the timed frames only.
+template <typename tStep, typename tCount>
+run_result run(const benchmark_options &_options, tStep &&_step,
+               tCount &&_count) {
+  const float dt = 1.0f / 60.0f;
+  for (int i = 0; i < _options.warmup; ++i)
+    _step(dt);
+
+  run_result result;
+  const run_counters before = _count();
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < _options.frames; ++i)
+    _step(dt);
+  const auto end = std::chrono::steady_clock::now();
+  const run_counters after = _count();
+  result.counters.sweeps = after.sweeps - before.sweeps;
+  result.counters.constraint_solves =
+      after.constraint_solves - before.constraint_solves;
+  result.counters.broad_phases = after.broad_phases - before.broad_phases;
+  result.counters.collision_seconds =
+      after.collision_seconds - before.collision_seconds;
+  result.seconds = std::chrono::duration<double>(end - start).count();
+  return result;
+}
+
+} // namespace
+
+int main(int _argc, char **_argv) {
+  benchmark_options options;
+  if (!parse_options(_argc, _argv, options)) {
+    print_usage();
+    return 2;
+  }
+
+  const glm::vec2 hb = horizontal_bound(options.loops);
+  const glm::vec2 vb = vertical_bound(options.loops);
+  run_result result;
+  size_t point_count = 0;
+
+  if (options.world) {
+    thread_pool pool(options.threads);
+    soft_body_world world(hb, vb, &pool);
+    configure(world.prototype(), options);
+    build_loops(world.add_body(), options);
+    world.split_islands();
+
+    auto count = [&]() {
+      run_counters counters;
+      for (size_t i = 0; i < world.body_count(); ++i)
+        counters.add(world.get_body(i));
+      return counters;
+    };
+    result = run(options, [&](float _dt) { world.update(_dt); }, count);
+
+    fnv1a hash;
+    for (size_t i = 0; i < world.body_count(); ++i) {
+      hash.add(world.get_body(i));
+      point_count += world.get_body(i).get_points().size();
+    }
+    result.checksum = hash.hash;
+    std::printf("bodies:        %zu on %zu worker threads\n",
+                world.body_count(), pool.worker_count());
+  } else {
+    soft_body_dirver driver(hb, vb);
+    configure(driver, options);
+    build_loops(driver, options);
+
+    auto count = [&]() {
+      run_counters counters;
+      counters.add(driver);
+      return counters;
+    };
+    result = run(options, [&](float _dt) { driver.update(_dt); }, count);
+
+    fnv1a hash;
+    hash.add(driver);
+    point_count = driver.get_points().size();
+    result.checksum = hash.hash;
+  }
+
+  std::printf("scene:         %d loops x %d points (%zu points), seed %u\n",
+              options.loops, options.points, point_count, options.seed);
+  if (options.fixed_step)
+    std::printf("solver:        %s, fixed step %d x %d, collision %s\n",
+                options.solver == soft_body_solver_mode::k_array_of_structs
+                    ? "aos"
+                    : "soa",
+                options.substeps, options.iterations,
+                options.collision ? "on" : "off");
+  else
+    std::printf("solver:        %s, variable step, collision %s\n",
+                options.solver == soft_body_solver_mode::k_array_of_structs
+                    ? "aos"
+                    : "soa",
+                options.collision ? "on" : "off");
+  std::printf("frames:        %d (+%d warmup)\n", options.frames,
+              options.warmup);
+  std::printf("ns/frame:      %.1f\n",
+              result.seconds * 1e9 / static_cast<double>(options.frames));
+  std::printf("collision:     %.1f ns/frame (%.0f%%)\n",
+              result.counters.collision_seconds * 1e9 /
+                  static_cast<double>(options.frames),
+              result.counters.collision_seconds * 100.0 / result.seconds);
+  std::printf("broad phases:  %.2f/frame\n",
+              static_cast<double>(result.counters.broad_phases) /
+                  static_cast<double>(options.frames));
+  std::printf("sweeps/s:      %.3e\n",
+              static_cast<double>(result.counters.sweeps) / result.seconds);
+  std::printf("constraints/s: %.3e\n",
+              static_cast<double>(result.counters.constraint_solves) /
+                  result.seconds);
+  std::printf("checksum:      %016llx\n",
+              static_cast<unsigned long long>(result.checksum));
+
+  if (options.has_expected && options.expected != result.checksum) {
+    std::printf("checksum mismatch: expected %016llx\n",
+                static_cast<unsigned long long>(options.expected));
+    return 1;
+  }
+  return 0;
+}
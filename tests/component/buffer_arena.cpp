@@ -0,0 +1,269 @@
+#include "tests/component/buffer_arena.h"
+
+#include "basic/render_state.h"
+#include "glad/gl.h"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+// -----------------------------------------------------------------------------
+void buffer_arena::free_list::reset(size_t _capacity) {
+  m_holes.clear();
+  if (_capacity > 0)
+    m_holes.emplace(0, _capacity);
+  m_free_total = _capacity;
+}
+
+size_t buffer_arena::free_list::allocate(size_t _count) {
+  if (_count == 0)
+    return 0;
+  for (auto it = m_holes.begin(); it != m_holes.end(); ++it) {
+    if (it->second < _count)
+      continue;
+    const size_t offset = it->first;
+    const size_t rest = it->second - _count;
+    m_holes.erase(it);
+    if (rest > 0)
+      m_holes.emplace(offset + _count, rest);
+    m_free_total -= _count;
+    return offset;
+  }
+  return k_no_space;
+}
+
+void buffer_arena::free_list::release(size_t _offset, size_t _count) {
+  if (_count == 0)
+    return;
+  m_free_total += _count;
+  auto next = m_holes.lower_bound(_offset);
+  // Merge with the following hole
+  if (next != m_holes.end() && _offset + _count == next->first) {
+    _count += next->second;
+    next = m_holes.erase(next);
+  }
+  // Merge with the preceding hole
+  if (next != m_holes.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == _offset) {
+      prev->second += _count;
+      return;
+    }
+  }
+  m_holes.emplace_hint(next, _offset, _count);
+}
+
+// -----------------------------------------------------------------------------
+buffer_arena::buffer_arena(size_t _page_vertices, size_t _page_indices)
+    : m_page_vertices(_page_vertices), m_page_indices(_page_indices) {}
+
+buffer_arena::~buffer_arena() = default;
+
+buffer_arena &buffer_arena::instance() {
+  static buffer_arena arena;
+  return arena;
+}
+
+buffer_arena::handle
+buffer_arena::allocate(const void *_vertices, size_t _vertex_size,
+                       const void *_indices, size_t _index_count,
+                       const std::vector<vertex_attribute> &_attributes) {
+  const size_t stride = vertex_array::stride_of(_attributes);
+  if (stride == 0 || _vertex_size % stride != 0)
+    throw std::runtime_error("Vertex data does not match attribute layout");
+  const size_t vertex_count = _vertex_size / stride;
+  const size_t index_count = _indices ? _index_count : 0;
+
+  range r;
+  bool placed = false;
+  for (size_t i = 0; i < m_pages.size() && !placed; ++i) {
+    if (m_pages[i].attributes == _attributes)
+      placed = place(static_cast<int>(i), vertex_count, index_count, r);
+  }
+  // Enough space in total but no hole large enough: close the holes.
+  for (size_t i = 0; i < m_pages.size() && !placed; ++i) {
+    const page &p = m_pages[i];
+    if (p.attributes == _attributes &&
+        p.free_vertices.free_total() >= vertex_count &&
+        p.free_indices.free_total() >= index_count) {
+      compact_page(static_cast<int>(i));
+      placed = place(static_cast<int>(i), vertex_count, index_count, r);
+    }
+  }
+  if (!placed) {
+    int page_index =
+        create_page(_attributes, stride, vertex_count, index_count);
+    placed = place(page_index, vertex_count, index_count, r);
+  }
+
+  const page &p = m_pages[static_cast<size_t>(r.page)];
+  // Binding the element buffer changes the bound VAO, so upload through the
+  // page's own VAO.
+  p.vao->bind();
+  p.vbo->bind();
+  if (vertex_count > 0)
+    p.vbo->set_sub_data(r.first_vertex * stride, _vertices, _vertex_size);
+  if (index_count > 0)
+    p.ebo->set_sub_data(r.first_index * sizeof(unsigned int), _indices,
+                        index_count * sizeof(unsigned int));
+  p.vao->unbind();
+
+  handle h;
+  if (!m_free_handles.empty()) {
+    h = m_free_handles.back();
+    m_free_handles.pop_back();
+    m_ranges[static_cast<size_t>(h)] = r;
+  } else {
+    h = static_cast<handle>(m_ranges.size());
+    m_ranges.push_back(r);
+  }
+  m_pages[static_cast<size_t>(r.page)].live.push_back(h);
+  return h;
+}
+
+void buffer_arena::release(handle _handle) {
+  if (_handle == k_invalid_handle)
+    return;
+  range &r = m_ranges[static_cast<size_t>(_handle)];
+  page &p = m_pages[static_cast<size_t>(r.page)];
+  p.free_vertices.release(r.first_vertex, r.vertex_count);
+  p.free_indices.release(r.first_index, r.index_count);
+  p.live.erase(std::find(p.live.begin(), p.live.end(), _handle));
+  r = range();
+  m_free_handles.push_back(_handle);
+}
+
+void buffer_arena::bind(int _page) const {
+  m_pages[static_cast<size_t>(_page)].vao->bind();
+}
+
+unsigned int buffer_arena::vertex_array_id(int _page) const {
+  return m_pages[static_cast<size_t>(_page)].vao->ID();
+}
+
+void buffer_arena::compact() {
+  for (size_t i = 0; i < m_pages.size(); ++i)
+    compact_page(static_cast<int>(i));
+}
+
+size_t buffer_arena::used_bytes() const {
+  size_t total = 0;
+  for (const auto &p : m_pages)
+    total += (p.vertex_capacity - p.free_vertices.free_total()) * p.stride +
+             (p.index_capacity - p.free_indices.free_total()) *
+                 sizeof(unsigned int);
+  return total;
+}
+
+size_t buffer_arena::capacity_bytes() const {
+  size_t total = 0;
+  for (const auto &p : m_pages)
+    total += p.vertex_capacity * p.stride +
+             p.index_capacity * sizeof(unsigned int);
+  return total;
+}
+
+// -----------------------------------------------------------------------------
+int buffer_arena::create_page(const std::vector<vertex_attribute> &_attributes,
+                              size_t _stride, size_t _vertex_count,
+                              size_t _index_count) {
+  page p;
+  p.attributes = _attributes;
+  p.stride = _stride;
+  p.vertex_capacity = std::max(m_page_vertices, _vertex_count);
+  p.index_capacity = std::max(m_page_indices, _index_count);
+  p.free_vertices.reset(p.vertex_capacity);
+  p.free_indices.reset(p.index_capacity);
+  p.vbo = std::make_unique<vertex_buffer>();
+  p.ebo = std::make_unique<index_buffer>();
+  setup_vao(p);
+  p.vao->bind();
+  p.vbo->bind();
+  p.vbo->set_data(nullptr, p.vertex_capacity * p.stride);
+  p.ebo->set_data(nullptr, p.index_capacity * sizeof(unsigned int));
+  p.vao->unbind();
+  m_pages.push_back(std::move(p));
+  return static_cast<int>(m_pages.size()) - 1;
+}
+
+void buffer_arena::setup_vao(page &_page) {
+  _page.vao = std::make_unique<vertex_array>();
+  _page.vao->bind();
+  _page.vbo->bind();
+  _page.ebo->bind();
+  _page.vao->add_attributes(_page.attributes);
+}
+
+bool buffer_arena::place(int _page, size_t _vertex_count, size_t _index_count,
+                         range &_out) {
+  page &p = m_pages[static_cast<size_t>(_page)];
+  const size_t first_vertex = p.free_vertices.allocate(_vertex_count);
+  if (first_vertex == free_list::k_no_space)
+    return false;
+  const size_t first_index = p.free_indices.allocate(_index_count);
+  if (first_index == free_list::k_no_space) {
+    p.free_vertices.release(first_vertex, _vertex_count);
+    return false;
+  }
+  _out.page = _page;
+  _out.first_vertex = first_vertex;
+  _out.vertex_count = _vertex_count;
+  _out.first_index = first_index;
+  _out.index_count = _index_count;
+  return true;
+}
+
+void buffer_arena::compact_page(int _page) {
+  page &p = m_pages[static_cast<size_t>(_page)];
+  // Copy the live ranges back to back into new buffers; copying inside one
+  // buffer would need the source and destination ranges not to overlap.
+  std::sort(p.live.begin(), p.live.end(), [this](handle _a, handle _b) {
+    return get_range(_a).first_vertex < get_range(_b).first_vertex;
+  });
+  auto vbo = std::make_unique<vertex_buffer>();
+  auto ebo = std::make_unique<index_buffer>();
+  render_state &state = render_state::instance();
+  state.bind_buffer(GL_COPY_WRITE_BUFFER, vbo->ID());
+  glBufferData(GL_COPY_WRITE_BUFFER, p.vertex_capacity * p.stride, nullptr,
+               GL_STATIC_DRAW);
+  state.bind_buffer(GL_COPY_READ_BUFFER, p.vbo->ID());
+  size_t next_vertex = 0;
+  for (handle h : p.live) {
+    range &r = m_ranges[static_cast<size_t>(h)];
+    if (r.vertex_count > 0)
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                          r.first_vertex * p.stride, next_vertex * p.stride,
+                          r.vertex_count * p.stride);
+    r.first_vertex = next_vertex;
+    next_vertex += r.vertex_count;
+  }
+
+  // Indices are relative to the base vertex and are copied unchanged.
+  state.bind_buffer(GL_COPY_WRITE_BUFFER, ebo->ID());
+  glBufferData(GL_COPY_WRITE_BUFFER, p.index_capacity * sizeof(unsigned int),
+               nullptr, GL_STATIC_DRAW);
+  state.bind_buffer(GL_COPY_READ_BUFFER, p.ebo->ID());
+  size_t next_index = 0;
+  for (handle h : p.live) {
+    range &r = m_ranges[static_cast<size_t>(h)];
+    if (r.index_count > 0)
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                          r.first_index * sizeof(unsigned int),
+                          next_index * sizeof(unsigned int),
+                          r.index_count * sizeof(unsigned int));
+    r.first_index = next_index;
+    next_index += r.index_count;
+  }
+  state.bind_buffer(GL_COPY_READ_BUFFER, 0);
+  state.bind_buffer(GL_COPY_WRITE_BUFFER, 0);
+
+  p.free_vertices.reset(p.vertex_capacity);
+  p.free_vertices.allocate(next_vertex);
+  p.free_indices.reset(p.index_capacity);
+  p.free_indices.allocate(next_index);
+
+  // Attribute pointers and the element binding refer to the old buffers.
+  p.vbo = std::move(vbo);
+  p.ebo = std::move(ebo);
+  setup_vao(p);
+  ++m_generation;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "basic/vertex_array.h"
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <vector>
+
+// Suballocates vertex and index ranges for many meshes from a few large GL
+// buffers.
+//
+// Allocations with the same vertex layout share a page: one VAO, one vertex
+// buffer and one index buffer. A mesh is drawn from its index range with a
+// base vertex, so drawing many meshes of one page needs a single VAO bind.
+// Free ranges are kept sorted by offset and merged with their neighbours on
+// release. When a page has enough free space for a request but no hole is
+// large enough, the page is compacted by copying its live ranges into fresh
+// buffers on the GPU. Offsets move when that happens, so meshes keep a handle
+// and look their range up when drawing.
+//
+// Needs a current GL context; use it from the render thread only.
+class buffer_arena {
+public:
+  using handle = int;
+  static constexpr handle k_invalid_handle = -1;
+
+  // Current location of an allocation, in vertices and indices.
+  struct range {
+    int page = -1;
+    size_t first_vertex = 0;
+    size_t vertex_count = 0;
+    size_t first_index = 0;
+    size_t index_count = 0;
+  };
+
+  // Pages hold at least _page_vertices vertices and _page_indices indices;
+  // larger requests get a page of their own size.
+  explicit buffer_arena(size_t _page_vertices = 1u << 18,
+                        size_t _page_indices = 1u << 20);
+  ~buffer_arena();
+
+  buffer_arena(const buffer_arena &) = delete;
+  buffer_arena &operator=(const buffer_arena &) = delete;
+
+  // Shared arena for meshes set up with mesh_manager::setup_shared_mesh().
+  static buffer_arena &instance();
+
+  // Copy _vertex_size bytes of vertices and _index_count unsigned int indices
+  // (may be null) into the arena. _vertex_size must be a multiple of the
+  // layout's stride.
+  handle allocate(const void *_vertices, size_t _vertex_size,
+                  const void *_indices, size_t _index_count,
+                  const std::vector<vertex_attribute> &_attributes);
+  void release(handle _handle);
+
+  const range &get_range(handle _handle) const {
+    return m_ranges[static_cast<size_t>(_handle)];
+  }
+
+  // Bind the VAO of a page; its index buffer is part of the VAO state.
+  void bind(int _page) const;
+
+  // GL name of the VAO of a page
+  unsigned int vertex_array_id(int _page) const;
+
+  // Close every hole in every page.
+  void compact();
+
+  // Incremented whenever a compaction moves ranges; cached draw lists built
+  // from get_range() are stale once it changes.
+  size_t generation() const { return m_generation; }
+
+  size_t page_count() const { return m_pages.size(); }
+  size_t used_bytes() const;
+  size_t capacity_bytes() const;
+
+private:
+  // Sorted holes of a page, merged on release.
+  class free_list {
+  public:
+    static constexpr size_t k_no_space = static_cast<size_t>(-1);
+
+    void reset(size_t _capacity);
+    // First fit; returns k_no_space if no hole is large enough.
+    size_t allocate(size_t _count);
+    void release(size_t _offset, size_t _count);
+    size_t free_total() const { return m_free_total; }
+
+  private:
+    std::map<size_t, size_t> m_holes; // offset -> count
+    size_t m_free_total = 0;
+  };
+
+  struct page {
+    std::vector<vertex_attribute> attributes;
+    size_t stride = 0;
+    size_t vertex_capacity = 0;
+    size_t index_capacity = 0;
+    std::unique_ptr<vertex_array> vao;
+    std::unique_ptr<vertex_buffer> vbo;
+    std::unique_ptr<index_buffer> ebo;
+    free_list free_vertices;
+    free_list free_indices;
+    std::vector<handle> live;
+  };
+
+  int create_page(const std::vector<vertex_attribute> &_attributes,
+                  size_t _stride, size_t _vertex_count, size_t _index_count);
+  void setup_vao(page &_page);
+  bool place(int _page, size_t _vertex_count, size_t _index_count,
+             range &_out);
+  void compact_page(int _page);
+
+  size_t m_page_vertices;
+  size_t m_page_indices;
+  std::vector<page> m_pages;
+  std::vector<range> m_ranges;
+  std::vector<handle> m_free_handles;
+  size_t m_generation = 0;
+};
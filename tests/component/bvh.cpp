@@ -0,0 +1,242 @@
+#include "tests/component/bvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void aabb::expand(const glm::vec3 &_point) {
+  min = glm::min(min, _point);
+  max = glm::max(max, _point);
+}
+
+void aabb::expand(const aabb &_box) {
+  min = glm::min(min, _box.min);
+  max = glm::max(max, _box.max);
+}
+
+float aabb::half_area() const {
+  if (empty()) {
+    return 0.0f;
+  }
+  const glm::vec3 extent = max - min;
+  return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+bvh_ray make_pick_ray(const camera &_camera, float _clip_x, float _clip_y) {
+  const glm::mat4 inverse =
+      glm::inverse(_camera.ProjectionMatrix * _camera.ViewMatrix);
+  glm::vec4 near_point = inverse * glm::vec4(_clip_x, _clip_y, -1.0f, 1.0f);
+  glm::vec4 far_point = inverse * glm::vec4(_clip_x, _clip_y, 1.0f, 1.0f);
+  near_point = near_point / near_point.w;
+  far_point = far_point / far_point.w;
+  bvh_ray ray;
+  ray.origin = glm::vec3(near_point);
+  ray.direction = glm::vec3(far_point) - glm::vec3(near_point);
+  return ray;
+}
+
+bvh_ray transform_ray(const bvh_ray &_ray, const glm::mat4 &_transform) {
+  bvh_ray ray;
+  ray.origin = glm::vec3(_transform * glm::vec4(_ray.origin, 1.0f));
+  ray.direction = glm::vec3(_transform * glm::vec4(_ray.direction, 0.0f));
+  return ray;
+}
+
+float intersect_ray_triangle(const bvh_ray &_ray, const glm::vec3 &_a,
+                             const glm::vec3 &_b, const glm::vec3 &_c) {
+  const glm::vec3 edge1 = _b - _a;
+  const glm::vec3 edge2 = _c - _a;
+  const glm::vec3 p = glm::cross(_ray.direction, edge2);
+  const float determinant = glm::dot(edge1, p);
+  if (std::fabs(determinant) < 1e-12f) {
+    return -1.0f; // Parallel to the triangle, or a degenerate triangle
+  }
+  const float inverse_determinant = 1.0f / determinant;
+  const glm::vec3 s = _ray.origin - _a;
+  const float u = glm::dot(s, p) * inverse_determinant;
+  if (u < 0.0f || u > 1.0f) {
+    return -1.0f;
+  }
+  const glm::vec3 q = glm::cross(s, edge1);
+  const float v = glm::dot(_ray.direction, q) * inverse_determinant;
+  if (v < 0.0f || u + v > 1.0f) {
+    return -1.0f;
+  }
+  return glm::dot(edge2, q) * inverse_determinant;
+}
+
+std::vector<aabb> triangle_boxes(const void *_vertices, size_t _stride,
+                                 const unsigned int *_indices,
+                                 size_t _index_count) {
+  const unsigned char *bytes = static_cast<const unsigned char *>(_vertices);
+  std::vector<aabb> boxes(_index_count / 3);
+  for (size_t t = 0; t < boxes.size(); t++) {
+    for (size_t corner = 0; corner < 3; corner++) {
+      glm::vec3 p;
+      std::memcpy(&p[0], bytes + _indices[t * 3 + corner] * _stride,
+                  3 * sizeof(float));
+      boxes[t].expand(p);
+    }
+  }
+  return boxes;
+}
+
+void bvh::build(const std::vector<aabb> &_boxes) {
+  m_nodes.clear();
+  m_items.resize(_boxes.size());
+  for (size_t i = 0; i < _boxes.size(); i++) {
+    m_items[i] = static_cast<unsigned int>(i);
+  }
+  if (_boxes.empty()) {
+    return;
+  }
+  // A binary tree with leaves of at least one item has under 2n nodes
+  m_nodes.reserve(_boxes.size() * 2);
+  m_nodes.emplace_back();
+  subdivide(0, _boxes, 0, static_cast<unsigned int>(_boxes.size()), 0);
+}
+
+void bvh::subdivide(size_t _node, const std::vector<aabb> &_boxes,
+                    unsigned int _first, unsigned int _count, int _depth) {
+  aabb bounds, centroid_bounds;
+  for (unsigned int i = _first; i < _first + _count; i++) {
+    bounds.expand(_boxes[m_items[i]]);
+    centroid_bounds.expand(_boxes[m_items[i]].center());
+  }
+  m_nodes[_node].bounds = bounds;
+  m_nodes[_node].first = _first;
+  m_nodes[_node].count = _count;
+  if (_count <= 1 || _depth >= k_max_depth) {
+    return;
+  }
+
+  // Bin the centroids along each axis and find the cheapest split plane.
+  // Costs are in units of one item test, with a node visit costing one too.
+  int best_axis = -1;
+  int best_split = 0;
+  float best_cost = std::numeric_limits<float>::max();
+  const glm::vec3 extent = centroid_bounds.max - centroid_bounds.min;
+  for (int axis = 0; axis < 3; axis++) {
+    if (extent[axis] <= 0.0f) {
+      continue;
+    }
+    aabb bins[k_bin_count];
+    unsigned int bin_counts[k_bin_count] = {};
+    const float scale = k_bin_count / extent[axis];
+    for (unsigned int i = _first; i < _first + _count; i++) {
+      const aabb &box = _boxes[m_items[i]];
+      const int bin = std::min(
+          k_bin_count - 1,
+          static_cast<int>((box.center()[axis] - centroid_bounds.min[axis]) *
+                           scale));
+      bins[bin].expand(box);
+      bin_counts[bin]++;
+    }
+    // Sweep from the right for the area of every suffix, then from the left
+    float right_areas[k_bin_count];
+    unsigned int right_counts[k_bin_count];
+    aabb right;
+    unsigned int right_count = 0;
+    for (int b = k_bin_count - 1; b > 0; b--) {
+      right.expand(bins[b]);
+      right_count += bin_counts[b];
+      right_areas[b] = right.half_area();
+      right_counts[b] = right_count;
+    }
+    aabb left;
+    unsigned int left_count = 0;
+    for (int b = 0; b < k_bin_count - 1; b++) {
+      left.expand(bins[b]);
+      left_count += bin_counts[b];
+      if (left_count == 0 || right_counts[b + 1] == 0) {
+        continue;
+      }
+      const float cost = left.half_area() * left_count +
+                         right_areas[b + 1] * right_counts[b + 1];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_split = b;
+      }
+    }
+  }
+
+  unsigned int middle = _first;
+  if (best_axis >= 0) {
+    const float area = bounds.half_area();
+    const float split_cost = 1.0f + (area > 0.0f ? best_cost / area : _count);
+    if (split_cost >= static_cast<float>(_count) &&
+        _count <= k_max_leaf_items) {
+      return; // Testing every item is cheaper than splitting
+    }
+    const float scale = k_bin_count / extent[best_axis];
+    const unsigned int *split = std::partition(
+        m_items.data() + _first, m_items.data() + _first + _count,
+        [&](unsigned int _item) {
+          const int bin = std::min(
+              k_bin_count - 1,
+              static_cast<int>((_boxes[_item].center()[best_axis] -
+                                centroid_bounds.min[best_axis]) *
+                               scale));
+          return bin <= best_split;
+        });
+    middle = static_cast<unsigned int>(split - m_items.data());
+  } else if (_count <= k_max_leaf_items) {
+    return;
+  }
+  if (middle == _first || middle == _first + _count) {
+    // All centroids coincide: halve the list to keep the leaves small
+    middle = _first + _count / 2;
+  }
+
+  const size_t left_child = m_nodes.size();
+  m_nodes.emplace_back();
+  m_nodes.emplace_back();
+  m_nodes[_node].first = static_cast<unsigned int>(left_child);
+  m_nodes[_node].count = 0;
+  subdivide(left_child, _boxes, _first, middle - _first, _depth + 1);
+  subdivide(left_child + 1, _boxes, middle, _first + _count - middle,
+            _depth + 1);
+}
+
+void bvh::refit(const std::vector<aabb> &_boxes) {
+  for (size_t n = m_nodes.size(); n-- > 0;) {
+    node &current = m_nodes[n];
+    aabb bounds;
+    if (current.count > 0) {
+      for (unsigned int i = current.first; i < current.first + current.count;
+           i++) {
+        bounds.expand(_boxes[m_items[i]]);
+      }
+    } else {
+      bounds.expand(m_nodes[current.first].bounds);
+      bounds.expand(m_nodes[current.first + 1].bounds);
+    }
+    current.bounds = bounds;
+  }
+}
+
+float bvh::enter_box(const bvh_ray &_ray, const glm::vec3 &_inverse_direction,
+                     const aabb &_box, float _max_t) {
+  float t_enter = 0.0f;
+  float t_exit = _max_t;
+  for (int axis = 0; axis < 3; axis++) {
+    float t0 = (_box.min[axis] - _ray.origin[axis]) * _inverse_direction[axis];
+    float t1 = (_box.max[axis] - _ray.origin[axis]) * _inverse_direction[axis];
+    if (t0 > t1) {
+      std::swap(t0, t1);
+    }
+    // NaN (origin on a slab of an axis-parallel ray) fails both compares
+    // and leaves the interval alone
+    if (t0 > t_enter) {
+      t_enter = t0;
+    }
+    if (t1 < t_exit) {
+      t_exit = t1;
+    }
+    if (t_enter > t_exit) {
+      return -1.0f;
+    }
+  }
+  return t_enter;
+}
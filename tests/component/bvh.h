@@ -0,0 +1,203 @@
+#pragma once
+
+#include "basic/camera.h"
+#include "tests/component/frustum.h"
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Axis-aligned box; empty until a point or box is added
+struct aabb {
+  glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+  glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+  void expand(const glm::vec3 &_point);
+  void expand(const aabb &_box);
+  bool empty() const { return min.x > max.x; }
+  glm::vec3 center() const { return (min + max) * 0.5f; }
+  // Half the surface area, which is all the SAH needs
+  float half_area() const;
+};
+
+// Points are origin + t * direction; direction need not be normalized
+struct bvh_ray {
+  glm::vec3 origin = glm::vec3(0.0f);
+  glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+};
+
+// World-space ray through a point of the camera's view, in clip coordinates
+// ([-1, 1], y up). Starts on the near plane; t = 1 is the far plane.
+bvh_ray make_pick_ray(const camera &_camera, float _clip_x, float _clip_y);
+
+// Ray in the space _transform maps to, e.g. model space with the inverse
+// model matrix. Distances along the ray stay comparable.
+bvh_ray transform_ray(const bvh_ray &_ray, const glm::mat4 &_transform);
+
+// Distance along _ray to the triangle (Moller-Trumbore, both sides), or a
+// negative value if the ray misses it
+float intersect_ray_triangle(const bvh_ray &_ray, const glm::vec3 &_a,
+                             const glm::vec3 &_b, const glm::vec3 &_c);
+
+// Boxes of the triangles of an index list, for building a triangle bvh.
+// Positions are three floats at the start of each _stride-byte vertex.
+std::vector<aabb> triangle_boxes(const void *_vertices, size_t _stride,
+                                 const unsigned int *_indices,
+                                 size_t _index_count);
+
+// Bounding volume hierarchy over a list of boxes, built with the binned
+// surface area heuristic. Items are referred to by their index in the list
+// given to build(); what they are (objects, triangles) is up to the caller,
+// who answers the exact tests in raycast() and cull().
+class bvh {
+public:
+  // Build over _boxes, replacing any previous tree
+  void build(const std::vector<aabb> &_boxes);
+
+  // Update the node bounds for items that moved, keeping the topology.
+  // _boxes must have as many items as the list the tree was built from.
+  // Much cheaper than build(), but the tree degrades as items move far.
+  void refit(const std::vector<aabb> &_boxes);
+
+  // Nearest item hit by _ray at a distance below _max_t. _intersect(item,
+  // max_t) returns the item's hit distance, or a negative value for a miss.
+  // Returns false if no item is hit; otherwise sets _t and _item.
+  template <typename tIntersect>
+  bool raycast(const bvh_ray &_ray, tIntersect &&_intersect, float &_t,
+               size_t &_item,
+               float _max_t = std::numeric_limits<float>::max()) const;
+
+  // Call _visit(item) for every item whose box may be inside _frustum.
+  // Subtrees entirely inside are reported without testing their nodes.
+  template <typename tVisit>
+  void cull(const frustum &_frustum, tVisit &&_visit) const;
+
+  bool empty() const { return m_nodes.empty(); }
+  size_t node_count() const { return m_nodes.size(); }
+  size_t item_count() const { return m_items.size(); }
+
+private:
+  // Interior nodes have count 0 and their children at first and first + 1;
+  // leaves hold m_items[first, first + count). Children always follow their
+  // parent, so refit() can work backwards through m_nodes.
+  struct node {
+    aabb bounds;
+    unsigned int first = 0;
+    unsigned int count = 0;
+  };
+
+  static constexpr unsigned int k_max_leaf_items = 4;
+  static constexpr int k_bin_count = 12;
+  // Nodes this deep become leaves whatever their size, which bounds the
+  // traversal stacks: a depth-first walk holds at most one entry per level
+  // plus the two children of the current node
+  static constexpr int k_max_depth = 60;
+  static constexpr int k_stack_size = k_max_depth + 2;
+
+  // Split m_nodes[_node], which holds m_items[_first, _first + _count)
+  void subdivide(size_t _node, const std::vector<aabb> &_boxes,
+                 unsigned int _first, unsigned int _count, int _depth);
+
+  // Distance at which _ray enters _box, or a negative value if it misses it
+  // before _max_t. _inverse_direction is 1 / _ray.direction.
+  static float enter_box(const bvh_ray &_ray,
+                         const glm::vec3 &_inverse_direction,
+                         const aabb &_box, float _max_t);
+
+  std::vector<node> m_nodes;
+  std::vector<unsigned int> m_items;
+};
+
+template <typename tIntersect>
+bool bvh::raycast(const bvh_ray &_ray, tIntersect &&_intersect, float &_t,
+                  size_t &_item, float _max_t) const {
+  if (m_nodes.empty()) {
+    return false;
+  }
+  // Infinite for axis-parallel rays, which the slab test handles
+  const glm::vec3 inverse_direction(1.0f / _ray.direction.x,
+                                    1.0f / _ray.direction.y,
+                                    1.0f / _ray.direction.z);
+  bool hit = false;
+  float nearest = _max_t;
+  unsigned int stack[k_stack_size];
+  int stack_size = 0;
+  if (enter_box(_ray, inverse_direction, m_nodes[0].bounds, nearest) < 0.0f) {
+    return false;
+  }
+  stack[stack_size++] = 0;
+  while (stack_size > 0) {
+    const node &current = m_nodes[stack[--stack_size]];
+    if (current.count > 0) {
+      for (unsigned int i = current.first; i < current.first + current.count;
+           i++) {
+        const float t = _intersect(static_cast<size_t>(m_items[i]), nearest);
+        if (t >= 0.0f && t < nearest) {
+          nearest = t;
+          _item = m_items[i];
+          hit = true;
+        }
+      }
+      continue;
+    }
+    // Visit the nearer child first, so the farther one is often skipped
+    unsigned int near_child = current.first;
+    unsigned int far_child = current.first + 1;
+    float near_t =
+        enter_box(_ray, inverse_direction, m_nodes[near_child].bounds, nearest);
+    float far_t =
+        enter_box(_ray, inverse_direction, m_nodes[far_child].bounds, nearest);
+    if (far_t >= 0.0f && (near_t < 0.0f || far_t < near_t)) {
+      std::swap(near_child, far_child);
+      std::swap(near_t, far_t);
+    }
+    if (far_t >= 0.0f) {
+      stack[stack_size++] = far_child;
+    }
+    if (near_t >= 0.0f) {
+      stack[stack_size++] = near_child;
+    }
+  }
+  if (hit) {
+    _t = nearest;
+  }
+  return hit;
+}
+
+template <typename tVisit>
+void bvh::cull(const frustum &_frustum, tVisit &&_visit) const {
+  if (m_nodes.empty()) {
+    return;
+  }
+  // Entries are node indices; the top bit marks subtrees already known to
+  // be inside, whose leaves are reported without tests
+  constexpr unsigned int k_inside = 0x80000000u;
+  unsigned int stack[k_stack_size];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size > 0) {
+    const unsigned int entry = stack[--stack_size];
+    const node &current = m_nodes[entry & ~k_inside];
+    unsigned int inside = entry & k_inside;
+    if (!inside) {
+      const frustum_test test =
+          _frustum.classify_box(current.bounds.min, current.bounds.max);
+      if (test == frustum_test::k_outside) {
+        continue;
+      }
+      if (test == frustum_test::k_inside) {
+        inside = k_inside;
+      }
+    }
+    if (current.count > 0) {
+      for (unsigned int i = current.first; i < current.first + current.count;
+           i++) {
+        _visit(static_cast<size_t>(m_items[i]));
+      }
+    } else {
+      stack[stack_size++] = (current.first + 1) | inside;
+      stack[stack_size++] = current.first | inside;
+    }
+  }
+}
@@ -0,0 +1,154 @@
+#include "tests/component/frustum.h"
+
+#include "tests/component/simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+bounding_volume bounding_volume::from_positions(const void *_vertices,
+                                                size_t _stride,
+                                                size_t _count) {
+  bounding_volume bounds;
+  if (!_vertices || _count == 0) {
+    return bounds;
+  }
+  const unsigned char *bytes = static_cast<const unsigned char *>(_vertices);
+  auto position = [&](size_t _i) {
+    glm::vec3 p;
+    std::memcpy(&p[0], bytes + _i * _stride, 3 * sizeof(float));
+    return p;
+  };
+
+  bounds.min = bounds.max = position(0);
+  for (size_t i = 1; i < _count; i++) {
+    const glm::vec3 p = position(i);
+    bounds.min = glm::min(bounds.min, p);
+    bounds.max = glm::max(bounds.max, p);
+  }
+  bounds.center = (bounds.min + bounds.max) * 0.5f;
+  float radius_squared = 0.0f;
+  for (size_t i = 0; i < _count; i++) {
+    const glm::vec3 offset = position(i) - bounds.center;
+    radius_squared = std::max(radius_squared, glm::dot(offset, offset));
+  }
+  bounds.radius = std::sqrt(radius_squared);
+  bounds.valid = true;
+  return bounds;
+}
+
+frustum::frustum(const glm::mat4 &_clip) {
+  // Rows of the column-major matrix
+  glm::vec4 rows[4];
+  for (int r = 0; r < 4; r++) {
+    rows[r] = glm::vec4(_clip[0][r], _clip[1][r], _clip[2][r], _clip[3][r]);
+  }
+  m_planes[0] = rows[3] + rows[0]; // Left
+  m_planes[1] = rows[3] - rows[0]; // Right
+  m_planes[2] = rows[3] + rows[1]; // Bottom
+  m_planes[3] = rows[3] - rows[1]; // Top
+  m_planes[4] = rows[3] + rows[2]; // Near
+  m_planes[5] = rows[3] - rows[2]; // Far
+  for (auto &plane : m_planes) {
+    const float length = glm::length(glm::vec3(plane.x, plane.y, plane.z));
+    if (length > 0.0f) {
+      plane = plane * (1.0f / length);
+    }
+  }
+}
+
+bool frustum::intersects_sphere(const glm::vec3 &_center,
+                                float _radius) const {
+  for (const auto &plane : m_planes) {
+    if (plane.x * _center.x + plane.y * _center.y + plane.z * _center.z +
+            plane.w <
+        -_radius) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool frustum::intersects_box(const glm::vec3 &_min,
+                             const glm::vec3 &_max) const {
+  for (const auto &plane : m_planes) {
+    // Corner furthest along the plane normal
+    const glm::vec3 corner(plane.x >= 0.0f ? _max.x : _min.x,
+                           plane.y >= 0.0f ? _max.y : _min.y,
+                           plane.z >= 0.0f ? _max.z : _min.z);
+    if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z +
+            plane.w <
+        0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+frustum_test frustum::classify_box(const glm::vec3 &_min,
+                                   const glm::vec3 &_max) const {
+  frustum_test result = frustum_test::k_inside;
+  for (const auto &plane : m_planes) {
+    // Corners furthest along and against the plane normal
+    const glm::vec3 positive(plane.x >= 0.0f ? _max.x : _min.x,
+                             plane.y >= 0.0f ? _max.y : _min.y,
+                             plane.z >= 0.0f ? _max.z : _min.z);
+    const glm::vec3 negative(plane.x >= 0.0f ? _min.x : _max.x,
+                             plane.y >= 0.0f ? _min.y : _max.y,
+                             plane.z >= 0.0f ? _min.z : _max.z);
+    if (glm::dot(glm::vec3(plane.x, plane.y, plane.z), positive) + plane.w <
+        0.0f) {
+      return frustum_test::k_outside;
+    }
+    if (glm::dot(glm::vec3(plane.x, plane.y, plane.z), negative) + plane.w <
+        0.0f) {
+      result = frustum_test::k_intersecting;
+    }
+  }
+  return result;
+}
+
+bool frustum::intersects(const bounding_volume &_bounds) const {
+  return !_bounds.valid ||
+         (intersects_sphere(_bounds.center, _bounds.radius) &&
+          intersects_box(_bounds.min, _bounds.max));
+}
+
+void frustum::test_spheres(const float *_x, const float *_y, const float *_z,
+                           const float *_radius, size_t _count,
+                           unsigned char *_visible) const {
+  simd::f32x4 a[6], b[6], c[6], d[6];
+  for (int p = 0; p < 6; p++) {
+    a[p] = simd::set1(m_planes[p].x);
+    b[p] = simd::set1(m_planes[p].y);
+    c[p] = simd::set1(m_planes[p].z);
+    d[p] = simd::set1(m_planes[p].w);
+  }
+  const simd::f32x4 zero = simd::set1(0.0f);
+
+  for (size_t i = 0; i < _count; i += simd::k_lanes) {
+    const size_t lanes = std::min<size_t>(simd::k_lanes, _count - i);
+    // Pad the last group; the padding lanes are ignored
+    float x[simd::k_lanes] = {}, y[simd::k_lanes] = {}, z[simd::k_lanes] = {};
+    float radius[simd::k_lanes] = {};
+    std::memcpy(x, _x + i, lanes * sizeof(float));
+    std::memcpy(y, _y + i, lanes * sizeof(float));
+    std::memcpy(z, _z + i, lanes * sizeof(float));
+    std::memcpy(radius, _radius + i, lanes * sizeof(float));
+    const simd::f32x4 vx = simd::load(x), vy = simd::load(y),
+                      vz = simd::load(z);
+    const simd::f32x4 negative_radius = simd::sub(zero, simd::load(radius));
+
+    simd::f32x4 outside = simd::cmp_lt(zero, zero);
+    for (int p = 0; p < 6; p++) {
+      const simd::f32x4 distance = simd::add(
+          simd::add(simd::mul(a[p], vx), simd::mul(b[p], vy)),
+          simd::add(simd::mul(c[p], vz), d[p]));
+      outside =
+          simd::mask_or(outside, simd::cmp_lt(distance, negative_radius));
+    }
+    const int bits = simd::mask_bits(outside);
+    for (size_t lane = 0; lane < lanes; lane++) {
+      _visible[i + lane] = (bits >> lane) & 1 ? 0 : 1;
+    }
+  }
+}
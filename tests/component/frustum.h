@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+
+// Axis-aligned box and bounding sphere of a set of positions. The sphere is
+// centered on the box, so both are cheap to compute in one pass.
+struct bounding_volume {
+  glm::vec3 min = glm::vec3(0.0f);
+  glm::vec3 max = glm::vec3(0.0f);
+  glm::vec3 center = glm::vec3(0.0f);
+  float radius = 0.0f;
+  bool valid = false; // False for no positions; never culled
+
+  // Bounds of _count positions, three floats at the start of each
+  // _stride-byte vertex
+  static bounding_volume from_positions(const void *_vertices, size_t _stride,
+                                        size_t _count);
+};
+
+// Result of frustum::classify_box
+enum class frustum_test : int { k_outside, k_intersecting, k_inside };
+
+// View frustum as six inward-facing planes, extracted from a clip matrix
+// (Gribb and Hartmann). Built from projection * view * model, the planes are
+// in model space and model-space bounds can be tested directly.
+class frustum {
+public:
+  explicit frustum(const glm::mat4 &_clip);
+
+  // Conservative tests: false only if the volume is entirely outside
+  bool intersects_sphere(const glm::vec3 &_center, float _radius) const;
+  bool intersects_box(const glm::vec3 &_min, const glm::vec3 &_max) const;
+  bool intersects(const bounding_volume &_bounds) const;
+
+  // Whether a box is outside, partly inside or entirely inside. Like the
+  // tests above it errs towards k_intersecting near the frustum's corners.
+  frustum_test classify_box(const glm::vec3 &_min,
+                            const glm::vec3 &_max) const;
+
+  // Test _count spheres stored as separate coordinate arrays, four at a time
+  // with simd.h. Sets _visible[i] to 1 if sphere i may be visible, else 0.
+  void test_spheres(const float *_x, const float *_y, const float *_z,
+                    const float *_radius, size_t _count,
+                    unsigned char *_visible) const;
+
+private:
+  glm::vec4 m_planes[6]; // xyz normal, w distance; inside is positive
+};
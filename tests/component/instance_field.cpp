@@ -0,0 +1,85 @@
+#include "tests/component/instance_field.h"
+
+#include "tests/component/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+
+void instance_field::layout(size_t _count, float _spacing,
+                            const glm::vec3 &_center) {
+  size_t side = 1;
+  while (side * side * side < _count) {
+    side++;
+  }
+  const float half_extent = 0.5f * _spacing * static_cast<float>(side - 1);
+  const float inverse_side = 1.0f / static_cast<float>(side);
+  m_positions.resize(_count);
+  m_axes.resize(_count);
+  m_speeds.resize(_count);
+  m_colors.resize(_count);
+  m_materials.resize(_count);
+  m_scale = 0.5f * _spacing;
+  for (size_t i = 0; i < _count; i++) {
+    const size_t x = i % side;
+    const size_t y = (i / side) % side;
+    const size_t z = i / (side * side);
+    const glm::vec3 cell(static_cast<float>(x), static_cast<float>(y),
+                         static_cast<float>(z));
+    const glm::vec3 unit = cell * inverse_side;
+    m_positions[i] = _center + cell * _spacing - glm::vec3(half_extent);
+    m_axes[i] = glm::normalize(unit - glm::vec3(0.5f, 0.5f, -0.5f));
+    // Golden ratio steps spread the speeds evenly without a random generator
+    m_speeds[i] = 0.5f + 1.5f * std::fmod(static_cast<float>(i) * 0.618034f,
+                                          1.0f);
+    m_colors[i] = glm::vec4(unit.x, unit.y, 1.0f - unit.z, 1.0f);
+    m_materials[i] =
+        static_cast<std::uint32_t>((x + y + z) % k_material_count);
+  }
+}
+
+void instance_field::write(float _time, size_t _first, size_t _last,
+                           instance_data *_out) const {
+  for (size_t i = _first; i < _last; i++, _out++) {
+    // Rodrigues' rotation about the unit axis, scaled, then translated
+    const glm::vec3 &axis = m_axes[i];
+    const float angle = _time * m_speeds[i];
+    const float c = std::cos(angle);
+    const float s = std::sin(angle);
+    const glm::vec3 t = axis * (1.0f - c);
+
+    instance_data instance;
+    instance.model[0] = glm::vec4(
+        glm::vec3(t.x * axis.x + c, t.x * axis.y + s * axis.z,
+                  t.x * axis.z - s * axis.y) *
+            m_scale,
+        0.0f);
+    instance.model[1] = glm::vec4(
+        glm::vec3(t.y * axis.x - s * axis.z, t.y * axis.y + c,
+                  t.y * axis.z + s * axis.x) *
+            m_scale,
+        0.0f);
+    instance.model[2] = glm::vec4(
+        glm::vec3(t.z * axis.x + s * axis.y, t.z * axis.y - s * axis.x,
+                  t.z * axis.z + c) *
+            m_scale,
+        0.0f);
+    instance.model[3] = glm::vec4(m_positions[i], 1.0f);
+    instance.color = m_colors[i];
+    instance.material = m_materials[i];
+    *_out = instance;
+  }
+}
+
+void instance_field::write(float _time, instance_data *_out,
+                           thread_pool *_pool, size_t _grain) const {
+  const size_t count = size();
+  _grain = std::max<size_t>(_grain, 1);
+  if (!_pool || count <= _grain) {
+    write(_time, 0, count, _out);
+    return;
+  }
+  const size_t chunk_count = (count + _grain - 1) / _grain;
+  _pool->parallel_for(chunk_count, [&](size_t _chunk) {
+    const size_t first = _chunk * _grain;
+    write(_time, first, std::min(count, first + _grain), _out + first);
+  });
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+class thread_pool;
+
+// Per-instance attributes drawn by instanced_renderer, tightly packed
+struct instance_data {
+  glm::mat4 model;
+  glm::vec4 color;
+  // Index into the shader's material table
+  std::uint32_t material;
+};
+
+static_assert(sizeof(instance_data) == 84,
+              "instance_data is streamed to the GPU as is");
+
+// Cubes on a grid that spin about their own axes. Writing their
+// instance_data is the CPU side of an instanced frame; it makes no GL call,
+// so tests/benchmark/instance_benchmark.cpp can time it without a window.
+class instance_field {
+public:
+  static constexpr std::uint32_t k_material_count = 4;
+
+  // Lay out _count instances on a cube-shaped grid centered on _center,
+  // _spacing apart
+  void layout(size_t _count, float _spacing = 1.0f,
+              const glm::vec3 &_center = glm::vec3(0.0f));
+
+  size_t size() const { return m_positions.size(); }
+
+  // Write instances [_first, _last) at _time seconds to _out[0], _out[1]...
+  // _out is written front to back and never read, so it can be mapped
+  // buffer memory.
+  void write(float _time, size_t _first, size_t _last,
+             instance_data *_out) const;
+
+  // Write every instance to _out, split across _pool in chunks of _grain if
+  // a pool is given
+  void write(float _time, instance_data *_out, thread_pool *_pool = nullptr,
+             size_t _grain = 4096) const;
+
+private:
+  // One array per attribute, each read front to back by write()
+  std::vector<glm::vec3> m_positions;
+  std::vector<glm::vec3> m_axes;
+  std::vector<float> m_speeds;
+  std::vector<glm::vec4> m_colors;
+  std::vector<std::uint32_t> m_materials;
+  float m_scale = 0.5f;
+};
@@ -0,0 +1,123 @@
+#include "tests/component/instanced_renderer.h"
+
+#include "basic/render_state.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+instanced_renderer::~instanced_renderer() {
+  release_fences();
+  if (m_buffer != 0) {
+    if (m_mapped) {
+      render_state::instance().bind_buffer(GL_ARRAY_BUFFER, m_buffer);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+    render_state::instance().forget_buffer(m_buffer);
+    glDeleteBuffers(1, &m_buffer);
+  }
+}
+
+void instanced_renderer::allocate(size_t _capacity) {
+  // Reallocating orphans the old storage, so draws still in flight keep
+  // reading it and the fences guarding it are no longer needed
+  m_capacity = _capacity;
+  glBufferData(GL_ARRAY_BUFFER,
+               static_cast<GLsizeiptr>(m_capacity * k_ring_regions *
+                                       sizeof(instance_data)),
+               nullptr, GL_STREAM_DRAW);
+  release_fences();
+  m_region = 0;
+}
+
+void instanced_renderer::release_fences() {
+  for (GLsync &fence : m_fences) {
+    if (fence) {
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+}
+
+instance_data *instanced_renderer::map(size_t _count) {
+  m_count = 0;
+  if (_count == 0 || m_mapped) {
+    return nullptr;
+  }
+  render_state &state = render_state::instance();
+  if (m_buffer == 0) {
+    glGenBuffers(1, &m_buffer);
+  }
+  state.bind_buffer(GL_ARRAY_BUFFER, m_buffer);
+  if (_count > m_capacity) {
+    allocate(std::max(_count, m_capacity * 2));
+  }
+
+  GLsync &fence = m_fences[m_region];
+  if (fence && !fence_signaled(fence)) {
+    m_wait_count++;
+    const GLuint64 one_second = 1000000000ull;
+    if (!fence_signaled(fence, one_second)) {
+      // The GPU may still read the region, so writing it unsynchronized is
+      // not safe; fresh storage is
+      allocate(m_capacity);
+    }
+  }
+  if (fence) {
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+
+  const size_t offset = m_region * m_capacity * sizeof(instance_data);
+  void *data = glMapBufferRange(
+      GL_ARRAY_BUFFER, static_cast<GLintptr>(offset),
+      static_cast<GLsizeiptr>(_count * sizeof(instance_data)),
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+          GL_MAP_UNSYNCHRONIZED_BIT);
+  if (!data) {
+    return nullptr;
+  }
+  m_mapped = true;
+  m_count = _count;
+  return static_cast<instance_data *>(data);
+}
+
+void instanced_renderer::draw(const mesh_manager &_mesh) {
+  if (!m_mapped) {
+    return;
+  }
+  render_state &state = render_state::instance();
+  state.bind_buffer(GL_ARRAY_BUFFER, m_buffer);
+  m_mapped = false;
+  // False if the storage was lost while mapped, e.g. on a mode switch
+  if (glUnmapBuffer(GL_ARRAY_BUFFER) == GL_FALSE) {
+    return;
+  }
+
+  _mesh.bind();
+  state.bind_buffer(GL_ARRAY_BUFFER, m_buffer);
+  const GLsizei stride = sizeof(instance_data);
+  const size_t base = m_region * m_capacity * sizeof(instance_data);
+  const auto pointer = [base](size_t _offset) {
+    return reinterpret_cast<const void *>(base + _offset);
+  };
+  for (GLuint column = 0; column < 4; column++) {
+    const GLuint location = k_model_location + column;
+    glEnableVertexAttribArray(location);
+    glVertexAttribPointer(
+        location, 4, GL_FLOAT, GL_FALSE, stride,
+        pointer(offsetof(instance_data, model) + column * sizeof(glm::vec4)));
+    glVertexAttribDivisor(location, 1);
+  }
+  glEnableVertexAttribArray(k_color_location);
+  glVertexAttribPointer(k_color_location, 4, GL_FLOAT, GL_FALSE, stride,
+                        pointer(offsetof(instance_data, color)));
+  glVertexAttribDivisor(k_color_location, 1);
+  glEnableVertexAttribArray(k_material_location);
+  glVertexAttribIPointer(k_material_location, 1, GL_UNSIGNED_INT, stride,
+                         pointer(offsetof(instance_data, material)));
+  glVertexAttribDivisor(k_material_location, 1);
+
+  _mesh.draw_instanced(m_count);
+  m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  m_region = (m_region + 1) % k_ring_regions;
+}
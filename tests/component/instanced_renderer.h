@@ -0,0 +1,65 @@
+#pragma once
+
+#include "glad/gl.h"
+#include "tests/component/instance_field.h"
+#include "tests/component/mesh_manager.h"
+#include <cstddef>
+
+// Draws one mesh many times, with an instance_data per instance streamed
+// through a ring buffer.
+//
+// GL 3.3 has no persistently mapped buffers (glBufferStorage is GL 4.4), so
+// the ring is one buffer split into k_ring_regions regions that frames fill
+// in turn. A region is mapped unsynchronized, and a fence placed after its
+// draw stops map() from handing it out again while the GPU may still read
+// it; with three regions that only waits if the GPU is two frames behind.
+// If the wait times out, the buffer is orphaned instead.
+//
+// The per-instance attributes are pointed at the current region on the
+// mesh's vertex array, at these locations:
+//   k_model_location..+3  mat4 model
+//   k_color_location      vec4 color
+//   k_material_location   uint material
+class instanced_renderer {
+public:
+  static constexpr int k_ring_regions = 3;
+  static constexpr GLuint k_model_location = 3;
+  static constexpr GLuint k_color_location = 7;
+  static constexpr GLuint k_material_location = 8;
+
+  instanced_renderer() = default;
+  ~instanced_renderer();
+
+  instanced_renderer(const instanced_renderer &) = delete;
+  instanced_renderer &operator=(const instanced_renderer &) = delete;
+
+  // Map room for _count instances in the next region, growing the ring if
+  // it is too small. The returned memory is write-only and may be filled
+  // from worker threads; it is valid until draw(). nullptr if _count is 0
+  // or mapping fails.
+  instance_data *map(size_t _count);
+
+  // Unmap the instances and draw _mesh once for each with the program in
+  // use. The instance attributes stay enabled on the mesh's vertex array.
+  void draw(const mesh_manager &_mesh);
+
+  // Instances a region holds before the ring has to grow
+  size_t get_capacity() const { return m_capacity; }
+
+  // Times map() found its region still in use by the GPU and waited
+  size_t get_wait_count() const { return m_wait_count; }
+
+private:
+  // Replace the ring's storage with _capacity instances per region; the
+  // buffer must be bound to GL_ARRAY_BUFFER
+  void allocate(size_t _capacity);
+  void release_fences();
+
+  GLuint m_buffer = 0;
+  size_t m_capacity = 0;
+  int m_region = 0;
+  size_t m_count = 0;
+  bool m_mapped = false;
+  GLsync m_fences[k_ring_regions] = {};
+  size_t m_wait_count = 0;
+};
@@ -0,0 +1,105 @@
+#include "mapped_file.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mapped_file::mapped_file(const std::string &_path) {
+#ifdef _WIN32
+  HANDLE file = CreateFileA(_path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return;
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    return;
+  }
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    CloseHandle(file);
+    return;
+  }
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return;
+  }
+  m_file = file;
+  m_mapping = mapping;
+  m_data = static_cast<const unsigned char *>(view);
+  m_size = static_cast<size_t>(size.QuadPart);
+#else
+  int fd = ::open(_path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+  struct stat info {};
+  if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+    ::close(fd);
+    return;
+  }
+  const size_t size = static_cast<size_t>(info.st_size);
+  void *view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after the descriptor is closed
+  ::close(fd);
+  if (view == MAP_FAILED)
+    return;
+  m_data = static_cast<const unsigned char *>(view);
+  m_size = size;
+#endif
+}
+
+mapped_file::~mapped_file() { close(); }
+
+mapped_file::mapped_file(mapped_file &&other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0))
+#ifdef _WIN32
+      ,
+      m_file(std::exchange(other.m_file, nullptr)),
+      m_mapping(std::exchange(other.m_mapping, nullptr))
+#endif
+{
+}
+
+mapped_file &mapped_file::operator=(mapped_file &&other) noexcept {
+  if (this != &other) {
+    close();
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+    m_file = std::exchange(other.m_file, nullptr);
+    m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+  }
+  return *this;
+}
+
+void mapped_file::close() {
+  if (!m_data)
+    return;
+#ifdef _WIN32
+  UnmapViewOfFile(m_data);
+  CloseHandle(m_mapping);
+  CloseHandle(m_file);
+  m_file = nullptr;
+  m_mapping = nullptr;
+#else
+  ::munmap(const_cast<unsigned char *>(m_data), m_size);
+#endif
+  m_data = nullptr;
+  m_size = 0;
+}
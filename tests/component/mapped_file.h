@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file.
+class mapped_file {
+public:
+  mapped_file() = default;
+  // Map _path; check is_open() for success. Empty files are not mapped.
+  explicit mapped_file(const std::string &_path);
+  ~mapped_file();
+
+  mapped_file(const mapped_file &) = delete;
+  mapped_file &operator=(const mapped_file &) = delete;
+
+  mapped_file(mapped_file &&other) noexcept;
+  mapped_file &operator=(mapped_file &&other) noexcept;
+
+  bool is_open() const { return m_data != nullptr; }
+  const unsigned char *data() const { return m_data; }
+  size_t size() const { return m_size; }
+
+private:
+  void close();
+
+  const unsigned char *m_data = nullptr;
+  size_t m_size = 0;
+#ifdef _WIN32
+  void *m_file = nullptr;
+  void *m_mapping = nullptr;
+#endif
+};
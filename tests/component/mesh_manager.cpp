@@ -2,59 +2,96 @@
 
 #include "glad/gl.h"
 
-mesh_manager::mesh_manager() = default;
+#include <algorithm>
 
-mesh_manager::~mesh_manager() {
-  delete m_VAO;
-  delete m_VBO;
-  delete m_EBO;
+namespace {
+// Orphan the bound buffer's storage and write size bytes at the start of the
+// new one; the storage only grows, by doubling.
+template <typename tBuffer>
+void stream_data(tBuffer &buffer, size_t &capacity, const void *data,
+                 size_t size) {
+  if (size > capacity)
+    capacity = std::max(size, capacity * 2);
+  buffer.set_data(nullptr, capacity, GL_STREAM_DRAW);
+  if (size > 0)
+    buffer.set_sub_data(0, data, size);
 }
 
+// Bounds of the positions, if the first attribute holds float positions
+bounding_volume bounds_of(const mesh_data &data) {
+  if (data.attributes.empty() || data.attributes[0].type != GL_FLOAT ||
+      data.attributes[0].size < 3)
+    return bounding_volume();
+  const size_t stride = vertex_array::stride_of(data.attributes);
+  return bounding_volume::from_positions(data.vertices, stride,
+                                         data.vertex_size / stride);
+}
+} // namespace
+
+mesh_manager::mesh_manager() = default;
+
+mesh_manager::~mesh_manager() { release_buffers(); }
+
 mesh_manager::mesh_manager(mesh_manager &&other) noexcept
     : m_VAO(other.m_VAO), m_VBO(other.m_VBO), m_EBO(other.m_EBO),
-      m_index_count(other.m_index_count) {
+      m_index_count(other.m_index_count),
+      m_attributes(std::move(other.m_attributes)),
+      m_vertex_capacity(other.m_vertex_capacity),
+      m_index_capacity(other.m_index_capacity),
+      m_arena_handle(other.m_arena_handle), m_bounds(other.m_bounds) {
   other.m_VAO = nullptr;
   other.m_VBO = nullptr;
   other.m_EBO = nullptr;
   other.m_index_count = 0;
+  other.m_vertex_capacity = 0;
+  other.m_index_capacity = 0;
+  other.m_arena_handle = buffer_arena::k_invalid_handle;
 }
 
 mesh_manager &mesh_manager::operator=(mesh_manager &&other) noexcept {
   if (this != &other) {
     // Clean up existing resources
-    delete m_VAO;
-    delete m_VBO;
-    delete m_EBO;
+    release_buffers();
 
     // Move resources from other
     m_VAO = other.m_VAO;
     m_VBO = other.m_VBO;
     m_EBO = other.m_EBO;
     m_index_count = other.m_index_count;
+    m_attributes = std::move(other.m_attributes);
+    m_vertex_capacity = other.m_vertex_capacity;
+    m_index_capacity = other.m_index_capacity;
+    m_bounds = other.m_bounds;
+    m_arena_handle = other.m_arena_handle;
 
     // Reset other
     other.m_VAO = nullptr;
     other.m_VBO = nullptr;
     other.m_EBO = nullptr;
     other.m_index_count = 0;
+    other.m_vertex_capacity = 0;
+    other.m_index_capacity = 0;
+    other.m_arena_handle = buffer_arena::k_invalid_handle;
   }
   return *this;
 }
 
+void mesh_manager::release_buffers() {
+  delete m_VAO;
+  m_VAO = nullptr;
+  delete m_VBO;
+  m_VBO = nullptr;
+  delete m_EBO;
+  m_EBO = nullptr;
+  if (m_arena_handle != buffer_arena::k_invalid_handle) {
+    buffer_arena::instance().release(m_arena_handle);
+    m_arena_handle = buffer_arena::k_invalid_handle;
+  }
+}
+
 void mesh_manager::setup_mesh(const mesh_data &data) {
   // Clean up existing resources
-  if (m_VAO) {
-    delete m_VAO;
-    m_VAO = nullptr;
-  }
-  if (m_VBO) {
-    delete m_VBO;
-    m_VBO = nullptr;
-  }
-  if (m_EBO) {
-    delete m_EBO;
-    m_EBO = nullptr;
-  }
+  release_buffers();
 
   // Create VAO
   m_VAO = new vertex_array();
@@ -81,9 +118,68 @@ void mesh_manager::setup_mesh(const mesh_data &data) {
   m_VAO->add_attributes(data.attributes);
 
   m_index_count = data.index_count;
+  m_attributes = data.attributes;
+  m_vertex_capacity = data.vertex_size;
+  m_index_capacity = data.indices ? data.index_count * sizeof(unsigned int) : 0;
+  m_bounds = bounds_of(data);
+}
+
+void mesh_manager::stream_mesh(const mesh_data &data) {
+  if (m_arena_handle != buffer_arena::k_invalid_handle)
+    release_buffers();
+  if (!m_VAO) {
+    m_VAO = new vertex_array();
+    m_VBO = new vertex_buffer();
+    m_attributes.clear();
+    m_vertex_capacity = 0;
+  }
+  m_VAO->bind();
+
+  m_VBO->bind();
+  stream_data(*m_VBO, m_vertex_capacity, data.vertices, data.vertex_size);
+
+  // The element buffer binding is part of the VAO state
+  if (data.indices) {
+    if (!m_EBO) {
+      m_EBO = new index_buffer();
+      m_index_capacity = 0;
+    }
+    m_EBO->bind();
+    stream_data(*m_EBO, m_index_capacity, data.indices,
+                data.index_count * sizeof(unsigned int));
+  } else if (m_EBO) {
+    delete m_EBO;
+    m_EBO = nullptr;
+    m_index_capacity = 0;
+  }
+
+  // Attribute pointers reference the VBO by name, which orphaning keeps
+  if (m_attributes.empty() || m_attributes != data.attributes) {
+    m_VAO->add_attributes(data.attributes);
+    m_attributes = data.attributes;
+  } else {
+    m_VAO->unbind();
+  }
+
+  m_index_count = data.index_count;
+  m_bounds = bounds_of(data);
+}
+
+void mesh_manager::setup_shared_mesh(const mesh_data &data) {
+  release_buffers();
+  m_arena_handle = buffer_arena::instance().allocate(
+      data.vertices, data.vertex_size, data.indices, data.index_count,
+      data.attributes);
+  m_index_count = data.index_count;
+  m_bounds = bounds_of(data);
 }
 
 void mesh_manager::bind() const {
+  if (m_arena_handle != buffer_arena::k_invalid_handle) {
+    auto &arena = buffer_arena::instance();
+    arena.bind(arena.get_range(m_arena_handle).page);
+    return;
+  }
   if (m_VAO) {
     m_VAO->bind();
   }
@@ -92,13 +188,86 @@ void mesh_manager::bind() const {
   }
 }
 
+unsigned int mesh_manager::get_vertex_array_id() const {
+  if (m_arena_handle != buffer_arena::k_invalid_handle) {
+    auto &arena = buffer_arena::instance();
+    return arena.vertex_array_id(arena.get_range(m_arena_handle).page);
+  }
+  return m_VAO ? m_VAO->ID() : 0;
+}
+
 void mesh_manager::draw() const {
-  if (m_VAO && m_EBO && m_index_count > 0) {
+  if (m_arena_handle != buffer_arena::k_invalid_handle) {
+    const auto &range = buffer_arena::instance().get_range(m_arena_handle);
+    draw_range(0, range.index_count > 0 ? range.index_count
+                                        : range.vertex_count);
+    return;
+  }
+  draw_range(0, m_index_count);
+}
+
+void mesh_manager::draw_range(size_t _first_index, size_t _index_count) const {
+  if (_index_count == 0) {
+    return;
+  }
+  if (m_arena_handle != buffer_arena::k_invalid_handle) {
+    const auto &range = buffer_arena::instance().get_range(m_arena_handle);
+    bind();
+    if (range.index_count > 0) {
+      glDrawElementsBaseVertex(
+          GL_TRIANGLES, static_cast<GLsizei>(_index_count), GL_UNSIGNED_INT,
+          reinterpret_cast<void *>((range.first_index + _first_index) *
+                                   sizeof(unsigned int)),
+          static_cast<GLint>(range.first_vertex));
+    } else {
+      glDrawArrays(GL_TRIANGLES,
+                   static_cast<GLint>(range.first_vertex + _first_index),
+                   static_cast<GLsizei>(_index_count));
+    }
+    return;
+  }
+  if (m_VAO && m_EBO) {
+    bind();
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(_index_count),
+                   GL_UNSIGNED_INT,
+                   reinterpret_cast<void *>(_first_index *
+                                            sizeof(unsigned int)));
+  } else if (m_VAO) {
+    bind();
+    glDrawArrays(GL_TRIANGLES, static_cast<GLint>(_first_index),
+                 static_cast<GLsizei>(_index_count));
+  }
+}
+
+void mesh_manager::draw_instanced(size_t _instance_count) const {
+  if (_instance_count == 0) {
+    return;
+  }
+  const auto instances = static_cast<GLsizei>(_instance_count);
+  if (m_arena_handle != buffer_arena::k_invalid_handle) {
+    const auto &range = buffer_arena::instance().get_range(m_arena_handle);
+    bind();
+    if (range.index_count > 0) {
+      glDrawElementsInstancedBaseVertex(
+          GL_TRIANGLES, static_cast<GLsizei>(range.index_count),
+          GL_UNSIGNED_INT,
+          reinterpret_cast<void *>(range.first_index * sizeof(unsigned int)),
+          instances, static_cast<GLint>(range.first_vertex));
+    } else {
+      glDrawArraysInstanced(GL_TRIANGLES,
+                            static_cast<GLint>(range.first_vertex),
+                            static_cast<GLsizei>(range.vertex_count),
+                            instances);
+    }
+    return;
+  }
+  if (m_VAO && m_EBO) {
     bind();
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_index_count),
-                   GL_UNSIGNED_INT, 0);
-  } else if (m_VAO && m_index_count > 0) {
+    glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(m_index_count),
+                            GL_UNSIGNED_INT, nullptr, instances);
+  } else if (m_VAO) {
     bind();
-    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(m_index_count));
+    glDrawArraysInstanced(GL_TRIANGLES, 0, static_cast<GLsizei>(m_index_count),
+                          instances);
   }
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "basic/vertex_array.h"
+#include "tests/component/buffer_arena.h"
+#include "tests/component/frustum.h"
 #include <vector>
 
 // Helper struct to encapsulate mesh data
@@ -38,19 +40,62 @@ public:
   // Setup mesh with vertex and index data
   void setup_mesh(const mesh_data &data);
 
+  // Upload geometry that changes every frame. The VAO and buffers are kept
+  // alive and the attributes are only set up again when the layout changes.
+  // Buffers use GL_STREAM_DRAW, grow geometrically and are orphaned before
+  // every write, so the driver can hand out fresh storage instead of waiting
+  // for the previous frame's draw to finish.
+  void stream_mesh(const mesh_data &data);
+
+  // Setup mesh in the shared buffer_arena instead of buffers of its own.
+  // Meant for static geometry that comes in many small meshes, such as
+  // imported models; draw() then issues a base-vertex draw.
+  void setup_shared_mesh(const mesh_data &data);
+
   // Bind mesh for rendering
   void bind() const;
 
+  // GL name of the VAO bind() binds; meshes in one buffer_arena page share
+  // it. 0 before any data is set up.
+  unsigned int get_vertex_array_id() const;
+
   // Get index count for drawing
   size_t get_index_count() const { return m_index_count; }
 
+  // Bounds of the positions in the last uploaded data, in model space. Only
+  // valid when the first attribute is a float position.
+  const bounding_volume &get_bounds() const { return m_bounds; }
+
+  // Allocation in the shared buffer_arena, or k_invalid_handle
+  buffer_arena::handle get_arena_handle() const { return m_arena_handle; }
+
   // Draw the mesh
   void draw() const;
 
+  // Draw _index_count indices starting at _first_index, or that range of
+  // vertices if the mesh has no indices
+  void draw_range(size_t _first_index, size_t _index_count) const;
+
+  // Draw the whole mesh _instance_count times with glDrawElementsInstanced,
+  // or glDrawArraysInstanced if it has no indices
+  void draw_instanced(size_t _instance_count) const;
+
 private:
+  void release_buffers();
+
   friend struct import_model_scene;
   vertex_array *m_VAO = nullptr;
   vertex_buffer *m_VBO = nullptr;
   index_buffer *m_EBO = nullptr;
   size_t m_index_count = 0;
+
+  // Streaming state, see stream_mesh()
+  std::vector<vertex_attribute> m_attributes;
+  size_t m_vertex_capacity = 0;
+  size_t m_index_capacity = 0;
+
+  // Allocation in buffer_arena::instance(), see setup_shared_mesh()
+  buffer_arena::handle m_arena_handle = buffer_arena::k_invalid_handle;
+
+  bounding_volume m_bounds;
 };
@@ -0,0 +1,271 @@
+#include "tests/component/mesh_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// FIFO post-transform cache simulation; vertices carry the time they
+// entered the cache.
+class fifo_cache {
+public:
+  fifo_cache(size_t _vertex_count, unsigned int _cache_size)
+      : m_entered(_vertex_count, 0), m_cache_size(_cache_size),
+        m_time(_cache_size + 1) {}
+
+  // Returns the number of misses for one triangle
+  unsigned int add_triangle(const unsigned int *_triangle) {
+    unsigned int misses = 0;
+    for (int i = 0; i < 3; ++i) {
+      const unsigned int v = _triangle[i];
+      if (m_time - m_entered[v] > m_cache_size) {
+        m_entered[v] = m_time++;
+        ++misses;
+      }
+    }
+    return misses;
+  }
+
+  void flush() { m_time += m_cache_size + 1; }
+
+private:
+  std::vector<unsigned int> m_entered;
+  unsigned int m_cache_size;
+  unsigned int m_time;
+};
+
+unsigned int count_misses(const std::vector<unsigned int> &_indices,
+                          size_t _first, size_t _last, size_t _vertex_count,
+                          unsigned int _cache_size) {
+  fifo_cache cache(_vertex_count, _cache_size);
+  unsigned int misses = 0;
+  for (size_t t = _first; t < _last; ++t)
+    misses += cache.add_triangle(&_indices[t * 3]);
+  return misses;
+}
+
+} // namespace
+
+vertex_cache_stats
+analyze_vertex_cache(const std::vector<unsigned int> &_indices,
+                     size_t _vertex_count,
+                     unsigned int _cache_size) {
+  vertex_cache_stats stats;
+  const size_t triangle_count = _indices.size() / 3;
+  if (triangle_count == 0 || _vertex_count == 0)
+    return stats;
+  const unsigned int misses =
+      count_misses(_indices, 0, triangle_count, _vertex_count, _cache_size);
+  stats.acmr = static_cast<float>(misses) / static_cast<float>(triangle_count);
+  stats.atvr = static_cast<float>(misses) / static_cast<float>(_vertex_count);
+  return stats;
+}
+
+std::vector<size_t> optimize_vertex_cache(std::vector<unsigned int> &_indices,
+                                          size_t _vertex_count,
+                                          unsigned int _cache_size) {
+  const size_t triangle_count = _indices.size() / 3;
+  std::vector<size_t> clusters;
+  if (triangle_count == 0)
+    return clusters;
+
+  // Vertex -> triangle adjacency in compressed rows
+  std::vector<unsigned int> live(_vertex_count, 0);
+  for (size_t i = 0; i < triangle_count * 3; ++i)
+    ++live[_indices[i]];
+  std::vector<size_t> first(_vertex_count + 1, 0);
+  for (size_t v = 0; v < _vertex_count; ++v)
+    first[v + 1] = first[v] + live[v];
+  std::vector<unsigned int> adjacency(first[_vertex_count]);
+  {
+    std::vector<size_t> fill(first.begin(), first.end() - 1);
+    for (size_t t = 0; t < triangle_count; ++t)
+      for (int c = 0; c < 3; ++c)
+        adjacency[fill[_indices[t * 3 + c]]++] = static_cast<unsigned int>(t);
+  }
+
+  std::vector<unsigned int> entered(_vertex_count, 0);
+  unsigned int time = _cache_size + 1;
+  std::vector<char> emitted(triangle_count, 0);
+  std::vector<unsigned int> dead_end;
+  std::vector<unsigned int> candidates;
+  std::vector<unsigned int> result;
+  result.reserve(_indices.size());
+  size_t cursor = 0;
+
+  auto in_cache = [&](unsigned int _v) {
+    return time - entered[_v] <= _cache_size;
+  };
+  // Next vertex with triangles left: recently used ones first, then scan
+  auto skip_dead_end = [&]() -> long long {
+    while (!dead_end.empty()) {
+      const unsigned int v = dead_end.back();
+      dead_end.pop_back();
+      if (live[v] > 0)
+        return v;
+    }
+    while (cursor < _vertex_count) {
+      if (live[cursor] > 0)
+        return static_cast<long long>(cursor++);
+      ++cursor;
+    }
+    return -1;
+  };
+
+  long long fan = skip_dead_end();
+  while (fan >= 0) {
+    const unsigned int f = static_cast<unsigned int>(fan);
+    if (!in_cache(f))
+      clusters.push_back(result.size() / 3);
+    candidates.clear();
+    for (size_t a = first[f]; a < first[f + 1]; ++a) {
+      const unsigned int t = adjacency[a];
+      if (emitted[t])
+        continue;
+      emitted[t] = 1;
+      for (int c = 0; c < 3; ++c) {
+        const unsigned int v = _indices[t * 3 + c];
+        result.push_back(v);
+        dead_end.push_back(v);
+        candidates.push_back(v);
+        --live[v];
+        if (!in_cache(v))
+          entered[v] = time++;
+      }
+    }
+
+    // Prefer the candidate that stays in the cache the longest while its
+    // remaining fan is emitted
+    fan = -1;
+    long long best_priority = -1;
+    for (unsigned int v : candidates) {
+      if (live[v] == 0)
+        continue;
+      long long priority = 0;
+      const long long age = static_cast<long long>(time - entered[v]);
+      if (age + 2 * static_cast<long long>(live[v]) <=
+          static_cast<long long>(_cache_size))
+        priority = age;
+      if (priority > best_priority) {
+        best_priority = priority;
+        fan = v;
+      }
+    }
+    if (fan < 0)
+      fan = skip_dead_end();
+  }
+
+  _indices = std::move(result);
+  return clusters;
+}
+
+void optimize_overdraw(std::vector<unsigned int> &_indices,
+                       const std::vector<size_t> &_clusters,
+                       const float *_positions, size_t _stride,
+                       size_t _vertex_count, float _threshold,
+                       unsigned int _cache_size) {
+  const size_t triangle_count = _indices.size() / 3;
+  if (triangle_count == 0 || _clusters.empty())
+    return;
+
+  auto position = [&](unsigned int _v, float *_out) {
+    std::memcpy(_out,
+                reinterpret_cast<const unsigned char *>(_positions) +
+                    _v * _stride,
+                3 * sizeof(float));
+  };
+
+  // Split the hard clusters wherever the cache has warmed up enough that a
+  // restart costs no more than _threshold times the cluster's ACMR
+  std::vector<size_t> soft;
+  for (size_t c = 0; c < _clusters.size(); ++c) {
+    const size_t begin = _clusters[c];
+    const size_t end =
+        c + 1 < _clusters.size() ? _clusters[c + 1] : triangle_count;
+    const float target =
+        static_cast<float>(count_misses(_indices, begin, end, _vertex_count,
+                                        _cache_size)) /
+        static_cast<float>(end - begin) * _threshold;
+    fifo_cache cache(_vertex_count, _cache_size);
+    soft.push_back(begin);
+    size_t start = begin;
+    unsigned int misses = 0;
+    for (size_t t = begin; t < end; ++t) {
+      misses += cache.add_triangle(&_indices[t * 3]);
+      const size_t length = t + 1 - start;
+      if (t + 1 < end &&
+          static_cast<float>(misses) <= target * static_cast<float>(length)) {
+        soft.push_back(t + 1);
+        start = t + 1;
+        misses = 0;
+        cache.flush();
+      }
+    }
+  }
+
+  // Area-weighted centroid and normal of every cluster, and the mesh center
+  struct cluster_info {
+    size_t begin;
+    size_t end;
+    float sort_key;
+  };
+  std::vector<cluster_info> infos(soft.size());
+  std::vector<float> centroids(soft.size() * 3, 0.0f);
+  std::vector<float> normals(soft.size() * 3, 0.0f);
+  float mesh_center[3] = {0.0f, 0.0f, 0.0f};
+  float mesh_area = 0.0f;
+  for (size_t c = 0; c < soft.size(); ++c) {
+    infos[c].begin = soft[c];
+    infos[c].end = c + 1 < soft.size() ? soft[c + 1] : triangle_count;
+    float area_sum = 0.0f;
+    for (size_t t = infos[c].begin; t < infos[c].end; ++t) {
+      float p0[3], p1[3], p2[3];
+      position(_indices[t * 3 + 0], p0);
+      position(_indices[t * 3 + 1], p1);
+      position(_indices[t * 3 + 2], p2);
+      const float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+      const float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+      const float n[3] = {e1[1] * e2[2] - e1[2] * e2[1],
+                          e1[2] * e2[0] - e1[0] * e2[2],
+                          e1[0] * e2[1] - e1[1] * e2[0]};
+      const float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+      for (int k = 0; k < 3; ++k) {
+        centroids[c * 3 + k] += (p0[k] + p1[k] + p2[k]) / 3.0f * area;
+        normals[c * 3 + k] += n[k];
+      }
+      area_sum += area;
+    }
+    for (int k = 0; k < 3; ++k)
+      mesh_center[k] += centroids[c * 3 + k];
+    mesh_area += area_sum;
+    const float inverse = area_sum > 0.0f ? 1.0f / area_sum : 0.0f;
+    for (int k = 0; k < 3; ++k)
+      centroids[c * 3 + k] *= inverse;
+  }
+  if (mesh_area > 0.0f)
+    for (int k = 0; k < 3; ++k)
+      mesh_center[k] /= mesh_area;
+
+  // Clusters facing away from the center are on the outside
+  for (size_t c = 0; c < soft.size(); ++c) {
+    const float *n = &normals[c * 3];
+    const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    float key = 0.0f;
+    if (length > 0.0f)
+      for (int k = 0; k < 3; ++k)
+        key += (centroids[c * 3 + k] - mesh_center[k]) * n[k] / length;
+    infos[c].sort_key = key;
+  }
+  std::stable_sort(infos.begin(), infos.end(),
+                   [](const cluster_info &_a, const cluster_info &_b) {
+                     return _a.sort_key > _b.sort_key;
+                   });
+
+  std::vector<unsigned int> result;
+  result.reserve(_indices.size());
+  for (const auto &info : infos)
+    result.insert(result.end(), _indices.begin() + info.begin * 3,
+                  _indices.begin() + info.end * 3);
+  _indices = std::move(result);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Triangle and vertex reordering for indexed triangle lists. Pure CPU work on
+// index arrays; nothing here touches GL.
+//
+// The usual pipeline is weld_vertices() on freshly imported meshes, then
+// optimize_vertex_cache(), then optimize_overdraw() with the clusters it
+// returned, then optimize_vertex_fetch().
+
+// Post-transform vertex cache behaviour of an index buffer, simulated with a
+// FIFO cache.
+struct vertex_cache_stats {
+  float acmr = 0.0f; // Cache misses per triangle; 0.5 is ideal, 3 is worst
+  float atvr = 0.0f; // Cache misses per vertex; 1 is ideal
+};
+
+vertex_cache_stats
+analyze_vertex_cache(const std::vector<unsigned int> &_indices,
+                     size_t _vertex_count,
+                     unsigned int _cache_size = 16);
+
+// Reorder triangles for the post-transform vertex cache with Tipsify (Sander
+// et al. 2007): fan around one vertex at a time and pick the next fan vertex
+// among the ones still in the cache. Returns the first triangle of every
+// cluster, i.e. every point where the walk had to restart with a cold cache.
+std::vector<size_t> optimize_vertex_cache(std::vector<unsigned int> &_indices,
+                                          size_t _vertex_count,
+                                          unsigned int _cache_size = 16);
+
+// Reorder the clusters of a cache-optimized index buffer so that outward
+// facing parts of the mesh are drawn first, which lets early depth testing
+// reject more of the rest. Clusters are split further wherever the cache
+// efficiency allows, within _threshold times the original ACMR.
+// _positions points at the first vertex's position (three floats), with
+// _stride bytes between vertices.
+void optimize_overdraw(std::vector<unsigned int> &_indices,
+                       const std::vector<size_t> &_clusters,
+                       const float *_positions, size_t _stride,
+                       size_t _vertex_count, float _threshold = 1.05f,
+                       unsigned int _cache_size = 16);
+
+// Renumber vertices in the order the index buffer first uses them, so
+// vertex fetch walks memory linearly. Unreferenced vertices are dropped.
+template <typename tVertex>
+void optimize_vertex_fetch(std::vector<unsigned int> &_indices,
+                           std::vector<tVertex> &_vertices) {
+  constexpr unsigned int k_unused = ~0u;
+  std::vector<unsigned int> remap(_vertices.size(), k_unused);
+  std::vector<tVertex> reordered;
+  reordered.reserve(_vertices.size());
+  for (unsigned int &index : _indices) {
+    if (remap[index] == k_unused) {
+      remap[index] = static_cast<unsigned int>(reordered.size());
+      reordered.push_back(_vertices[index]);
+    }
+    index = remap[index];
+  }
+  _vertices = std::move(reordered);
+}
+
+// Merge vertices that are bitwise identical and point the indices at the
+// surviving copy. Importers often emit every triangle corner as a vertex of
+// its own (a "soup"); until they are merged no two triangles share a vertex,
+// so the vertex cache can never hit and mesh_simplifier sees every vertex as
+// a seam. Vertices keep the order of their first copy. tVertex must be
+// trivially copyable and free of padding, since its bytes are compared.
+template <typename tVertex>
+void weld_vertices(std::vector<unsigned int> &_indices,
+                   std::vector<tVertex> &_vertices) {
+  static_assert(std::is_trivially_copyable_v<tVertex>);
+  constexpr unsigned int k_empty = ~0u;
+  auto hash = [](const tVertex &_vertex) {
+    unsigned char bytes[sizeof(tVertex)];
+    std::memcpy(bytes, &_vertex, sizeof(bytes));
+    std::uint32_t h = 2166136261u;
+    for (unsigned char byte : bytes)
+      h = (h ^ byte) * 16777619u;
+    return h;
+  };
+
+  // Open addressing over the welded vertices, at most half full
+  size_t table_size = 16;
+  while (table_size < _vertices.size() * 2)
+    table_size <<= 1;
+  std::vector<unsigned int> table(table_size, k_empty);
+  std::vector<unsigned int> remap(_vertices.size());
+  std::vector<tVertex> welded;
+  welded.reserve(_vertices.size());
+  for (size_t v = 0; v < _vertices.size(); ++v) {
+    size_t slot = hash(_vertices[v]) & (table_size - 1);
+    while (table[slot] != k_empty &&
+           std::memcmp(&welded[table[slot]], &_vertices[v], sizeof(tVertex)))
+      slot = (slot + 1) & (table_size - 1);
+    if (table[slot] == k_empty) {
+      table[slot] = static_cast<unsigned int>(welded.size());
+      welded.push_back(_vertices[v]);
+    }
+    remap[v] = table[slot];
+  }
+  for (unsigned int &index : _indices)
+    index = remap[index];
+  _vertices = std::move(welded);
+}
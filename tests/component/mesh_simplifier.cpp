@@ -0,0 +1,450 @@
+#include "tests/component/mesh_simplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+struct vec3d {
+  double x, y, z;
+};
+
+vec3d operator-(const vec3d &_a, const vec3d &_b) {
+  return {_a.x - _b.x, _a.y - _b.y, _a.z - _b.z};
+}
+
+vec3d cross(const vec3d &_a, const vec3d &_b) {
+  return {_a.y * _b.z - _a.z * _b.y, _a.z * _b.x - _a.x * _b.z,
+          _a.x * _b.y - _a.y * _b.x};
+}
+
+double dot(const vec3d &_a, const vec3d &_b) {
+  return _a.x * _b.x + _a.y * _b.y + _a.z * _b.z;
+}
+
+double length(const vec3d &_a) { return std::sqrt(dot(_a, _a)); }
+
+// Sum of squared distances to a set of weighted planes, stored as the
+// symmetric 4x4 matrix of Garland and Heckbert plus the total weight, so
+// error() / weight is a mean squared distance.
+struct quadric {
+  double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+  double a11 = 0, a12 = 0, a13 = 0;
+  double a22 = 0, a23 = 0;
+  double a33 = 0;
+  double weight = 0;
+
+  void add_plane(const vec3d &_normal, double _d, double _weight) {
+    const double a = _normal.x, b = _normal.y, c = _normal.z;
+    a00 += _weight * a * a;
+    a01 += _weight * a * b;
+    a02 += _weight * a * c;
+    a03 += _weight * a * _d;
+    a11 += _weight * b * b;
+    a12 += _weight * b * c;
+    a13 += _weight * b * _d;
+    a22 += _weight * c * c;
+    a23 += _weight * c * _d;
+    a33 += _weight * _d * _d;
+    weight += _weight;
+  }
+
+  void add(const quadric &_other) {
+    a00 += _other.a00;
+    a01 += _other.a01;
+    a02 += _other.a02;
+    a03 += _other.a03;
+    a11 += _other.a11;
+    a12 += _other.a12;
+    a13 += _other.a13;
+    a22 += _other.a22;
+    a23 += _other.a23;
+    a33 += _other.a33;
+    weight += _other.weight;
+  }
+
+  double error(const vec3d &_p) const {
+    const double x = _p.x, y = _p.y, z = _p.z;
+    const double e = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z +
+                     2 * a03 * x + a11 * y * y + 2 * a12 * y * z +
+                     2 * a13 * y + a22 * z * z + 2 * a23 * z + a33;
+    return e > 0 ? e : 0;
+  }
+};
+
+// Planes along open borders and seams count this much more than surface
+// planes, so the silhouette of an open mesh and the outline of its texture
+// charts are kept
+constexpr double k_border_weight = 10.0;
+
+enum class vertex_kind : unsigned char {
+  k_manifold,
+  k_seam,
+  k_border,
+  k_locked
+};
+
+struct collapse {
+  unsigned int from;
+  unsigned int to;
+  double cost; // Squared distance
+};
+
+std::uint64_t edge_key(unsigned int _a, unsigned int _b) {
+  return (static_cast<std::uint64_t>(_a) << 32) | _b;
+}
+
+} // namespace
+
+std::vector<unsigned int>
+simplify_mesh(const std::vector<unsigned int> &_indices,
+              const float *_positions, size_t _stride, size_t _vertex_count,
+              size_t _target_index_count, float _target_error,
+              float *_result_error) {
+  std::vector<unsigned int> indices(_indices);
+  double result_error = 0.0;
+  if (_result_error) {
+    *_result_error = 0.0f;
+  }
+  if (indices.size() < 3 || _vertex_count == 0) {
+    return indices;
+  }
+
+  std::vector<vec3d> positions(_vertex_count);
+  for (size_t v = 0; v < _vertex_count; ++v) {
+    float p[3];
+    std::memcpy(p, reinterpret_cast<const unsigned char *>(_positions) +
+                       v * _stride,
+                sizeof(p));
+    positions[v] = {p[0], p[1], p[2]};
+  }
+
+  // Vertices with the same position form one group, named by its first
+  // vertex. A group of more than one vertex lies on a seam, where the
+  // normal or texture coordinates change; collapses move whole groups, so
+  // the vertices on either side of a seam stay together
+  constexpr unsigned int k_none = ~0u;
+  std::vector<unsigned int> group(_vertex_count);
+  std::vector<unsigned int> group_next(_vertex_count, k_none);
+  {
+    struct position_hash {
+      size_t operator()(const vec3d &_p) const {
+        const float f[3] = {static_cast<float>(_p.x), static_cast<float>(_p.y),
+                            static_cast<float>(_p.z)};
+        std::uint32_t bits[3];
+        std::memcpy(bits, f, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^
+               (bits[2] * 83492791u);
+      }
+    };
+    struct position_equal {
+      bool operator()(const vec3d &_a, const vec3d &_b) const {
+        return _a.x == _b.x && _a.y == _b.y && _a.z == _b.z;
+      }
+    };
+    std::unordered_map<vec3d, unsigned int, position_hash, position_equal>
+        first_vertex;
+    first_vertex.reserve(_vertex_count);
+    std::vector<unsigned int> group_last(_vertex_count);
+    for (unsigned int v = 0; v < _vertex_count; ++v) {
+      auto inserted = first_vertex.emplace(positions[v], v);
+      group[v] = inserted.first->second;
+      if (inserted.second) {
+        group_last[v] = v;
+      } else {
+        group_next[group_last[group[v]]] = v;
+        group_last[group[v]] = v;
+      }
+    }
+  }
+
+  // Surface planes of every triangle, weighted by area. Quadrics and kinds
+  // are kept per group
+  std::vector<quadric> quadrics(_vertex_count);
+  for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+    const vec3d &p0 = positions[indices[t]];
+    const vec3d normal =
+        cross(positions[indices[t + 1]] - p0, positions[indices[t + 2]] - p0);
+    const double area = length(normal);
+    if (area <= 0.0) {
+      continue;
+    }
+    const vec3d n = {normal.x / area, normal.y / area, normal.z / area};
+    for (int c = 0; c < 3; ++c) {
+      quadrics[group[indices[t + c]]].add_plane(n, -dot(n, p0), area * 0.5);
+    }
+  }
+
+  std::vector<vertex_kind> kind(_vertex_count);
+  std::unordered_map<std::uint64_t, int> edges;
+  std::unordered_set<std::uint64_t> vertex_edges;
+  std::unordered_set<std::uint64_t> border_edges;
+  std::unordered_set<std::uint64_t> seam_edges;
+  // Classify groups from the current triangles: a directed edge between
+  // groups whose reverse is missing lies on a border, one whose reverse
+  // only exists between other vertices of the groups lies on a seam, and
+  // one that occurs twice is non-manifold, which locks its groups
+  auto classify = [&](bool _add_border_planes) {
+    edges.clear();
+    vertex_edges.clear();
+    border_edges.clear();
+    seam_edges.clear();
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+      for (int c = 0; c < 3; ++c) {
+        const unsigned int a = indices[t + c];
+        const unsigned int b = indices[t + (c + 1) % 3];
+        edges[edge_key(group[a], group[b])]++;
+        vertex_edges.insert(edge_key(a, b));
+      }
+    }
+    std::fill(kind.begin(), kind.end(), vertex_kind::k_manifold);
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+      for (int c = 0; c < 3; ++c) {
+        const unsigned int a = indices[t + c];
+        const unsigned int b = indices[t + (c + 1) % 3];
+        const unsigned int ga = group[a];
+        const unsigned int gb = group[b];
+        const auto forward = edges.find(edge_key(ga, gb));
+        const auto backward = edges.find(edge_key(gb, ga));
+        if (forward->second > 1 ||
+            (backward != edges.end() && backward->second > 1)) {
+          kind[ga] = kind[gb] = vertex_kind::k_locked;
+          continue;
+        }
+        if (backward != edges.end()) {
+          if (vertex_edges.count(edge_key(b, a)) != 0) {
+            continue;
+          }
+          seam_edges.insert(edge_key(ga, gb));
+          for (unsigned int g : {ga, gb}) {
+            if (kind[g] == vertex_kind::k_manifold) {
+              kind[g] = vertex_kind::k_seam;
+            }
+          }
+        } else {
+          border_edges.insert(edge_key(ga, gb));
+          for (unsigned int g : {ga, gb}) {
+            if (kind[g] != vertex_kind::k_locked) {
+              kind[g] = vertex_kind::k_border;
+            }
+          }
+        }
+        if (_add_border_planes) {
+          // Plane through the edge, perpendicular to the triangle. A seam
+          // edge gets one from each side
+          const vec3d &p0 = positions[indices[t]];
+          const vec3d face = cross(positions[indices[t + 1]] - p0,
+                                   positions[indices[t + 2]] - p0);
+          const vec3d edge = positions[b] - positions[a];
+          const vec3d normal = cross(edge, face);
+          const double normal_length = length(normal);
+          if (normal_length <= 0.0) {
+            continue;
+          }
+          const vec3d n = {normal.x / normal_length, normal.y / normal_length,
+                           normal.z / normal_length};
+          const double weight = dot(edge, edge) * k_border_weight;
+          quadrics[ga].add_plane(n, -dot(n, positions[a]), weight);
+          quadrics[gb].add_plane(n, -dot(n, positions[a]), weight);
+        }
+      }
+    }
+  };
+
+  auto has_edge = [](const std::unordered_set<std::uint64_t> &_set,
+                     unsigned int _ga, unsigned int _gb) {
+    return _set.count(edge_key(_ga, _gb)) != 0 ||
+           _set.count(edge_key(_gb, _ga)) != 0;
+  };
+
+  std::vector<size_t> first_triangle(_vertex_count + 1);
+  std::vector<unsigned int> adjacency;
+  std::vector<char> touched(_vertex_count);
+  std::vector<unsigned int> collapse_to(_vertex_count);
+  std::vector<collapse> candidates;
+  std::vector<std::pair<unsigned int, unsigned int>> moves;
+
+  // Fill moves with where every used vertex of group _from goes when it
+  // collapses onto group _to: the vertex of _to it shares a triangle with,
+  // so each side of a seam stays on its side. Fails if a vertex has no such
+  // neighbour (the collapse would tear the seam open) or more than one
+  auto plan_collapse = [&](unsigned int _from, unsigned int _to) {
+    moves.clear();
+    for (unsigned int v = _from; v != k_none; v = group_next[v]) {
+      unsigned int target = k_none;
+      for (size_t a = first_triangle[v]; a < first_triangle[v + 1]; ++a) {
+        const size_t t = adjacency[a] * size_t(3);
+        for (int c = 0; c < 3; ++c) {
+          const unsigned int u = indices[t + c];
+          if (group[u] != _to) {
+            continue;
+          }
+          if (target != k_none && target != u) {
+            return false;
+          }
+          target = u;
+        }
+      }
+      if (first_triangle[v] == first_triangle[v + 1]) {
+        continue; // Not used by any triangle
+      }
+      if (target == k_none) {
+        return false;
+      }
+      moves.emplace_back(v, target);
+    }
+    return !moves.empty();
+  };
+
+  // Whether the planned moves keep every triangle that survives facing the
+  // same way
+  auto can_collapse = [&](unsigned int _to) {
+    for (const auto &move : moves) {
+      for (size_t a = first_triangle[move.first];
+           a < first_triangle[move.first + 1]; ++a) {
+        const size_t t = adjacency[a] * size_t(3);
+        bool shared = false;
+        for (int c = 0; c < 3; ++c) {
+          shared = shared || group[indices[t + c]] == _to;
+        }
+        if (shared) {
+          continue; // Removed by the collapse
+        }
+        vec3d before[3], after[3];
+        for (int c = 0; c < 3; ++c) {
+          const unsigned int v = indices[t + c];
+          before[c] = positions[v];
+          after[c] = positions[v == move.first ? move.second : v];
+        }
+        const vec3d n0 = cross(before[1] - before[0], before[2] - before[0]);
+        const vec3d n1 = cross(after[1] - after[0], after[2] - after[0]);
+        if (dot(n0, n1) <= 0.0) {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+
+  const double error_limit =
+      static_cast<double>(_target_error) * static_cast<double>(_target_error);
+  bool first_pass = true;
+  while (indices.size() > _target_index_count) {
+    classify(first_pass);
+    first_pass = false;
+
+    // Vertex -> triangle adjacency of the current triangles
+    std::fill(first_triangle.begin(), first_triangle.end(), 0);
+    for (unsigned int v : indices) {
+      ++first_triangle[v + 1];
+    }
+    for (size_t v = 0; v < _vertex_count; ++v) {
+      first_triangle[v + 1] += first_triangle[v];
+    }
+    adjacency.resize(indices.size());
+    {
+      std::vector<size_t> fill(first_triangle.begin(),
+                               first_triangle.end() - 1);
+      for (size_t i = 0; i < indices.size(); ++i) {
+        adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+      }
+    }
+
+    // Border and seam groups only slide along their border or seam
+    candidates.clear();
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+      for (int c = 0; c < 3; ++c) {
+        const unsigned int a = group[indices[t + c]];
+        const unsigned int b = group[indices[t + (c + 1) % 3]];
+        for (int direction = 0; direction < 2; ++direction) {
+          const unsigned int from = direction ? b : a;
+          const unsigned int to = direction ? a : b;
+          if (kind[from] == vertex_kind::k_locked ||
+              (kind[from] == vertex_kind::k_border &&
+               (kind[to] == vertex_kind::k_manifold ||
+                !has_edge(border_edges, from, to))) ||
+              (kind[from] == vertex_kind::k_seam &&
+               (kind[to] == vertex_kind::k_manifold ||
+                !has_edge(seam_edges, from, to)))) {
+            continue;
+          }
+          quadric q = quadrics[from];
+          q.add(quadrics[to]);
+          const double cost =
+              q.weight > 0.0 ? q.error(positions[to]) / q.weight : 0.0;
+          candidates.push_back({from, to, cost});
+        }
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const collapse &_a, const collapse &_b) {
+                return _a.cost < _b.cost;
+              });
+
+    // Apply the cheapest collapses that do not share triangles, until
+    // enough triangles are gone
+    const size_t triangles_to_remove =
+        (indices.size() - _target_index_count + 2) / 3;
+    size_t removed = 0;
+    size_t applied = 0;
+    std::fill(touched.begin(), touched.end(), 0);
+    for (unsigned int v = 0; v < _vertex_count; ++v) {
+      collapse_to[v] = v;
+    }
+    for (const collapse &candidate : candidates) {
+      if (candidate.cost > error_limit || removed >= triangles_to_remove) {
+        break;
+      }
+      if (touched[candidate.from] || touched[candidate.to] ||
+          !plan_collapse(candidate.from, candidate.to) ||
+          !can_collapse(candidate.to)) {
+        continue;
+      }
+      quadrics[candidate.to].add(quadrics[candidate.from]);
+      result_error = std::max(result_error, candidate.cost);
+      ++applied;
+      for (const auto &move : moves) {
+        collapse_to[move.first] = move.second;
+        for (size_t a = first_triangle[move.first];
+             a < first_triangle[move.first + 1]; ++a) {
+          const size_t t = adjacency[a] * size_t(3);
+          bool shared = false;
+          for (int c = 0; c < 3; ++c) {
+            touched[group[indices[t + c]]] = 1;
+            shared = shared || group[indices[t + c]] == candidate.to;
+          }
+          removed += shared ? 1 : 0;
+        }
+      }
+    }
+    if (applied == 0) {
+      break;
+    }
+
+    // Rewrite the triangles and drop the ones that became degenerate
+    size_t write = 0;
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+      const unsigned int a = collapse_to[indices[t]];
+      const unsigned int b = collapse_to[indices[t + 1]];
+      const unsigned int c = collapse_to[indices[t + 2]];
+      if (group[a] == group[b] || group[b] == group[c] ||
+          group[a] == group[c]) {
+        continue;
+      }
+      indices[write++] = a;
+      indices[write++] = b;
+      indices[write++] = c;
+    }
+    indices.resize(write);
+  }
+
+  if (_result_error) {
+    *_result_error = static_cast<float>(std::sqrt(result_error));
+  }
+  return indices;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Simplify an indexed triangle list with quadric error metrics (Garland and
+// Heckbert 1997). Edges are collapsed onto one of their endpoints, so the
+// result indexes the same vertex array as _indices and can share its vertex
+// buffer.
+//
+// Simplification stops once at most _target_index_count indices remain, or
+// when the cheapest collapse left would move the surface by more than
+// _target_error, in the units of the positions. Vertices on open borders
+// only slide along the border. Vertices that share their position with
+// others (UV or normal seams) move together and only along the seam, each
+// onto the neighbour on its own side, so the seam stays closed. The mesh
+// should be welded first (see weld_vertices in mesh_optimizer.h): in a
+// triangle soup every corner is a seam of its own and nothing can move.
+// _result_error receives the largest error of any collapse made, if it is
+// not null.
+//
+// _positions points at the first vertex's position (three floats), with
+// _stride bytes between vertices.
+std::vector<unsigned int>
+simplify_mesh(const std::vector<unsigned int> &_indices,
+              const float *_positions, size_t _stride, size_t _vertex_count,
+              size_t _target_index_count, float _target_error,
+              float *_result_error = nullptr);
@@ -0,0 +1,34 @@
+#include "tests/component/parallel_recorder.h"
+
+#include <algorithm>
+
+parallel_recorder::parallel_recorder(thread_pool &_pool) : m_pool(_pool) {}
+
+void parallel_recorder::record(render_queue &_target, size_t _count,
+                               const record_fn &_record, size_t _grain) {
+  _grain = std::max<size_t>(_grain, 1);
+  m_chunk_count = (_count + _grain - 1) / _grain;
+  if (m_chunk_count <= 1) {
+    for (size_t i = 0; i < _count; i++) {
+      _record(i, _target);
+    }
+    return;
+  }
+
+  if (m_chunks.size() < m_chunk_count) {
+    m_chunks.resize(m_chunk_count);
+  }
+  m_pool.parallel_for(m_chunk_count, [&](size_t _chunk) {
+    render_queue &queue = m_chunks[_chunk];
+    queue.begin(_target);
+    const size_t last = std::min(_count, (_chunk + 1) * _grain);
+    for (size_t i = _chunk * _grain; i < last; i++) {
+      _record(i, queue);
+    }
+  });
+  // Merging in chunk order keeps submission order, so ties in the sort
+  // resolve as they would on one thread
+  for (size_t chunk = 0; chunk < m_chunk_count; chunk++) {
+    _target.append(m_chunks[chunk]);
+  }
+}
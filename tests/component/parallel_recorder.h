@@ -0,0 +1,38 @@
+#pragma once
+
+#include "tests/component/render_queue.h"
+#include "tests/component/thread_pool.h"
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Records draw packets on the thread pool. The objects of a frame are split
+// into chunks of _grain and every chunk is recorded into a render_queue of
+// its own, so workers never share a queue. The chunk queues are then merged
+// into the target in chunk order, which keeps the result identical to
+// recording on one thread; only execute() on the GL thread touches GL.
+//
+// Recording is meant for the CPU side of a frame: culling, model matrices
+// and uniform values per object. Chunk queues are kept between frames, so
+// recording does not allocate once they have grown.
+class parallel_recorder {
+public:
+  // Called once per object with its index and the queue to record into;
+  // must not call GL and may run on any thread
+  using record_fn = std::function<void(size_t, render_queue &)>;
+
+  explicit parallel_recorder(thread_pool &_pool = thread_pool::instance());
+
+  // Record _count objects into _target, whose begin() must have been called.
+  // Runs on the calling thread when there is only one chunk.
+  void record(render_queue &_target, size_t _count, const record_fn &_record,
+              size_t _grain = 256);
+
+  // Chunks the last record() call was split into
+  size_t get_chunk_count() const { return m_chunk_count; }
+
+private:
+  thread_pool &m_pool;
+  std::vector<render_queue> m_chunks;
+  size_t m_chunk_count = 0;
+};
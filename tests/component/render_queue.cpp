@@ -0,0 +1,148 @@
+#include "tests/component/render_queue.h"
+
+#include "basic/render_state.h"
+#include "glad/gl.h"
+
+void render_queue::begin(const camera &_camera) {
+  m_view = _camera.ViewMatrix;
+  m_near = _camera.Near;
+  m_far = _camera.Far;
+}
+
+void render_queue::begin(const render_queue &_other) {
+  m_view = _other.m_view;
+  m_near = _other.m_near;
+  m_far = _other.m_far;
+}
+
+void render_queue::submit(const draw_packet &_packet) {
+  glm::vec3 center(0.0f);
+  if (_packet.mesh && _packet.mesh->get_bounds().valid) {
+    center = _packet.mesh->get_bounds().center;
+  }
+  const glm::vec4 view_position =
+      m_view * _packet.model * glm::vec4(center, 1.0f);
+  // The camera looks down -z in view space
+  const float depth = (-view_position.z - m_near) / (m_far - m_near);
+
+  const std::uint32_t program = _packet.program ? _packet.program->ID() : 0;
+  const std::uint32_t vertex_array =
+      _packet.mesh ? _packet.mesh->get_vertex_array_id() : 0;
+  const std::uint32_t texture = _packet.textures[0];
+  m_keys.push_back(
+      _packet.transparent
+          ? make_transparent_key(program, vertex_array, texture, depth)
+          : make_opaque_key(program, vertex_array, texture, depth));
+  m_packets.push_back(_packet);
+  m_uniform_ranges.push_back(
+      {static_cast<std::uint32_t>(m_uniforms.size()), 0});
+}
+
+void render_queue::push_uniform(const packet_uniform &_uniform) {
+  if (m_uniform_ranges.empty()) {
+    return;
+  }
+  m_uniforms.push_back(_uniform);
+  m_uniform_ranges.back().count++;
+}
+
+void render_queue::add_uniform(const uniform_name &_name, int _value) {
+  push_uniform({_name, uniform_type::k_int, _value, glm::vec4(0.0f)});
+}
+
+void render_queue::add_uniform(const uniform_name &_name, float _value) {
+  push_uniform({_name, uniform_type::k_float, 0, glm::vec4(_value)});
+}
+
+void render_queue::add_uniform(const uniform_name &_name,
+                               const glm::vec3 &_value) {
+  push_uniform({_name, uniform_type::k_vec3, 0, glm::vec4(_value, 0.0f)});
+}
+
+void render_queue::add_uniform(const uniform_name &_name,
+                               const glm::vec4 &_value) {
+  push_uniform({_name, uniform_type::k_vec4, 0, _value});
+}
+
+void render_queue::append(render_queue &_other) {
+  const auto uniform_offset = static_cast<std::uint32_t>(m_uniforms.size());
+  m_packets.insert(m_packets.end(), _other.m_packets.begin(),
+                   _other.m_packets.end());
+  m_keys.insert(m_keys.end(), _other.m_keys.begin(), _other.m_keys.end());
+  for (uniform_range range : _other.m_uniform_ranges) {
+    range.first += uniform_offset;
+    m_uniform_ranges.push_back(range);
+  }
+  m_uniforms.insert(m_uniforms.end(), _other.m_uniforms.begin(),
+                    _other.m_uniforms.end());
+  _other.clear();
+}
+
+const std::vector<keyed_index> &render_queue::sort() {
+  m_order.resize(m_keys.size());
+  for (size_t i = 0; i < m_keys.size(); i++) {
+    m_order[i] = {m_keys[i], static_cast<std::uint32_t>(i)};
+  }
+  radix_sort(m_order, m_scratch);
+  return m_order;
+}
+
+void render_queue::execute() {
+  render_state &state = render_state::instance();
+  state.disable(GL_BLEND);
+  state.depth_mask(true);
+  bool blending = false;
+  for (const keyed_index &entry : sort()) {
+    const draw_packet &packet = m_packets[entry.index];
+    if (!packet.program || !packet.mesh) {
+      continue;
+    }
+    // Transparent packets sort last, so blending is switched on once
+    if (packet.transparent && !blending) {
+      state.enable(GL_BLEND);
+      state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+      state.depth_mask(false);
+      blending = true;
+    }
+
+    packet.program->use();
+    packet.program->set_uniform("model"_uniform, packet.model);
+    const uniform_range &range = m_uniform_ranges[entry.index];
+    for (std::uint32_t i = range.first; i < range.first + range.count; i++) {
+      const packet_uniform &uniform = m_uniforms[i];
+      switch (uniform.type) {
+      case uniform_type::k_int:
+        packet.program->set_uniform(uniform.name, uniform.int_value);
+        break;
+      case uniform_type::k_float:
+        packet.program->set_uniform(uniform.name, uniform.value.x);
+        break;
+      case uniform_type::k_vec3:
+        packet.program->set_uniform(uniform.name, glm::vec3(uniform.value));
+        break;
+      case uniform_type::k_vec4:
+        packet.program->set_uniform(uniform.name, uniform.value);
+        break;
+      }
+    }
+    for (size_t unit = 0; unit < draw_packet::k_max_textures; unit++) {
+      if (packet.textures[unit] != 0) {
+        state.bind_texture(static_cast<GLuint>(unit), GL_TEXTURE_2D,
+                           packet.textures[unit]);
+      }
+    }
+    packet.mesh->draw();
+  }
+  if (blending) {
+    state.disable(GL_BLEND);
+    state.depth_mask(true);
+  }
+  clear();
+}
+
+void render_queue::clear() {
+  m_packets.clear();
+  m_keys.clear();
+  m_uniform_ranges.clear();
+  m_uniforms.clear();
+}
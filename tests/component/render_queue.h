@@ -0,0 +1,108 @@
+#pragma once
+
+#include "basic/camera.h"
+#include "basic/shader.h"
+#include "tests/component/mesh_manager.h"
+#include "tests/component/sort_key.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// One draw recorded for later submission: everything execute() needs to
+// set up and issue it, with no GL call made while recording
+struct draw_packet {
+  static constexpr size_t k_max_textures = 4;
+
+  shader *program = nullptr;
+  const mesh_manager *mesh = nullptr;
+  // GL_TEXTURE_2D names bound to units 0..k_max_textures-1; 0 is unused
+  unsigned int textures[k_max_textures] = {};
+  // Set as the "model" uniform
+  glm::mat4 model = glm::mat4(1.0f);
+  // Blended and drawn back to front after the opaque packets, without
+  // writing depth
+  bool transparent = false;
+};
+
+// Draw packets of a frame, sorted by sort_key and submitted in one pass.
+// Scenes record packets in any order with submit() and add_uniform(), then
+// call execute(), which orders them to change as little state as possible:
+// opaque packets grouped by program, vertex array and texture, transparent
+// ones back to front.
+//
+// Recording makes no GL call, so separate queues can be recorded on separate
+// threads and merged with append(); see parallel_recorder. A single queue is
+// not thread-safe.
+class render_queue {
+public:
+  // Camera the packets' depths are measured from; call before submitting
+  void begin(const camera &_camera);
+
+  // Measure depths from the same camera as _other, e.g. in a queue recorded
+  // on a worker thread that is appended to _other afterwards
+  void begin(const render_queue &_other);
+
+  // Record a packet; its depth is that of the mesh's bounds center, or of
+  // the model origin if the mesh has no bounds
+  void submit(const draw_packet &_packet);
+
+  // Add a uniform to the last submitted packet. Names are not copied, so
+  // they must outlive execute(); string literals do.
+  void add_uniform(const uniform_name &_name, int _value);
+  void add_uniform(const uniform_name &_name, float _value);
+  void add_uniform(const uniform_name &_name, const glm::vec3 &_value);
+  void add_uniform(const uniform_name &_name, const glm::vec4 &_value);
+
+  // Move the packets of _other to the end of this queue, e.g. to merge
+  // queues recorded separately. _other is left empty.
+  void append(render_queue &_other);
+
+  // Sort the packets, draw them and clear the queue. Opaque packets are
+  // drawn without blending; afterwards blending is off and depth writes are
+  // on.
+  void execute();
+
+  // Drop the packets without drawing them
+  void clear();
+
+  size_t size() const { return m_packets.size(); }
+  bool empty() const { return m_packets.empty(); }
+
+  // Packets in submission order and their keys, for inspection
+  const std::vector<draw_packet> &packets() const { return m_packets; }
+  const std::vector<sort_key> &keys() const { return m_keys; }
+
+  // Keys and packet indices in execution order
+  const std::vector<keyed_index> &sort();
+
+private:
+  enum class uniform_type : std::uint8_t { k_int, k_float, k_vec3, k_vec4 };
+
+  struct packet_uniform {
+    uniform_name name;
+    uniform_type type;
+    int int_value;
+    glm::vec4 value;
+  };
+
+  // Uniforms of a packet are a range of m_uniforms
+  struct uniform_range {
+    std::uint32_t first = 0;
+    std::uint32_t count = 0;
+  };
+
+  void push_uniform(const packet_uniform &_uniform);
+
+  glm::mat4 m_view = glm::mat4(1.0f);
+  float m_near = 0.1f;
+  float m_far = 100.0f;
+
+  std::vector<draw_packet> m_packets;
+  std::vector<sort_key> m_keys;
+  std::vector<uniform_range> m_uniform_ranges;
+  std::vector<packet_uniform> m_uniforms;
+  // Kept between frames so sorting does not allocate
+  std::vector<keyed_index> m_order;
+  std::vector<keyed_index> m_scratch;
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LEARNOPENGL_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define LEARNOPENGL_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace simd {
+
+// Four packed floats. Comparison results are lane masks (all bits set or
+// clear) stored in the same type, to be consumed by select()/any().
+//
+// SSE2 is part of the x86-64 baseline and NEON of AArch64, so neither needs
+// extra compiler flags; other targets fall back to a plain array.
+struct f32x4 {
+#if LEARNOPENGL_SIMD_SSE2
+  __m128 v;
+#elif LEARNOPENGL_SIMD_NEON
+  float32x4_t v;
+#else
+  float v[4];
+#endif
+};
+
+constexpr int k_lanes = 4;
+
+#if LEARNOPENGL_SIMD_SSE2
+
+inline f32x4 load(const float *_p) { return {_mm_loadu_ps(_p)}; }
+inline void store(float *_p, f32x4 _a) { _mm_storeu_ps(_p, _a.v); }
+inline f32x4 set1(float _s) { return {_mm_set1_ps(_s)}; }
+inline f32x4 set(float _a, float _b, float _c, float _d) {
+  return {_mm_setr_ps(_a, _b, _c, _d)};
+}
+inline f32x4 add(f32x4 _a, f32x4 _b) { return {_mm_add_ps(_a.v, _b.v)}; }
+inline f32x4 sub(f32x4 _a, f32x4 _b) { return {_mm_sub_ps(_a.v, _b.v)}; }
+inline f32x4 mul(f32x4 _a, f32x4 _b) { return {_mm_mul_ps(_a.v, _b.v)}; }
+inline f32x4 div(f32x4 _a, f32x4 _b) { return {_mm_div_ps(_a.v, _b.v)}; }
+inline f32x4 sqrt(f32x4 _a) { return {_mm_sqrt_ps(_a.v)}; }
+inline f32x4 min(f32x4 _a, f32x4 _b) { return {_mm_min_ps(_a.v, _b.v)}; }
+inline f32x4 max(f32x4 _a, f32x4 _b) { return {_mm_max_ps(_a.v, _b.v)}; }
+inline f32x4 cmp_lt(f32x4 _a, f32x4 _b) { return {_mm_cmplt_ps(_a.v, _b.v)}; }
+inline f32x4 cmp_gt(f32x4 _a, f32x4 _b) { return {_mm_cmpgt_ps(_a.v, _b.v)}; }
+inline f32x4 mask_and(f32x4 _a, f32x4 _b) { return {_mm_and_ps(_a.v, _b.v)}; }
+inline f32x4 mask_or(f32x4 _a, f32x4 _b) { return {_mm_or_ps(_a.v, _b.v)}; }
+// Lanes of _mask pick _a, the others pick _b.
+inline f32x4 select(f32x4 _mask, f32x4 _a, f32x4 _b) {
+  return {_mm_or_ps(_mm_and_ps(_mask.v, _a.v), _mm_andnot_ps(_mask.v, _b.v))};
+}
+inline bool any(f32x4 _mask) { return _mm_movemask_ps(_mask.v) != 0; }
+// Bit i is set if lane i of _mask is set.
+inline int mask_bits(f32x4 _mask) { return _mm_movemask_ps(_mask.v); }
+
+#elif LEARNOPENGL_SIMD_NEON
+
+inline f32x4 load(const float *_p) { return {vld1q_f32(_p)}; }
+inline void store(float *_p, f32x4 _a) { vst1q_f32(_p, _a.v); }
+inline f32x4 set1(float _s) { return {vdupq_n_f32(_s)}; }
+inline f32x4 set(float _a, float _b, float _c, float _d) {
+  const float values[4] = {_a, _b, _c, _d};
+  return {vld1q_f32(values)};
+}
+inline f32x4 add(f32x4 _a, f32x4 _b) { return {vaddq_f32(_a.v, _b.v)}; }
+inline f32x4 sub(f32x4 _a, f32x4 _b) { return {vsubq_f32(_a.v, _b.v)}; }
+inline f32x4 mul(f32x4 _a, f32x4 _b) { return {vmulq_f32(_a.v, _b.v)}; }
+inline f32x4 div(f32x4 _a, f32x4 _b) { return {vdivq_f32(_a.v, _b.v)}; }
+inline f32x4 sqrt(f32x4 _a) { return {vsqrtq_f32(_a.v)}; }
+inline f32x4 min(f32x4 _a, f32x4 _b) { return {vminq_f32(_a.v, _b.v)}; }
+inline f32x4 max(f32x4 _a, f32x4 _b) { return {vmaxq_f32(_a.v, _b.v)}; }
+inline f32x4 cmp_lt(f32x4 _a, f32x4 _b) {
+  return {vreinterpretq_f32_u32(vcltq_f32(_a.v, _b.v))};
+}
+inline f32x4 cmp_gt(f32x4 _a, f32x4 _b) {
+  return {vreinterpretq_f32_u32(vcgtq_f32(_a.v, _b.v))};
+}
+inline f32x4 mask_and(f32x4 _a, f32x4 _b) {
+  return {vreinterpretq_f32_u32(
+      vandq_u32(vreinterpretq_u32_f32(_a.v), vreinterpretq_u32_f32(_b.v)))};
+}
+inline f32x4 mask_or(f32x4 _a, f32x4 _b) {
+  return {vreinterpretq_f32_u32(
+      vorrq_u32(vreinterpretq_u32_f32(_a.v), vreinterpretq_u32_f32(_b.v)))};
+}
+inline f32x4 select(f32x4 _mask, f32x4 _a, f32x4 _b) {
+  return {vbslq_f32(vreinterpretq_u32_f32(_mask.v), _a.v, _b.v)};
+}
+inline bool any(f32x4 _mask) {
+  return vmaxvq_u32(vreinterpretq_u32_f32(_mask.v)) != 0;
+}
+inline int mask_bits(f32x4 _mask) {
+  const int32x4_t shifts = {0, 1, 2, 3};
+  const uint32x4_t bits =
+      vshlq_u32(vshrq_n_u32(vreinterpretq_u32_f32(_mask.v), 31), shifts);
+  return static_cast<int>(vaddvq_u32(bits));
+}
+
+#else
+
+namespace detail {
+inline float lane_mask(bool _on) {
+  const std::uint32_t bits = _on ? 0xFFFFFFFFu : 0u;
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+inline std::uint32_t lane_bits(float _f) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &_f, sizeof(bits));
+  return bits;
+}
+} // namespace detail
+
+inline f32x4 load(const float *_p) { return {{_p[0], _p[1], _p[2], _p[3]}}; }
+inline void store(float *_p, f32x4 _a) { std::memcpy(_p, _a.v, sizeof(_a.v)); }
+inline f32x4 set1(float _s) { return {{_s, _s, _s, _s}}; }
+inline f32x4 set(float _a, float _b, float _c, float _d) {
+  return {{_a, _b, _c, _d}};
+}
+
+#define LEARNOPENGL_SIMD_LANEWISE(expr)                                        \
+  f32x4 r;                                                                     \
+  for (int i = 0; i < 4; ++i)                                                  \
+    r.v[i] = (expr);                                                           \
+  return r;
+
+inline f32x4 add(f32x4 _a, f32x4 _b) {
+  LEARNOPENGL_SIMD_LANEWISE(_a.v[i] + _b.v[i])
+}
+inline f32x4 sub(f32x4 _a, f32x4 _b) {
+  LEARNOPENGL_SIMD_LANEWISE(_a.v[i] - _b.v[i])
+}
+inline f32x4 mul(f32x4 _a, f32x4 _b) {
+  LEARNOPENGL_SIMD_LANEWISE(_a.v[i] * _b.v[i])
+}
+inline f32x4 div(f32x4 _a, f32x4 _b) {
+  LEARNOPENGL_SIMD_LANEWISE(_a.v[i] / _b.v[i])
+}
+inline f32x4 sqrt(f32x4 _a) { LEARNOPENGL_SIMD_LANEWISE(std::sqrt(_a.v[i])) }
+inline f32x4 min(f32x4 _a, f32x4 _b) {
+  LEARNOPENGL_SIMD_LANEWISE(_b.v[i] < _a.v[i] ? _b.v[i] : _a.v[i])
+}
+inline f32x4 max(f32x4 _a, f32x4 _b) {
+  LEARNOPENGL_SIMD_LANEWISE(_b.v[i] > _a.v[i] ? _b.v[i] : _a.v[i])
+}
+inline f32x4 cmp_lt(f32x4 _a, f32x4 _b) {
+  LEARNOPENGL_SIMD_LANEWISE(detail::lane_mask(_a.v[i] < _b.v[i]))
+}
+inline f32x4 cmp_gt(f32x4 _a, f32x4 _b) {
+  LEARNOPENGL_SIMD_LANEWISE(detail::lane_mask(_a.v[i] > _b.v[i]))
+}
+inline f32x4 mask_and(f32x4 _a, f32x4 _b) {
+  LEARNOPENGL_SIMD_LANEWISE(detail::lane_mask(detail::lane_bits(_a.v[i]) &&
+                                              detail::lane_bits(_b.v[i])))
+}
+inline f32x4 mask_or(f32x4 _a, f32x4 _b) {
+  LEARNOPENGL_SIMD_LANEWISE(detail::lane_mask(detail::lane_bits(_a.v[i]) ||
+                                              detail::lane_bits(_b.v[i])))
+}
+inline f32x4 select(f32x4 _mask, f32x4 _a, f32x4 _b) {
+  LEARNOPENGL_SIMD_LANEWISE(detail::lane_bits(_mask.v[i]) ? _a.v[i] : _b.v[i])
+}
+inline bool any(f32x4 _mask) {
+  for (int i = 0; i < 4; ++i)
+    if (detail::lane_bits(_mask.v[i]))
+      return true;
+  return false;
+}
+inline int mask_bits(f32x4 _mask) {
+  int bits = 0;
+  for (int i = 0; i < 4; ++i)
+    if (detail::lane_bits(_mask.v[i]))
+      bits |= 1 << i;
+  return bits;
+}
+
+#undef LEARNOPENGL_SIMD_LANEWISE
+
+#endif
+
+} // namespace simd
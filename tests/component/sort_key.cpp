@@ -0,0 +1,82 @@
+#include "tests/component/sort_key.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+sort_key field(std::uint32_t _value, unsigned _bits, unsigned _shift) {
+  const sort_key mask = (sort_key(1) << _bits) - 1;
+  return (sort_key(_value) & mask) << _shift;
+}
+
+} // namespace
+
+std::uint32_t quantize_depth(float _depth, unsigned _bits) {
+  const std::uint32_t max_value = (std::uint32_t(1) << _bits) - 1;
+  // Also catches NaN, which compares false
+  if (!(_depth > 0.0f)) {
+    return 0;
+  }
+  if (_depth >= 1.0f) {
+    return max_value;
+  }
+  return static_cast<std::uint32_t>(
+      std::lround(static_cast<double>(_depth) * max_value));
+}
+
+sort_key make_opaque_key(std::uint32_t _program, std::uint32_t _vertex_array,
+                         std::uint32_t _texture, float _depth) {
+  return field(_program, 15, 48) | field(_vertex_array, 16, 32) |
+         field(_texture, 16, 16) | field(quantize_depth(_depth, 16), 16, 0);
+}
+
+sort_key make_transparent_key(std::uint32_t _program,
+                              std::uint32_t _vertex_array,
+                              std::uint32_t _texture, float _depth) {
+  // Farther packets get smaller keys, so they are drawn first
+  const std::uint32_t far_to_near = 0xffffffu - quantize_depth(_depth, 24);
+  return k_transparent_key_bit | field(far_to_near, 24, 39) |
+         field(_program, 15, 24) | field(_vertex_array, 16, 8) |
+         field(_texture, 8, 0);
+}
+
+void radix_sort(std::vector<keyed_index> &_items,
+                std::vector<keyed_index> &_scratch) {
+  const size_t count = _items.size();
+  if (count < 2) {
+    return;
+  }
+  // Histograms of all eight bytes in one read of the keys
+  std::uint32_t histograms[8][256] = {};
+  for (const keyed_index &item : _items) {
+    for (unsigned pass = 0; pass < 8; pass++) {
+      histograms[pass][(item.key >> (pass * 8)) & 0xff]++;
+    }
+  }
+
+  _scratch.resize(count);
+  std::vector<keyed_index> *source = &_items;
+  std::vector<keyed_index> *target = &_scratch;
+  for (unsigned pass = 0; pass < 8; pass++) {
+    std::uint32_t *histogram = histograms[pass];
+    const unsigned shift = pass * 8;
+    // All keys share this byte, so the pass would not move anything
+    if (histogram[((*source)[0].key >> shift) & 0xff] == count) {
+      continue;
+    }
+    std::uint32_t offset = 0;
+    for (unsigned digit = 0; digit < 256; digit++) {
+      const std::uint32_t digit_count = histogram[digit];
+      histogram[digit] = offset;
+      offset += digit_count;
+    }
+    for (const keyed_index &item : *source) {
+      (*target)[histogram[(item.key >> shift) & 0xff]++] = item;
+    }
+    std::swap(source, target);
+  }
+  if (source != &_items) {
+    _items.swap(_scratch);
+  }
+}
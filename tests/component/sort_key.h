@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 64-bit keys that order draw packets for submission. Sorting by key puts
+// opaque packets first, grouped by program, then vertex array, then texture,
+// and front to back within a group so early depth testing rejects more.
+// Transparent packets follow, back to front, as blending needs.
+//
+// State is keyed by GL name truncated to the field's width. Names above the
+// width only cost extra state changes, since a packet carries its full state.
+// Nothing here touches GL, so keys and sorting can be checked on the CPU.
+//
+// Opaque:      | 0 | program:15 | vertex array:16 | texture:16 | depth:16 |
+// Transparent: | 1 | far-to-near depth:24 | program:15 | vertex array:16 |
+//              | texture:8 |
+
+using sort_key = std::uint64_t;
+
+constexpr sort_key k_transparent_key_bit = sort_key(1) << 63;
+
+// _depth is the distance from the camera, 0 at the near plane and 1 at the
+// far plane; values outside are clamped
+sort_key make_opaque_key(std::uint32_t _program, std::uint32_t _vertex_array,
+                         std::uint32_t _texture, float _depth);
+sort_key make_transparent_key(std::uint32_t _program,
+                              std::uint32_t _vertex_array,
+                              std::uint32_t _texture, float _depth);
+
+inline bool is_transparent_key(sort_key _key) {
+  return (_key & k_transparent_key_bit) != 0;
+}
+
+// Map _depth in [0, 1] to an integer of _bits bits, clamping outside values
+std::uint32_t quantize_depth(float _depth, unsigned _bits);
+
+// Key and the index of the packet it was made for
+struct keyed_index {
+  sort_key key;
+  std::uint32_t index;
+};
+
+// Stable LSD radix sort of _items by key, one byte per pass. Passes in which
+// every key has the same byte are skipped, so keys that differ only in a few
+// fields sort in a few passes. _scratch is resized as needed; keeping it
+// between calls avoids reallocating it every frame.
+void radix_sort(std::vector<keyed_index> &_items,
+                std::vector<keyed_index> &_scratch);
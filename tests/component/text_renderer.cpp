@@ -1,5 +1,6 @@
 #include "text_renderer.h"
 
+#include "basic/render_state.h"
 #include <glad/gl.h>
 #include <iostream>
 
@@ -52,16 +53,17 @@ text_renderer::text_renderer() {
   m_shader = new shader("shaders/text_renderer_test/vertex.shader",
                         "shaders/text_renderer_test/fragment.shader");
 
+  render_state &state = render_state::instance();
   glGenVertexArrays(1, &m_VAO);
   glGenBuffers(1, &m_VBO);
-  glBindVertexArray(m_VAO);
-  glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+  state.bind_vertex_array(m_VAO);
+  state.bind_buffer(GL_ARRAY_BUFFER, m_VBO);
   glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
   glEnableVertexAttribArray(0);
   glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat),
                         (GLvoid *)0);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
+  state.bind_buffer(GL_ARRAY_BUFFER, 0);
+  state.bind_vertex_array(0);
 
   m_initialized = true;
 }
@@ -69,7 +71,9 @@ text_renderer::text_renderer() {
 text_renderer::~text_renderer() {
   if (!m_initialized)
     return;
+  render_state &state = render_state::instance();
   for (auto &character : m_characters) {
+    state.forget_texture(character.second.TextureID);
     glDeleteTextures(1, &character.second.TextureID);
   }
   if (m_face) {
@@ -85,10 +89,12 @@ text_renderer::~text_renderer() {
     m_shader = nullptr;
   }
   if (m_VAO) {
+    state.forget_vertex_array(m_VAO);
     glDeleteVertexArrays(1, &m_VAO);
     m_VAO = 0;
   }
   if (m_VBO) {
+    state.forget_buffer(m_VBO);
     glDeleteBuffers(1, &m_VBO);
     m_VBO = 0;
   }
@@ -111,7 +117,7 @@ void text_renderer::load_character(std::uint32_t _codepoint) {
   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
   GLuint texture;
   glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
+  render_state::instance().bind_texture(GL_TEXTURE_2D, texture);
   glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, m_face->glyph->bitmap.width,
                m_face->glyph->bitmap.rows, 0, GL_RED, GL_UNSIGNED_BYTE,
                m_face->glyph->bitmap.buffer);
@@ -145,14 +151,18 @@ void text_renderer::render_text_by_pixel(const std::string &_text, float _x,
   auto to_ndc_x = [vp_w](float px) { return 2.0f * px / vp_w - 1.0f; };
   auto to_ndc_y = [vp_h](float py) { return 1.0f - 2.0f * py / vp_h; };
 
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  render_state &state = render_state::instance();
+  state.enable(GL_BLEND);
+  state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
   m_shader->use();
   m_shader->set_uniform("textColor", _color);
   m_shader->set_uniform("text", 0);
-  glActiveTexture(GL_TEXTURE0);
-  glBindVertexArray(m_VAO);
+  m_shader->set_uniform("z_offset", m_z_offset);
+  state.active_texture(0);
+  state.bind_vertex_array(m_VAO);
+  // Every glyph rewrites the same quad, so the buffer stays bound
+  state.bind_buffer(GL_ARRAY_BUFFER, m_VBO);
 
   std::vector<std::uint32_t> codepoints;
   utf8_to_codepoints(_text, codepoints);
@@ -176,18 +186,16 @@ void text_renderer::render_text_by_pixel(const std::string &_text, float _x,
         {to_ndc_x(xpos), to_ndc_y(ypos + h), 0.0, 1.0},
         {to_ndc_x(xpos + w), to_ndc_y(ypos), 1.0, 0.0},
         {to_ndc_x(xpos + w), to_ndc_y(ypos + h), 1.0, 1.0}};
-    glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    state.bind_texture(0, GL_TEXTURE_2D, ch.TextureID);
     glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    m_shader->set_uniform("z_offset", m_z_offset);
     glDrawArrays(GL_TRIANGLES, 0, 6);
     _x += (ch.Advance >> 6) * _scale;
   }
 
-  glBindVertexArray(0);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_BLEND);
+  state.bind_buffer(GL_ARRAY_BUFFER, 0);
+  state.bind_vertex_array(0);
+  state.bind_texture(0, GL_TEXTURE_2D, 0);
+  state.disable(GL_BLEND);
 }
 
 // Draw text at (_x, _y) in NDC [-1, 1]. _x,_y = baseline/origin; y axis up.
@@ -210,14 +218,18 @@ void text_renderer::render_text_by_uv(const std::string &_text, float _x,
   float px_to_ndc_x = 2.0f / vp_w;
   float px_to_ndc_y = 2.0f / vp_h;
 
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  render_state &state = render_state::instance();
+  state.enable(GL_BLEND);
+  state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
   m_shader->use();
   m_shader->set_uniform("textColor", _color);
   m_shader->set_uniform("text", 0);
-  glActiveTexture(GL_TEXTURE0);
-  glBindVertexArray(m_VAO);
+  m_shader->set_uniform("z_offset", _z_offset);
+  state.active_texture(0);
+  state.bind_vertex_array(m_VAO);
+  // Every glyph rewrites the same quad, so the buffer stays bound
+  state.bind_buffer(GL_ARRAY_BUFFER, m_VBO);
 
   std::vector<std::uint32_t> codepoints;
   utf8_to_codepoints(_text, codepoints);
@@ -241,18 +253,16 @@ void text_renderer::render_text_by_uv(const std::string &_text, float _x,
         {xpos, bottom_ndc, 0.0, 1.0},    {xpos + w, top_ndc, 1.0, 0.0},
         {xpos + w, bottom_ndc, 1.0, 1.0}};
 
-    glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    state.bind_texture(0, GL_TEXTURE_2D, ch.TextureID);
     glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    m_shader->set_uniform("z_offset", _z_offset);
     glDrawArrays(GL_TRIANGLES, 0, 6);
     _x += (ch.Advance >> 6) * _scale * px_to_ndc_x;
   }
 
-  glBindVertexArray(0);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_BLEND);
+  state.bind_buffer(GL_ARRAY_BUFFER, 0);
+  state.bind_vertex_array(0);
+  state.bind_texture(0, GL_TEXTURE_2D, 0);
+  state.disable(GL_BLEND);
 }
 
 void text_renderer::measure_text_ndc(const std::string &_text, float _scale,
@@ -0,0 +1,90 @@
+#include "tests/component/texture_cache.h"
+
+#include <filesystem>
+#include <system_error>
+
+texture_cache &texture_cache::instance() {
+  static texture_cache cache;
+  return cache;
+}
+
+std::string texture_cache::canonical_path(const std::string &_path) {
+  std::error_code error;
+  std::filesystem::path path =
+      std::filesystem::weakly_canonical(std::filesystem::path(_path), error);
+  if (error) {
+    path = std::filesystem::path(_path).lexically_normal();
+  }
+  return path.generic_string();
+}
+
+template <typename tCreate>
+std::shared_ptr<texture_2d> texture_cache::get_or_create(key _key,
+                                                         tCreate &&_create) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(_key);
+    if (it != m_entries.end()) {
+      if (auto texture = it->second.lock()) {
+        return texture;
+      }
+    }
+  }
+
+  // Load outside the lock; only the render thread creates textures, so no
+  // other thread can insert the same key meanwhile.
+  std::shared_ptr<texture_2d> texture = _create();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // Drop entries whose textures were freed
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    if (it->second.expired()) {
+      it = m_entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  m_entries[std::move(_key)] = texture;
+  return texture;
+}
+
+std::shared_ptr<texture_2d> texture_cache::get(const std::string &_path,
+                                               wrap_mode _wrap_mode,
+                                               filter_mode _filter_mode) {
+  return get_or_create(key{canonical_path(_path), _wrap_mode, _filter_mode},
+                       [&] {
+                         return std::make_shared<texture_2d>(
+                             _path.c_str(), _wrap_mode, _filter_mode);
+                       });
+}
+
+std::shared_ptr<texture_2d> texture_cache::get(const std::string &_path,
+                                               const image_data &_image,
+                                               wrap_mode _wrap_mode,
+                                               filter_mode _filter_mode) {
+  return get_or_create(
+      key{canonical_path(_path), _wrap_mode, _filter_mode}, [&] {
+        return std::make_shared<texture_2d>(_image, _wrap_mode, _filter_mode);
+      });
+}
+
+bool texture_cache::contains(const std::string &_path, wrap_mode _wrap_mode,
+                             filter_mode _filter_mode) const {
+  const key lookup{canonical_path(_path), _wrap_mode, _filter_mode};
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(lookup);
+  // expired() takes no reference, so a worker thread never ends up owning,
+  // and deleting, a GL texture
+  return it != m_entries.end() && !it->second.expired();
+}
+
+size_t texture_cache::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  size_t live = 0;
+  for (const auto &entry : m_entries) {
+    if (!entry.second.expired()) {
+      ++live;
+    }
+  }
+  return live;
+}
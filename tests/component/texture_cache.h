@@ -0,0 +1,61 @@
+#pragma once
+
+#include "basic/texture.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+// Process-wide cache of 2D textures loaded from files.
+//
+// Entries are keyed by the canonical file path together with the wrap and
+// filter mode. The cache only keeps weak references: a texture is freed as
+// soon as its last user releases it, and the next request loads it again.
+//
+// Textures are GL objects, so get() must be called on the render thread.
+// contains() may be called from any thread, e.g. to skip decoding an image
+// that is already resident.
+class texture_cache {
+public:
+  static texture_cache &instance();
+
+  texture_cache(const texture_cache &) = delete;
+  texture_cache &operator=(const texture_cache &) = delete;
+
+  // Return the cached texture, or load it from _path. Throws like
+  // texture_2d(const char *) if the file cannot be loaded.
+  std::shared_ptr<texture_2d> get(const std::string &_path,
+                                  wrap_mode _wrap_mode = wrap_mode::k_repeat,
+                                  filter_mode _filter_mode =
+                                      filter_mode::k_nearest);
+
+  // Return the cached texture, or create it from an image of _path that was
+  // already decoded, e.g. on a worker thread.
+  std::shared_ptr<texture_2d> get(const std::string &_path,
+                                  const image_data &_image,
+                                  wrap_mode _wrap_mode = wrap_mode::k_repeat,
+                                  filter_mode _filter_mode =
+                                      filter_mode::k_nearest);
+
+  // Whether a live texture for this path and sampler state exists
+  bool contains(const std::string &_path,
+                wrap_mode _wrap_mode = wrap_mode::k_repeat,
+                filter_mode _filter_mode = filter_mode::k_nearest) const;
+
+  // Number of live textures
+  size_t size() const;
+
+private:
+  texture_cache() = default;
+
+  using key = std::tuple<std::string, wrap_mode, filter_mode>;
+
+  static std::string canonical_path(const std::string &_path);
+
+  template <typename tCreate>
+  std::shared_ptr<texture_2d> get_or_create(key _key, tCreate &&_create);
+
+  mutable std::mutex m_mutex;
+  std::map<key, std::weak_ptr<texture_2d>> m_entries;
+};
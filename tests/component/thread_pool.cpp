@@ -0,0 +1,155 @@
+#include "tests/component/thread_pool.h"
+
+#include <algorithm>
+
+namespace {
+// Index of the pool queue owned by the current thread, or SIZE_MAX for
+// threads outside the pool.
+thread_local const thread_pool *t_owner_pool = nullptr;
+thread_local size_t t_queue_index = static_cast<size_t>(-1);
+} // namespace
+
+thread_pool::thread_pool(unsigned _worker_count) {
+  if (_worker_count == 0) {
+    unsigned hw = std::thread::hardware_concurrency();
+    _worker_count = hw > 1 ? hw - 1 : 1;
+  }
+  for (unsigned i = 0; i < _worker_count; ++i)
+    m_queues.push_back(std::make_unique<worker_queue>());
+  for (unsigned i = 0; i < _worker_count; ++i)
+    m_workers.emplace_back([this, i] { worker_main(i); });
+}
+
+thread_pool::~thread_pool() {
+  wait_idle();
+  {
+    std::lock_guard<std::mutex> lock(m_wake_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  for (auto &worker : m_workers)
+    worker.join();
+}
+
+thread_pool &thread_pool::instance() {
+  static thread_pool pool;
+  return pool;
+}
+
+void thread_pool::submit(job _job) {
+  size_t index = (t_owner_pool == this)
+                     ? t_queue_index
+                     : m_next_queue.fetch_add(1) % m_queues.size();
+  m_unfinished.fetch_add(1);
+  {
+    // Count the job before it can be popped, so the decrement in
+    // try_run_one never runs first and wraps the counter. Taking the wake
+    // mutex orders the increment against a worker that is about to sleep,
+    // so the notification cannot be lost; a worker woken before the push
+    // below only retries until the job shows up.
+    std::lock_guard<std::mutex> lock(m_wake_mutex);
+    m_queued.fetch_add(1);
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+    m_queues[index]->jobs.push_back(std::move(_job));
+  }
+  m_wake.notify_one();
+}
+
+void thread_pool::parallel_for(size_t _count,
+                               const std::function<void(size_t)> &_fn,
+                               size_t _grain) {
+  if (_count == 0)
+    return;
+  _grain = std::max<size_t>(_grain, 1);
+  const size_t chunks = (_count + _grain - 1) / _grain;
+  if (chunks == 1) {
+    for (size_t i = 0; i < _count; ++i)
+      _fn(i);
+    return;
+  }
+
+  // Chunks are claimed from a shared counter by the calling thread and by
+  // helper jobs, so the caller only ever runs chunks of its own batch: it
+  // never picks up unrelated (possibly long) jobs from the queues while its
+  // frame waits. Helpers that start after every chunk was claimed return at
+  // once; the batch state is shared so that they can outlive this call.
+  struct batch {
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+  };
+  auto state = std::make_shared<batch>();
+  auto run_chunks = [state, chunks, _count, _grain, &_fn] {
+    for (size_t c = state->next.fetch_add(1); c < chunks;
+         c = state->next.fetch_add(1)) {
+      const size_t end = std::min(_count, (c + 1) * _grain);
+      for (size_t i = c * _grain; i < end; ++i)
+        _fn(i);
+      state->done.fetch_add(1);
+    }
+  };
+  const size_t helpers = std::min(chunks - 1, worker_count());
+  for (size_t h = 0; h < helpers; ++h)
+    submit(run_chunks);
+  run_chunks();
+
+  // Every chunk is claimed; wait for the ones still running elsewhere.
+  while (state->done.load() < chunks)
+    std::this_thread::yield();
+}
+
+void thread_pool::wait_idle() {
+  const size_t home = (t_owner_pool == this) ? t_queue_index : 0;
+  while (m_unfinished.load() > 0) {
+    if (!try_run_one(home))
+      std::this_thread::yield();
+  }
+}
+
+void thread_pool::worker_main(size_t _index) {
+  t_owner_pool = this;
+  t_queue_index = _index;
+  while (true) {
+    if (try_run_one(_index))
+      continue;
+    std::unique_lock<std::mutex> lock(m_wake_mutex);
+    m_wake.wait(lock, [this] { return m_stop || m_queued.load() > 0; });
+    if (m_stop && m_queued.load() == 0)
+      return;
+  }
+}
+
+bool thread_pool::try_run_one(size_t _home) {
+  job next;
+  if (!pop_local(_home, next) && !steal(_home, next))
+    return false;
+  m_queued.fetch_sub(1);
+  next();
+  m_unfinished.fetch_sub(1);
+  return true;
+}
+
+bool thread_pool::pop_local(size_t _index, job &_out) {
+  worker_queue &queue = *m_queues[_index];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.jobs.empty())
+    return false;
+  _out = std::move(queue.jobs.back());
+  queue.jobs.pop_back();
+  return true;
+}
+
+bool thread_pool::steal(size_t _thief, job &_out) {
+  const size_t count = m_queues.size();
+  for (size_t offset = 1; offset < count; ++offset) {
+    worker_queue &queue = *m_queues[(_thief + offset) % count];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty())
+      continue;
+    _out = std::move(queue.jobs.front());
+    queue.jobs.pop_front();
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool.
+//
+// Every worker owns a deque: it pops its own jobs from the back (LIFO, cache
+// friendly) and, when empty, steals from the front of the other workers'
+// deques. Jobs submitted from outside the pool are distributed round-robin.
+// A thread in parallel_for works on the chunks of its own batch instead of
+// blocking, but never on other queued jobs, so a frame's parallel_for is not
+// held up by long background work. wait_idle helps with any queued job.
+class thread_pool {
+public:
+  using job = std::function<void()>;
+
+  // _worker_count == 0 picks hardware_concurrency() - 1 (at least one).
+  explicit thread_pool(unsigned _worker_count = 0);
+  ~thread_pool();
+
+  thread_pool(const thread_pool &) = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+
+  // Shared pool for engine-wide CPU work.
+  static thread_pool &instance();
+
+  // Queue a job. Safe to call from any thread, including from inside a job.
+  void submit(job _job);
+
+  // Run _fn(i) for every i in [0, _count) and return when all calls are
+  // finished. Indices are grouped into chunks of _grain.
+  void parallel_for(size_t _count, const std::function<void(size_t)> &_fn,
+                    size_t _grain = 1);
+
+  // Help run jobs until every submitted job has finished.
+  void wait_idle();
+
+  size_t worker_count() const { return m_workers.size(); }
+
+private:
+  struct worker_queue {
+    std::mutex mutex;
+    std::deque<job> jobs;
+  };
+
+  void worker_main(size_t _index);
+  bool try_run_one(size_t _home);
+  bool pop_local(size_t _index, job &_out);
+  bool steal(size_t _thief, job &_out);
+
+  std::vector<std::thread> m_workers;
+  std::vector<std::unique_ptr<worker_queue>> m_queues;
+  std::atomic<size_t> m_next_queue{0};
+  std::atomic<size_t> m_queued{0};
+  std::atomic<size_t> m_unfinished{0};
+  std::mutex m_wake_mutex;
+  std::condition_variable m_wake;
+  std::atomic<bool> m_stop{false};
+};
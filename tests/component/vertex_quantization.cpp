@@ -0,0 +1,129 @@
+#include "tests/component/vertex_quantization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+std::uint16_t quantize_unorm16(float _value) {
+  const float clamped = std::min(std::max(_value, 0.0f), 1.0f);
+  return static_cast<std::uint16_t>(clamped * 65535.0f + 0.5f);
+}
+
+float dequantize_unorm16(std::uint16_t _value) {
+  return static_cast<float>(_value) / 65535.0f;
+}
+
+std::uint16_t float_to_half(float _value) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &_value, sizeof(bits));
+  const std::uint16_t sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000);
+  const std::uint32_t exponent = (bits >> 23) & 0xff;
+  std::uint32_t mantissa = bits & 0x7fffff;
+
+  if (exponent == 0xff) {
+    // Infinity, or NaN with a mantissa bit kept set
+    return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+  }
+  const int half_exponent = static_cast<int>(exponent) - 127 + 15;
+  if (half_exponent >= 0x1f) {
+    return sign | 0x7c00;
+  }
+  if (half_exponent <= 0) {
+    // Subnormal half, or zero when even that is too small
+    if (half_exponent < -10) {
+      return sign;
+    }
+    mantissa |= 0x800000;
+    const int shift = 14 - half_exponent;
+    std::uint32_t half_mantissa = mantissa >> shift;
+    const std::uint32_t rest = mantissa & ((1u << shift) - 1);
+    const std::uint32_t halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (half_mantissa & 1))) {
+      half_mantissa++;
+    }
+    return sign | static_cast<std::uint16_t>(half_mantissa);
+  }
+  std::uint32_t half = (static_cast<std::uint32_t>(half_exponent) << 10) |
+                       (mantissa >> 13);
+  const std::uint32_t rest = mantissa & 0x1fff;
+  if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+    half++; // May carry into the exponent, up to infinity, which is right
+  }
+  return sign | static_cast<std::uint16_t>(half);
+}
+
+float half_to_float(std::uint16_t _value) {
+  const std::uint32_t sign = static_cast<std::uint32_t>(_value & 0x8000) << 16;
+  const std::uint32_t exponent = (_value >> 10) & 0x1f;
+  const std::uint32_t mantissa = _value & 0x3ff;
+  std::uint32_t bits;
+  if (exponent == 0x1f) {
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  } else if (exponent != 0) {
+    bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+  } else if (mantissa == 0) {
+    bits = sign;
+  } else {
+    // Subnormal half: exact as a normal float
+    const float value = std::ldexp(static_cast<float>(mantissa), -24);
+    std::memcpy(&bits, &value, sizeof(bits));
+    bits |= sign;
+  }
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+glm::vec2 encode_octahedral(const glm::vec3 &_normal) {
+  const float l1 =
+      std::fabs(_normal.x) + std::fabs(_normal.y) + std::fabs(_normal.z);
+  if (l1 <= 0.0f) {
+    return glm::vec2(0.0f, 0.0f);
+  }
+  glm::vec2 p(_normal.x / l1, _normal.y / l1);
+  if (_normal.z < 0.0f) {
+    const glm::vec2 folded((1.0f - std::fabs(p.y)) * (p.x >= 0.0f ? 1 : -1),
+                           (1.0f - std::fabs(p.x)) * (p.y >= 0.0f ? 1 : -1));
+    p = folded;
+  }
+  return p;
+}
+
+glm::vec3 decode_octahedral(const glm::vec2 &_encoded) {
+  glm::vec3 n(_encoded.x, _encoded.y,
+              1.0f - std::fabs(_encoded.x) - std::fabs(_encoded.y));
+  const float t = std::max(-n.z, 0.0f);
+  n.x += n.x >= 0.0f ? -t : t;
+  n.y += n.y >= 0.0f ? -t : t;
+  return glm::normalize(n);
+}
+
+void encode_octahedral_unorm16(const glm::vec3 &_normal,
+                               std::uint16_t _encoded[2]) {
+  const glm::vec2 exact = encode_octahedral(_normal);
+  const float u = (exact.x * 0.5f + 0.5f) * 65535.0f;
+  const float v = (exact.y * 0.5f + 0.5f) * 65535.0f;
+  const float base_u = std::floor(u);
+  const float base_v = std::floor(v);
+  float best = -2.0f;
+  for (int i = 0; i < 4; i++) {
+    const float candidate_u = std::min(base_u + (i & 1), 65535.0f);
+    const float candidate_v = std::min(base_v + (i >> 1), 65535.0f);
+    const std::uint16_t candidate[2] = {
+        static_cast<std::uint16_t>(candidate_u),
+        static_cast<std::uint16_t>(candidate_v)};
+    const float similarity =
+        glm::dot(decode_octahedral_unorm16(candidate), _normal);
+    if (similarity > best) {
+      best = similarity;
+      _encoded[0] = candidate[0];
+      _encoded[1] = candidate[1];
+    }
+  }
+}
+
+glm::vec3 decode_octahedral_unorm16(const std::uint16_t _encoded[2]) {
+  return decode_octahedral(
+      glm::vec2(dequantize_unorm16(_encoded[0]) * 2.0f - 1.0f,
+                dequantize_unorm16(_encoded[1]) * 2.0f - 1.0f));
+}
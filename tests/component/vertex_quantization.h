@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Conversions for compact vertex attributes. Each encoder has a decoder that
+// matches what GL and the shaders do with the stored value, so the error of a
+// round trip is the error the GPU sees.
+
+// Value in [0, 1] to an unsigned normalized 16-bit integer, rounded to the
+// nearest step; GL reads it back as _value / 65535
+std::uint16_t quantize_unorm16(float _value);
+float dequantize_unorm16(std::uint16_t _value);
+
+// IEEE 754 half precision, rounded to nearest even. Out of range values
+// become infinity, NaN stays NaN.
+std::uint16_t float_to_half(float _value);
+float half_to_float(std::uint16_t _value);
+
+// Unit vector to a point in [-1, 1]^2 by projecting onto an octahedron and
+// folding the lower half over the upper one (Cigolle et al. 2014)
+glm::vec2 encode_octahedral(const glm::vec3 &_normal);
+glm::vec3 decode_octahedral(const glm::vec2 &_encoded);
+
+// Octahedral encoding stored as two unorm16 values. Of the four grid points
+// around the exact encoding, picks the one that decodes closest to _normal.
+void encode_octahedral_unorm16(const glm::vec3 &_normal,
+                               std::uint16_t _encoded[2]);
+glm::vec3 decode_octahedral_unorm16(const std::uint16_t _encoded[2]);
@@ -1,5 +1,7 @@
 #include "tests/framework/test_suit.h"
 
+#include "basic/program_binary_cache.h"
+#include "basic/render_state.h"
 #include "glad/gl.h"
 #include "imgui.h"
 #include "tests/scenes/advanced_glsl_scene.h"
@@ -32,6 +34,7 @@
 #include "tests/scenes/tessellation_shader_scene.h"
 #include "tests/scenes/transform_test_scene.h"
 #include "tests/scenes/triangle_test_scene.h"
+#include <chrono>
 #include <exception>
 #include <fstream>
 #include <iostream>
@@ -45,6 +48,7 @@ test_suit::~test_suit() {
 }
 
 void test_suit::init(GLFWwindow *_window) {
+  const auto start = std::chrono::steady_clock::now();
   try {
     // Create and initialize all test scenes
     REGISTER_SCENE(test_scene::k_texture_test, texture_test_scene);
@@ -80,6 +84,14 @@ void test_suit::init(GLFWwindow *_window) {
 #if LEARNOPENGL_USE_OCCT
     REGISTER_SCENE(test_scene::k_occt_demo_test, occt_demo_scene);
 #endif
+    const auto &programs = program_binary_cache::instance();
+    std::cout << "Initialized scenes in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count()
+              << " ms (shader programs: " << programs.get_hit_count()
+              << " cached, " << programs.get_miss_count() << " compiled)"
+              << std::endl;
   } catch (const std::exception &e) {
     std::cerr << "Error initializing test scenes: " << e.what() << std::endl;
     throw; // Re-throw to be caught by main
@@ -100,9 +112,10 @@ void test_suit::render_ui() {
       test_scene scene = static_cast<test_scene>(i);
       bool is_selected = (m_current_scene == scene);
       if (ImGui::RadioButton(get_scene_name(scene), is_selected)) {
-        glEnable(GL_DEPTH_TEST);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        render_state &state = render_state::instance();
+        state.enable(GL_DEPTH_TEST);
+        state.enable(GL_BLEND);
+        state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         m_current_scene = scene;
       }
     }
@@ -115,9 +128,10 @@ void test_suit::render_ui() {
       test_scene scene = static_cast<test_scene>(i);
       bool is_selected = (m_current_scene == scene);
       if (ImGui::RadioButton(get_scene_name(scene), is_selected)) {
-        glEnable(GL_DEPTH_TEST);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        render_state &state = render_state::instance();
+        state.enable(GL_DEPTH_TEST);
+        state.enable(GL_BLEND);
+        state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         m_current_scene = scene;
       }
     }
@@ -138,6 +152,10 @@ void test_suit::render_ui() {
   ImGui::Separator();
   ImGui::Text("Application average %.3f ms/frame (%.1f FPS)",
               1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+  render_state &state = render_state::instance();
+  ImGui::Text("GL state calls: %zu issued, %zu skipped",
+              state.get_issued_count(), state.get_skipped_count());
+  ImGui::Checkbox("Skip redundant GL state calls", &state.m_enabled);
   ImGui::End();
 }
 
@@ -145,6 +163,7 @@ void test_suit::render_scene() {
   test_scene_base *scene = get_scene(m_current_scene);
   if (scene) {
     try {
+      scene->begin_frame();
       scene->render();
     } catch (const std::exception &e) {
       std::cerr << "Error in scene render: " << e.what() << std::endl;
@@ -189,6 +208,47 @@ void test_suit::on_object_hovered(int _object_id) {
   }
 }
 
+bool test_suit::pick_object(float _clip_x, float _clip_y, int &_object_id) {
+  test_scene_base *scene = get_scene(m_current_scene);
+  if (scene) {
+    return scene->pick_object(_clip_x, _clip_y, _object_id);
+  }
+  return false;
+}
+
+void test_suit::request_object_hover(int _x, int _y) {
+  m_hover_pending = true;
+  m_hover_x = _x;
+  m_hover_y = _y;
+}
+
+void test_suit::process_object_readbacks() {
+  if (!m_scene_framebuffer) {
+    return;
+  }
+  object_id_readback readback;
+  while (m_scene_framebuffer->poll_object_ids(readback)) {
+    // Older hovers were overtaken by the latest request
+    if (readback.serial == m_hover_serial && !readback.ids.empty()) {
+      on_object_hovered(readback.ids[0]);
+    }
+  }
+  if (m_hover_pending) {
+    const unsigned long long serial =
+        m_scene_framebuffer->request_object_ids(m_hover_x, m_hover_y);
+    if (serial != 0) {
+      m_hover_serial = serial;
+      m_hover_pending = false;
+    } else if (m_hover_x < 0 || m_hover_y < 0 ||
+               m_hover_x >= m_scene_framebuffer->get_width() ||
+               m_hover_y >= m_scene_framebuffer->get_height()) {
+      // Outside the framebuffer, as read_object_id reports it
+      m_hover_pending = false;
+      on_object_hovered(-1);
+    }
+  }
+}
+
 bool test_suit::on_mouse_scroll(double _xoffset, double _yoffset) {
   test_scene_base *scene = get_scene(m_current_scene);
   if (scene) {
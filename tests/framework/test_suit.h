@@ -69,6 +69,16 @@ public:
   bool on_mouse_button(int _button, int _action, int _mods);
   void on_framebuffer_resized(int _width, int _height);
   void on_object_hovered(int _object_id);
+  bool pick_object(float _clip_x, float _clip_y, int &_object_id);
+
+  // Hover the object at framebuffer pixel (x, y) once its ID has been read
+  // back, see process_object_readbacks
+  void request_object_hover(int _x, int _y);
+
+  // Deliver finished object ID readbacks to the scene and start the latest
+  // requested one. Call after rendering the scene into m_scene_framebuffer;
+  // the ID arrives one or two frames later without a pipeline stall.
+  void process_object_readbacks();
 
 public:
   // Cached viewport window information
@@ -80,6 +90,12 @@ public:
   bool m_viewport_hovered = false;
 
 private:
+  // Hover waiting to be read back, and the request reading it
+  bool m_hover_pending = false;
+  int m_hover_x = 0;
+  int m_hover_y = 0;
+  unsigned long long m_hover_serial = 0;
+
   // Current active test scene
   test_scene m_current_scene;
 
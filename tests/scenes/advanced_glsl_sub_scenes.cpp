@@ -1,6 +1,7 @@
 #include "advanced_glsl_sub_scenes.h"
 #include "advanced_glsl_scene.h"
 
+#include "basic/render_state.h"
 #include "glad/gl.h"
 #include "imgui.h"
 #include "tests/component/mesh_manager.h"
@@ -35,7 +36,7 @@ void advanced_glsl_vertex_variable_sub_scene::render() {
   }
 
   // Draw normal object and write to stencil buffer
-  glEnable(GL_PROGRAM_POINT_SIZE);
+  render_state::instance().enable(GL_PROGRAM_POINT_SIZE);
   p->m_shader->use();
   p->set_matrices(p->m_shader);
   p->m_shader->set_uniform("uSubSenceIndex", 0);
@@ -43,7 +44,7 @@ void advanced_glsl_vertex_variable_sub_scene::render() {
   p->m_shader->set_uniform("uIncrementPointSize", (int)m_increment_point_size);
   m_point_mesh.bind();
   glDrawArrays(GL_POINTS, 0, m_point_mesh.get_index_count());
-  glDisable(GL_PROGRAM_POINT_SIZE);
+  render_state::instance().disable(GL_PROGRAM_POINT_SIZE);
 }
 
 void advanced_glsl_vertex_variable_sub_scene::render_ui() {
@@ -93,17 +94,7 @@ void advanced_glsl_fragment_variable_sub_scene::render_ui() {
 
 advanced_glsl_uniform_buffer_sub_scene::advanced_glsl_uniform_buffer_sub_scene(
     advanced_glsl_scene *parent)
-    : sub_scene(parent, "Uniform Buffer") {
-
-  glGenBuffers(1, &m_ubo_handle);
-  glBindBuffer(GL_UNIFORM_BUFFER, m_ubo_handle);
-  glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), nullptr,
-               GL_STATIC_DRAW);
-  glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
-  glBindBufferRange(GL_UNIFORM_BUFFER, 0, m_ubo_handle, 0,
-                    2 * sizeof(glm::mat4));
-}
+    : sub_scene(parent, "Uniform Buffer") {}
 
 void advanced_glsl_uniform_buffer_sub_scene::render() {
   auto *p = parent();
@@ -111,13 +102,8 @@ void advanced_glsl_uniform_buffer_sub_scene::render() {
     return;
   }
 
-  glBindBuffer(GL_UNIFORM_BUFFER, m_ubo_handle);
-  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4),
-                  &p->m_camera.ViewMatrix);
-  glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4),
-                  &p->m_camera.ProjectionMatrix);
-  glBindBuffer(GL_UNIFORM_BUFFER, 0);
-
+  // View and projection come from the scene's camera block, which the
+  // shader's CameraBlock is bound to when it is created
   for (const auto &object : m_objects) {
     object->Shader->use();
     object->Shader->set_uniform("uSubSenceIndex", 2);
@@ -136,12 +122,6 @@ void advanced_glsl_uniform_buffer_sub_scene::render_ui() {
     m_objects.back()->Shader = new shader(
         "shaders/advanced_glsl_test/vertex_with_uniform_buffer.shader",
         "shaders/advanced_glsl_test/fragment.shader");
-    unsigned int uniform_blk_index = glGetUniformBlockIndex(
-        m_objects.back()->Shader->ID(), "uCameraMatrics");
-    if (uniform_blk_index != GL_INVALID_INDEX) {
-      glUniformBlockBinding(m_objects.back()->Shader->ID(), uniform_blk_index,
-                            0);
-    }
     m_objects.back()->Position =
         glm::vec3(rand() % 10 - 5, rand() % 10 - 5, rand() % 10 - 5);
     m_objects.back()->ObjectColor = glm::vec3(
@@ -58,5 +58,4 @@ private:
   };
 
   std::vector<std::unique_ptr<object_info>> m_objects;
-  unsigned int m_ubo_handle = -1;
 };
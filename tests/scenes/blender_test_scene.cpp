@@ -38,32 +38,25 @@ void blender_test_scene::render() {
     return;
   }
 
-  if (m_enable_blend) {
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  }
-
-  // Set matrices and render object
-  // To make blend works, you should draw the far objects at first, then draw
-  // the near ojects.
-
-  // 1. Draw all the non-transparent objects.
-  // 2. Sort the transparent object from far to near.
-  // 3. Draw them with sorted order.
-  set_matrices(m_shader,
-               glm::translate(glm::mat4(1.0f), m_back_object_position));
-  m_shader->set_uniform("uTransparency", m_transparency);
-  m_shader->set_uniform("uObjectColor", m_back_object_color);
-  m_mesh.draw();
-
-  set_matrices(m_shader,
-               glm::translate(glm::mat4(1.0f), m_front_object_position));
-  m_shader->set_uniform("uTransparency", m_transparency);
-  m_shader->set_uniform("uObjectColor", m_front_object_color);
-  m_mesh.draw();
+  // To make blending work, far objects have to be drawn before near ones.
+  // The queue draws the non-transparent objects first, then sorts the
+  // transparent ones from far to near, so submission order does not matter.
+  m_render_queue.begin(m_camera);
+  submit_object(m_front_object_position, m_front_object_color);
+  submit_object(m_back_object_position, m_back_object_color);
+  m_render_queue.execute();
+}
 
-  if (!m_enable_blend)
-    glDisable(GL_BLEND);
+void blender_test_scene::submit_object(const glm::vec3 &_position,
+                                       const glm::vec3 &_color) {
+  draw_packet packet;
+  packet.program = m_shader;
+  packet.mesh = &m_mesh;
+  packet.model = glm::translate(glm::mat4(1.0f), _position);
+  packet.transparent = m_enable_blend;
+  m_render_queue.submit(packet);
+  m_render_queue.add_uniform("uTransparency", m_transparency);
+  m_render_queue.add_uniform("uObjectColor", _color);
 }
 
 void blender_test_scene::render_ui() {
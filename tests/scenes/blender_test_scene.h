@@ -1,6 +1,7 @@
 #pragma once
 
 #include "renderable_scene_base.h"
+#include "tests/component/render_queue.h"
 
 class blender_test_scene : public renderable_scene_base {
 public:
@@ -12,6 +13,11 @@ public:
   void render_ui() override;
 
 protected:
+  // Queue a quad at _position; blended if m_enable_blend is set
+  void submit_object(const glm::vec3 &_position, const glm::vec3 &_color);
+
+  render_queue m_render_queue;
+
   glm::vec3 m_front_object_position = {0.0f, 0.0f, 0.0f};
   glm::vec3 m_front_object_color = {1.0f, 0.0f, 0.0f};
   glm::vec3 m_back_object_position = {0.0f, 0.0f, -1.0f};
@@ -17,6 +17,8 @@ camera_scene_base::~camera_scene_base() {
 void camera_scene_base::init(GLFWwindow *_window) {
   test_scene_base::init(_window);
   m_camera_controller = new camera_controller(m_camera, _window);
+  m_camera_block = std::make_unique<uniform_buffer<camera_block>>(
+      uniform_block_binding::k_camera);
 }
 
 void camera_scene_base::update(float _delta_time) {
@@ -25,6 +27,17 @@ void camera_scene_base::update(float _delta_time) {
   }
 }
 
+void camera_scene_base::begin_frame() {
+  if (!m_camera_block) {
+    return;
+  }
+  camera_block block;
+  write_block(m_camera, block);
+  m_camera_block->set(0, block);
+  m_camera_block->upload();
+  m_camera_block->bind();
+}
+
 bool camera_scene_base::on_mouse_moved(double _xpos, double _ypos) {
   if (m_camera_controller_enabled && m_camera_controller) {
     m_camera_controller->on_mouse_moved(_xpos, _ypos);
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "basic/camera.h"
+#include "basic/uniform_buffer.h"
 #include "scene_base.h"
 #include "tests/component/camera_controller.h"
+#include <memory>
 
 // Base class for scenes that need camera functionality
 class camera_scene_base : public test_scene_base {
@@ -16,6 +18,9 @@ public:
   // Update camera controller
   void update(float _delta_time) override;
 
+  // Upload m_camera to the camera uniform block and bind it
+  void begin_frame() override;
+
   // Event handlers for camera control
   bool on_mouse_moved(double _xpos, double _ypos) override;
   bool on_mouse_scroll(double _xoffset, double _yoffset) override;
@@ -29,5 +34,7 @@ protected:
   camera m_camera;
   camera_controller *m_camera_controller = nullptr;
   bool m_camera_controller_enabled = false;
+  // CameraBlock of every shader drawn by the scene, created by init()
+  std::unique_ptr<uniform_buffer<camera_block>> m_camera_block;
 };
 
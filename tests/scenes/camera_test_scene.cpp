@@ -31,8 +31,6 @@ void camera_test_scene::render() {
   m_shader->use();
   glm::mat4 model = glm::mat4(1.0f);
   m_shader->set_uniform("model", model);
-  m_shader->set_uniform("view", m_camera.ViewMatrix);
-  m_shader->set_uniform("projection", m_camera.ProjectionMatrix);
 
   m_mesh.draw();
 }
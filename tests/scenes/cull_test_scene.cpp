@@ -1,5 +1,6 @@
 #include "cull_test_scene.h"
 
+#include "basic/render_state.h"
 #include "glad/gl.h"
 #include "glm/ext/matrix_transform.hpp"
 #include "glm/fwd.hpp"
@@ -41,7 +42,7 @@ void cull_test_scene::render() {
   }
 
   if (m_enable_culling) {
-    glEnable(GL_CULL_FACE);
+    render_state::instance().enable(GL_CULL_FACE);
     if (m_cull_back_faces)
       glCullFace(GL_BACK);
     else
@@ -59,7 +60,7 @@ void cull_test_scene::render() {
   glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
   if (!m_enable_culling)
-    glDisable(GL_CULL_FACE);
+    render_state::instance().disable(GL_CULL_FACE);
 }
 
 void cull_test_scene::render_ui() {
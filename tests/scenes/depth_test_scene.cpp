@@ -1,5 +1,6 @@
 #include "depth_test_scene.h"
 
+#include "basic/render_state.h"
 #include "glad/gl.h"
 #include "imgui.h"
 #include "tests/component/mesh_manager.h"
@@ -47,7 +48,7 @@ void depth_test_scene::render() {
     return;
   }
 
-  glDepthFunc(depth_test_modes[m_depth_test_index]);
+  render_state::instance().depth_func(depth_test_modes[m_depth_test_index]);
   // Set matrices and render object
   m_shader->use();
   m_shader->set_uniform("uLightColor", m_light_color);
@@ -55,7 +56,6 @@ void depth_test_scene::render() {
   m_shader->set_uniform("uAmbientStrength", m_ambient_strength);
   m_shader->set_uniform("uLightPosition", m_light_position);
   m_shader->set_uniform("uSpecularStrength", m_specular_strength);
-  m_shader->set_uniform("uEyePosition", m_camera.Position);
   m_shader->set_uniform("uShininess", m_shininess);
   m_shader->set_uniform("uDepthVisualization", m_depth_visualization);
   m_shader->set_uniform("uNear", m_camera.Near);
@@ -69,7 +69,7 @@ void depth_test_scene::render() {
     set_matrices(m_shader, glm::translate(glm::mat4(1.0f), m_object_position2));
     m_mesh.draw();
   }
-  glDepthFunc(GL_LESS);
+  render_state::instance().depth_func(GL_LESS);
 
   // Render light source using helper
   render_light_source(m_light_shader, m_light_position);
@@ -1,42 +1,111 @@
 #include "import_mesh.h"
 #include "glad/gl.h"
+#include "tests/component/vertex_quantization.h"
+#include <algorithm>
+#include <utility>
+
+std::vector<import_packed_vertex>
+pack_import_vertices(const std::vector<import_vertex> &_vertices,
+                     const import_quantization &_quantization) {
+  std::vector<import_packed_vertex> packed(_vertices.size());
+  for (size_t i = 0; i < _vertices.size(); i++) {
+    const import_vertex &vertex = _vertices[i];
+    import_packed_vertex &out = packed[i];
+    for (int axis = 0; axis < 3; axis++) {
+      out.position[axis] = quantize_unorm16(
+          (vertex.position[axis] - _quantization.offset[axis]) /
+          _quantization.scale[axis]);
+    }
+    out.position[3] = 0;
+    encode_octahedral_unorm16(vertex.normal, out.normal);
+    out.texture_coords[0] = float_to_half(vertex.texture_coords.x);
+    out.texture_coords[1] = float_to_half(vertex.texture_coords.y);
+  }
+  return packed;
+}
+
+import_mesh::import_mesh(std::vector<import_vertex> _vertices,
+                         std::vector<unsigned int> _indices,
+                         std::vector<import_texture> _textures,
+                         std::vector<import_lod> _lods,
+                         import_vertex_format _format,
+                         const import_quantization &_quantization)
+    : vertices(std::move(_vertices)), indices(std::move(_indices)),
+      textures(std::move(_textures)), lods(std::move(_lods)),
+      m_format(_format) {
+  if (lods.empty()) {
+    lods.push_back(import_lod{0, indices.size(), 0.0f});
+  }
+
+  // Computed from the float vertices, which packed meshes keep as well
+  m_bounds = bounding_volume::from_positions(
+      vertices.data(), sizeof(import_vertex), vertices.size());
+
+  setup_shared_mesh(m_mesh_manager, vertices, indices, m_format,
+                    _quantization);
+}
+
+void import_mesh::setup_shared_mesh(
+    mesh_manager &_mesh_manager, const std::vector<import_vertex> &_vertices,
+    const std::vector<unsigned int> &_indices, import_vertex_format _format,
+    const import_quantization &_quantization) {
+  if (_format == import_vertex_format::k_packed) {
+    const std::vector<import_packed_vertex> packed =
+        pack_import_vertices(_vertices, _quantization);
+    mesh_data data = {packed.data(),
+                      sizeof(import_packed_vertex) * packed.size(),
+                      _indices.data(),
+                      _indices.size(),
+                      {{4, GL_UNSIGNED_SHORT, true},
+                       {2, GL_UNSIGNED_SHORT, true},
+                       {2, GL_HALF_FLOAT, false}}};
+    _mesh_manager.setup_shared_mesh(data);
+    return;
+  }
 
-import_mesh::import_mesh(const std::vector<import_vertex> &_vertices,
-                         const std::vector<unsigned int> &_indices,
-                         const std::vector<import_texture> &_textures)
-    : vertices(_vertices), indices(_indices), textures(_textures) {
   // Setup mesh data for OpenGL
   mesh_data data = {
-      vertices.data(),
-      sizeof(vertices[0]) * vertices.size(),
-      indices.data(),
-      indices.size(),
+      _vertices.data(),
+      sizeof(import_vertex) * _vertices.size(),
+      _indices.data(),
+      _indices.size(),
       {{3, GL_FLOAT, false}, {3, GL_FLOAT, false}, {2, GL_FLOAT, false}}};
-  m_mesh_manager.setup_mesh(data);
+  _mesh_manager.setup_shared_mesh(data);
 }
 
 import_mesh::import_mesh(import_mesh &&other) noexcept
     : vertices(std::move(other.vertices)), indices(std::move(other.indices)),
-      textures(std::move(other.textures)),
-      m_mesh_manager(std::move(other.m_mesh_manager)) {}
+      textures(std::move(other.textures)), lods(std::move(other.lods)),
+      m_mesh_manager(std::move(other.m_mesh_manager)),
+      m_format(other.m_format), m_bounds(other.m_bounds) {}
 
 import_mesh &import_mesh::operator=(import_mesh &&other) noexcept {
   if (this != &other) {
     vertices = std::move(other.vertices);
     indices = std::move(other.indices);
     textures = std::move(other.textures);
+    lods = std::move(other.lods);
     m_mesh_manager = std::move(other.m_mesh_manager);
+    m_format = other.m_format;
+    m_bounds = other.m_bounds;
   }
   return *this;
 }
 
-void import_mesh::draw(shader *_shader) {
-  if (!_shader) {
+void import_mesh::draw(shader *_shader, size_t _level) {
+  if (!_shader || lods.empty()) {
     return;
   }
 
   _shader->use();
+  bind_textures(_shader);
+
+  // Draw the mesh
+  const import_lod &lod = lods[std::min(_level, lods.size() - 1)];
+  m_mesh_manager.draw_range(lod.first_index, lod.index_count);
+}
 
+void import_mesh::bind_textures(shader *_shader) const {
   // Bind all textures
   for (unsigned int i = 0; i < textures.size(); i++) {
     if (textures[i].texture) {
@@ -50,7 +119,4 @@ void import_mesh::draw(shader *_shader) {
   if (textures.empty()) {
     _shader->set_uniform("uTextureDiffuse0", 0);
   }
-
-  // Draw the mesh
-  m_mesh_manager.draw();
 }
@@ -3,6 +3,7 @@
 #include "basic/shader.h"
 #include "basic/texture.h"
 #include "tests/component/mesh_manager.h"
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <memory>
 #include <string>
@@ -15,18 +16,60 @@ struct import_vertex {
   glm::vec2 texture_coords;
 };
 
+// Layout of the vertices an import_mesh uploads
+enum class import_vertex_format : int {
+  k_float = 0, // import_vertex, 32 bytes
+  k_packed = 1 // import_packed_vertex, 16 bytes
+};
+
+// Maps the unorm16 positions of packed vertices back to model space:
+// position = offset + stored * scale
+struct import_quantization {
+  glm::vec3 offset = glm::vec3(0.0f);
+  glm::vec3 scale = glm::vec3(1.0f);
+};
+
+// 16-byte vertex, see vertex_quantization.h. Read by
+// shaders/import_model_test/vertex_packed.shader.
+struct import_packed_vertex {
+  std::uint16_t position[4];       // unorm16 within import_quantization
+  std::uint16_t normal[2];         // unorm16 octahedral
+  std::uint16_t texture_coords[2]; // half float
+};
+static_assert(sizeof(import_packed_vertex) == 16);
+
+// Pack _vertices for upload with the given quantization
+std::vector<import_packed_vertex>
+pack_import_vertices(const std::vector<import_vertex> &_vertices,
+                     const import_quantization &_quantization);
+
 // Texture structure for imported models
 struct import_texture {
   std::shared_ptr<texture_2d> texture;
   std::string type; // e.g., "uTextureDiffuse", "uTextureSpecular"
 };
 
+// One level of detail of an import_mesh: a range of import_mesh::indices
+// over the shared vertices
+struct import_lod {
+  size_t first_index = 0;
+  size_t index_count = 0;
+  float error = 0.0f; // Largest deviation from the full mesh, in model units
+};
+
 // Mesh class representing a single mesh in an imported model
 class import_mesh {
 public:
-  import_mesh(const std::vector<import_vertex> &_vertices,
-              const std::vector<unsigned int> &_indices,
-              const std::vector<import_texture> &_textures);
+  // _lods are ranges of _indices, finest first; without any, all of
+  // _indices form the only level. With k_packed, the GPU copy of the
+  // vertices is packed using _quantization, while vertices keeps floats.
+  // The arrays are taken by value; move them in to avoid a copy.
+  import_mesh(std::vector<import_vertex> _vertices,
+              std::vector<unsigned int> _indices,
+              std::vector<import_texture> _textures,
+              std::vector<import_lod> _lods = {},
+              import_vertex_format _format = import_vertex_format::k_float,
+              const import_quantization &_quantization = {});
 
   // Disable copy constructor and copy assignment (OpenGL resources)
   import_mesh(const import_mesh &) = delete;
@@ -36,14 +79,34 @@ public:
   import_mesh(import_mesh &&other) noexcept;
   import_mesh &operator=(import_mesh &&other) noexcept;
 
-  // Draw the mesh with the given shader
-  void draw(shader *_shader);
+  // Draw one level of detail of the mesh with the given shader
+  void draw(shader *_shader, size_t _level = 0);
+
+  // Bind the mesh's textures and point the shader's samplers at them
+  void bind_textures(shader *_shader) const;
+
+  const mesh_manager &get_mesh_manager() const { return m_mesh_manager; }
+
+  import_vertex_format get_vertex_format() const { return m_format; }
+
+  // Upload vertices and indices in _format into _mesh_manager's shared arena
+  static void setup_shared_mesh(mesh_manager &_mesh_manager,
+                                const std::vector<import_vertex> &_vertices,
+                                const std::vector<unsigned int> &_indices,
+                                import_vertex_format _format,
+                                const import_quantization &_quantization);
+
+  // Bounds of the vertices, in model space
+  const bounding_volume &get_bounds() const { return m_bounds; }
 
   // Public data members
   std::vector<import_vertex> vertices;
-  std::vector<unsigned int> indices;
+  std::vector<unsigned int> indices; // All levels of detail
   std::vector<import_texture> textures;
+  std::vector<import_lod> lods; // At least one
 
 private:
   mesh_manager m_mesh_manager;
+  import_vertex_format m_format = import_vertex_format::k_float;
+  bounding_volume m_bounds;
 };
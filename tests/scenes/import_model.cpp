@@ -1,14 +1,31 @@
 #include "import_model.h"
 #include "basic/shader.h"
 #include "basic/texture.h"
+#include "tests/component/frustum.h"
+#include "tests/component/mesh_optimizer.h"
+#include "tests/component/mesh_simplifier.h"
+#include "tests/scenes/import_model_loader.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <utility>
 
-import_model::import_model(const std::string &_path) { load_model(_path); }
+import_model::import_model(const std::string &_path,
+                           const import_options &_options) {
+  import_model_loader loader(_path, _options);
+  loader.wait();
+  loader.upload(*this, static_cast<size_t>(-1));
+  if (loader.get_stage() == import_model_loader::stage::k_failed) {
+    throw std::runtime_error(loader.error());
+  }
+}
 
-void import_model::load_model(const std::string &_path) {
+import_model_source import_model::parse(const std::string &_path,
+                                        thread_pool *_pool) {
   Assimp::Importer importer;
-  const aiScene *scene =
-      importer.ReadFile(_path, aiProcess_Triangulate | aiProcess_FlipUVs);
+  const aiScene *scene = importer.ReadFile(_path, k_import_flags);
 
   if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
       !scene->mRootNode) {
@@ -16,11 +33,169 @@ void import_model::load_model(const std::string &_path) {
                              std::string(importer.GetErrorString()));
   }
 
+  import_model_source source;
   // Extract directory for texture loading
-  m_directory = extract_directory(_path);
+  source.directory = extract_directory(_path);
+
+  // Walk the node tree first; the meshes it references are independent of
+  // each other and can be converted in parallel
+  std::vector<unsigned int> mesh_indices;
+  collect_meshes(scene->mRootNode, scene, 0, mesh_indices);
+  source.meshes.resize(mesh_indices.size());
+  auto build_mesh = [&](size_t _i) {
+    source.meshes[_i] = process_mesh(scene->mMeshes[mesh_indices[_i]], scene,
+                                     source.directory);
+  };
+  if (_pool) {
+    _pool->parallel_for(mesh_indices.size(), build_mesh);
+  } else {
+    for (size_t i = 0; i < mesh_indices.size(); i++) {
+      build_mesh(i);
+    }
+  }
+  return source;
+}
+
+void import_model::optimize(import_model_source &_source, thread_pool *_pool) {
+  std::vector<vertex_cache_stats> before(_source.meshes.size());
+  std::vector<vertex_cache_stats> after(_source.meshes.size());
+  auto optimize_mesh = [&](size_t _i) {
+    import_mesh_source &mesh = _source.meshes[_i];
+    before[_i] = analyze_vertex_cache(mesh.indices, mesh.vertices.size());
+    if (mesh.triangle_list && !mesh.indices.empty()) {
+      const std::vector<size_t> clusters =
+          optimize_vertex_cache(mesh.indices, mesh.vertices.size());
+      optimize_overdraw(mesh.indices, clusters, &mesh.vertices[0].position.x,
+                        sizeof(import_vertex), mesh.vertices.size());
+      optimize_vertex_fetch(mesh.indices, mesh.vertices);
+    }
+    after[_i] = analyze_vertex_cache(mesh.indices, mesh.vertices.size());
+  };
+  if (_pool) {
+    _pool->parallel_for(_source.meshes.size(), optimize_mesh);
+  } else {
+    for (size_t i = 0; i < _source.meshes.size(); i++) {
+      optimize_mesh(i);
+    }
+  }
+
+  // Weight by triangle count so large meshes dominate, as they do on the GPU
+  double triangles = 0.0, misses_before = 0.0, misses_after = 0.0;
+  for (size_t i = 0; i < _source.meshes.size(); i++) {
+    const double count =
+        static_cast<double>(_source.meshes[i].indices.size() / 3);
+    triangles += count;
+    misses_before += before[i].acmr * count;
+    misses_after += after[i].acmr * count;
+  }
+  _source.optimized = true;
+  _source.acmr_before =
+      triangles > 0.0 ? static_cast<float>(misses_before / triangles) : 0.0f;
+  _source.acmr_after =
+      triangles > 0.0 ? static_cast<float>(misses_after / triangles) : 0.0f;
+}
+
+void import_model::build_lods(import_model_source &_source,
+                              const import_options &_options,
+                              thread_pool *_pool) {
+  if (_options.lod_levels <= 0) {
+    return;
+  }
+  auto build_mesh_lods = [&](size_t _i) {
+    import_mesh_source &mesh = _source.meshes[_i];
+    if (!mesh.triangle_list || mesh.indices.empty() || !mesh.lods.empty()) {
+      return;
+    }
+    const size_t base_count = mesh.indices.size();
+    mesh.lods.push_back(import_lod{0, base_count, 0.0f});
 
-  // Process the root node and all its children
-  process_node(scene->mRootNode, scene);
+    // The error limit scales with the mesh so small parts keep their shape
+    glm::vec3 lower = mesh.vertices[0].position;
+    glm::vec3 upper = mesh.vertices[0].position;
+    for (const auto &vertex : mesh.vertices) {
+      lower = glm::min(lower, vertex.position);
+      upper = glm::max(upper, vertex.position);
+    }
+    const float max_error =
+        _options.lod_max_error * glm::length(upper - lower) * 0.5f;
+
+    // Every level is simplified from the full mesh, so its error is measured
+    // against the original surface
+    const std::vector<unsigned int> base(mesh.indices.begin(),
+                                         mesh.indices.end());
+    size_t target = base_count;
+    for (int level = 1; level <= _options.lod_levels; level++) {
+      target = static_cast<size_t>(static_cast<float>(target) *
+                                   _options.lod_reduction) /
+               3 * 3;
+      float error = 0.0f;
+      std::vector<unsigned int> indices =
+          simplify_mesh(base, &mesh.vertices[0].position.x,
+                        sizeof(import_vertex), mesh.vertices.size(), target,
+                        max_error, &error);
+      // Not worth a level of its own
+      if (indices.empty() ||
+          indices.size() * 10 > mesh.lods.back().index_count * 9) {
+        break;
+      }
+      if (_options.optimize) {
+        optimize_vertex_cache(indices, mesh.vertices.size());
+      }
+      mesh.lods.push_back(
+          import_lod{mesh.indices.size(), indices.size(), error});
+      mesh.indices.insert(mesh.indices.end(), indices.begin(), indices.end());
+      target = indices.size();
+    }
+  };
+  if (_pool) {
+    _pool->parallel_for(_source.meshes.size(), build_mesh_lods);
+  } else {
+    for (size_t i = 0; i < _source.meshes.size(); i++) {
+      build_mesh_lods(i);
+    }
+  }
+}
+
+import_quantization
+import_model::compute_quantization(const import_model_source &_source) {
+  bool empty = true;
+  glm::vec3 lower(0.0f), upper(0.0f);
+  for (const auto &mesh : _source.meshes) {
+    for (const auto &vertex : mesh.vertices) {
+      lower = empty ? vertex.position : glm::min(lower, vertex.position);
+      upper = empty ? vertex.position : glm::max(upper, vertex.position);
+      empty = false;
+    }
+  }
+  import_quantization quantization;
+  quantization.offset = lower;
+  for (int axis = 0; axis < 3; axis++) {
+    // Flat models keep a usable scale on their flat axis
+    quantization.scale[axis] =
+        upper[axis] > lower[axis] ? upper[axis] - lower[axis] : 1.0f;
+  }
+  return quantization;
+}
+
+void import_model::set_vertex_format(import_vertex_format _format,
+                                     const import_quantization &_quantization) {
+  m_vertex_format = _format;
+  m_quantization = _quantization;
+  m_batches_dirty = true;
+}
+
+void import_model::add_mesh(import_mesh &&_mesh) {
+  const bounding_volume &bounds = _mesh.get_bounds();
+  m_sphere_x.push_back(bounds.center.x);
+  m_sphere_y.push_back(bounds.center.y);
+  m_sphere_z.push_back(bounds.center.z);
+  // A mesh without bounds must never be culled
+  m_sphere_radius.push_back(bounds.valid
+                                ? bounds.radius
+                                : std::numeric_limits<float>::infinity());
+  m_meshes.push_back(std::move(_mesh));
+  m_batches_dirty = true;
+  m_mesh_bvh_dirty = true;
 }
 
 std::string import_model::extract_directory(const std::string &_path) {
@@ -40,15 +215,12 @@ std::string import_model::extract_directory(const std::string &_path) {
   return ".";
 }
 
-void import_model::process_node(aiNode *_node, const aiScene *_scene) {
-  process_node_impl(_node, _scene, 0);
-}
-
-void import_model::process_node_impl(aiNode *_node, const aiScene *_scene,
-                                     int _depth) {
+void import_model::collect_meshes(aiNode *_node, const aiScene *_scene,
+                                  int _depth,
+                                  std::vector<unsigned int> &_mesh_indices) {
   // Safety check to prevent infinite recursion
   if (_depth > MAX_RECURSION_DEPTH) {
-    std::cerr << "Warning: Maximum recursion depth reached in process_node"
+    std::cerr << "Warning: Maximum recursion depth reached in collect_meshes"
               << std::endl;
     return;
   }
@@ -57,27 +229,30 @@ void import_model::process_node_impl(aiNode *_node, const aiScene *_scene,
     return;
   }
 
-  // Process all meshes of this node
+  // Collect all meshes of this node
   for (unsigned int i = 0; i < _node->mNumMeshes; i++) {
     unsigned int mesh_index = _node->mMeshes[i];
     if (mesh_index < _scene->mNumMeshes) {
-      aiMesh *mesh = _scene->mMeshes[mesh_index];
-      m_meshes.push_back(std::move(process_mesh(mesh, _scene)));
+      _mesh_indices.push_back(mesh_index);
     }
   }
 
   // Process all children recursively
   for (unsigned int i = 0; i < _node->mNumChildren; i++) {
     if (_node->mChildren[i]) {
-      process_node_impl(_node->mChildren[i], _scene, _depth + 1);
+      collect_meshes(_node->mChildren[i], _scene, _depth + 1, _mesh_indices);
     }
   }
 }
 
-import_mesh import_model::process_mesh(aiMesh *_mesh, const aiScene *_scene) {
-  std::vector<import_vertex> vertices;
-  std::vector<unsigned int> indices;
-  std::vector<import_texture> textures;
+import_mesh_source import_model::process_mesh(aiMesh *_mesh,
+                                              const aiScene *_scene,
+                                              const std::string &_directory) {
+  import_mesh_source source;
+  std::vector<import_vertex> &vertices = source.vertices;
+  std::vector<unsigned int> &indices = source.indices;
+  vertices.reserve(_mesh->mNumVertices);
+  indices.reserve(static_cast<size_t>(_mesh->mNumFaces) * 3);
 
   // Process vertices
   for (unsigned int i = 0; i < _mesh->mNumVertices; i++) {
@@ -109,24 +284,32 @@ import_mesh import_model::process_mesh(aiMesh *_mesh, const aiScene *_scene) {
   // Process indices
   for (unsigned int i = 0; i < _mesh->mNumFaces; i++) {
     aiFace face = _mesh->mFaces[i];
+    if (face.mNumIndices != 3) {
+      source.triangle_list = false; // Points or lines left by Triangulate
+    }
     for (unsigned int j = 0; j < face.mNumIndices; j++) {
       indices.push_back(face.mIndices[j]);
     }
   }
+  // Formats like OBJ arrive with a vertex per face corner; share the
+  // identical ones so the optimizer and simplifier see connected triangles
+  weld_vertices(indices, vertices);
 
   // Process material and textures
   if (_mesh->mMaterialIndex >= 0) {
     aiMaterial *material = _scene->mMaterials[_mesh->mMaterialIndex];
-    load_material_textures(material, aiTextureType_DIFFUSE, textures);
-    load_material_textures(material, aiTextureType_SPECULAR, textures);
+    load_material_textures(material, aiTextureType_DIFFUSE, _directory,
+                           source.textures);
+    load_material_textures(material, aiTextureType_SPECULAR, _directory,
+                           source.textures);
   }
 
-  return import_mesh(vertices, indices, textures);
+  return source;
 }
 
 void import_model::load_material_textures(
-    aiMaterial *_material, aiTextureType _type,
-    std::vector<import_texture> &_textures) {
+    aiMaterial *_material, aiTextureType _type, const std::string &_directory,
+    std::vector<import_texture_source> &_textures) {
   unsigned int texture_count = _material->GetTextureCount(_type);
 
   for (unsigned int i = 0; i < texture_count; i++) {
@@ -135,33 +318,291 @@ void import_model::load_material_textures(
       continue;
     }
 
-    // Construct full texture path
-    std::string texture_path = m_directory + "/" + std::string(str.C_Str());
-
     // Determine texture type name for shader
     std::string type_name = (_type == aiTextureType_DIFFUSE)
                                 ? "uTextureDiffuse"
                                 : "uTextureSpecular";
 
-    // Try to load texture
-    try {
-      _textures.push_back(import_texture{
-          std::make_shared<texture_2d>(texture_path.c_str()), type_name});
-    } catch (const std::exception &e) {
-      std::cerr << "Warning: Failed to load texture: " << texture_path << " - "
-                << e.what() << std::endl;
-      // Continue loading other textures instead of crashing
+    // Construct full texture path; the image is decoded later
+    _textures.push_back(import_texture_source{
+        _directory + "/" + std::string(str.C_Str()), type_name});
+  }
+}
+
+void import_model::build_batches(import_draw_mode _mode) {
+  m_batches.clear();
+  m_unbatched.clear();
+  auto &arena = buffer_arena::instance();
+
+  // Bucket by arena page and texture set; the map keeps buckets sorted so
+  // consecutive draws share as much state as possible.
+  using texture_key = std::vector<std::pair<const texture_2d *, std::string>>;
+  std::map<std::pair<int, texture_key>, std::vector<size_t>> buckets;
+  for (size_t i = 0; i < m_meshes.size(); i++) {
+    const auto handle = m_meshes[i].get_mesh_manager().get_arena_handle();
+    if (handle == buffer_arena::k_invalid_handle ||
+        arena.get_range(handle).index_count == 0) {
+      m_unbatched.push_back(i);
+      continue;
+    }
+    texture_key key;
+    for (const auto &texture : m_meshes[i].textures)
+      key.emplace_back(texture.texture.get(), texture.type);
+    buckets[{arena.get_range(handle).page, std::move(key)}].push_back(i);
+  }
+
+  for (auto &bucket : buckets) {
+    draw_batch batch;
+    batch.page = bucket.first.first;
+    batch.material_mesh = bucket.second.front();
+    batch.meshes = std::move(bucket.second);
+
+    if (_mode == import_draw_mode::k_merged) {
+      // Concatenate the bucket into one mesh; indices are rebased onto the
+      // merged vertex array. This keeps a second copy of the geometry in the
+      // arena for as long as the merged mode is in use.
+      std::vector<import_vertex> vertices;
+      std::vector<unsigned int> indices;
+      for (size_t mesh_index : batch.meshes) {
+        const auto &mesh = m_meshes[mesh_index];
+        const auto base = static_cast<unsigned int>(vertices.size());
+        vertices.insert(vertices.end(), mesh.vertices.begin(),
+                        mesh.vertices.end());
+        const import_lod &lod = mesh.lods.front();
+        for (size_t i = 0; i < lod.index_count; i++)
+          indices.push_back(base + mesh.indices[lod.first_index + i]);
+      }
+      import_mesh::setup_shared_mesh(batch.merged, vertices, indices,
+                                     m_vertex_format, m_quantization);
+    } else {
+      for (size_t mesh_index : batch.meshes) {
+        const auto &range = arena.get_range(
+            m_meshes[mesh_index].get_mesh_manager().get_arena_handle());
+        batch.first_indices.push_back(range.first_index);
+        batch.first_vertices.push_back(range.first_vertex);
+      }
     }
+    m_batches.push_back(std::move(batch));
   }
+
+  m_batch_mode = _mode;
+  m_batches_dirty = false;
+  m_batch_generation = arena.generation();
 }
 
-void import_model::draw(shader *_shader) {
+void import_model::draw(shader *_shader, const camera *_camera,
+                        const glm::mat4 &_model) {
   if (!_shader) {
     return;
   }
 
   _shader->use();
-  for (auto &mesh : m_meshes) {
-    mesh.draw(_shader);
+  if (m_vertex_format == import_vertex_format::k_packed) {
+    _shader->set_uniform("uPositionOffset", m_quantization.offset);
+    _shader->set_uniform("uPositionScale", m_quantization.scale);
+  }
+  m_draw_call_count = 0;
+  m_triangle_count = 0;
+  m_submitted_count = 0;
+  m_culled_count = 0;
+  m_levels.assign(m_meshes.size(), 0);
+  m_visible.assign(m_meshes.size(), 1);
+  if (_camera) {
+    for (size_t i = 0; i < m_meshes.size(); i++) {
+      m_levels[i] = select_lod(m_meshes[i], *_camera, _model);
+    }
+    // Planes in model space, so the mesh bounds need no transform
+    const frustum view_frustum(_camera->ProjectionMatrix *
+                               _camera->ViewMatrix * _model);
+    if (m_culling == import_culling::k_spheres) {
+      // Four spheres at a time; boxes only refine the survivors
+      view_frustum.test_spheres(m_sphere_x.data(), m_sphere_y.data(),
+                                m_sphere_z.data(), m_sphere_radius.data(),
+                                m_meshes.size(), m_visible.data());
+      for (size_t i = 0; i < m_meshes.size(); i++) {
+        const bounding_volume &bounds = m_meshes[i].get_bounds();
+        if (m_visible[i] && !view_frustum.intersects(bounds)) {
+          m_visible[i] = 0;
+        }
+      }
+    } else if (m_culling == import_culling::k_hierarchy) {
+      update_mesh_bvh();
+      for (size_t i = 0; i < m_meshes.size(); i++) {
+        m_visible[i] = m_meshes[i].get_bounds().valid ? 0 : 1;
+      }
+      m_mesh_bvh.cull(view_frustum, [&](size_t _mesh) {
+        if (m_meshes[_mesh].get_bounds().valid) {
+          m_visible[_mesh] = 1;
+        }
+      });
+    }
+  }
+  for (unsigned char visible : m_visible) {
+    (visible ? m_submitted_count : m_culled_count)++;
+  }
+  auto level_of = [&](size_t _mesh) -> const import_lod & {
+    return m_meshes[_mesh].lods[m_levels[_mesh]];
+  };
+
+  if (m_draw_mode == import_draw_mode::k_per_mesh) {
+    for (size_t i = 0; i < m_meshes.size(); i++) {
+      if (!m_visible[i]) {
+        continue;
+      }
+      m_meshes[i].draw(_shader, m_levels[i]);
+      m_draw_call_count++;
+      m_triangle_count += level_of(i).index_count / 3;
+    }
+    return;
+  }
+
+  // Multi-draw lists hold arena offsets, which a compaction moves
+  auto &arena = buffer_arena::instance();
+  if (m_batches_dirty || m_batch_mode != m_draw_mode ||
+      (m_draw_mode == import_draw_mode::k_multi_draw &&
+       m_batch_generation != arena.generation())) {
+    build_batches(m_draw_mode);
+  }
+
+  for (auto &batch : m_batches) {
+    if (m_draw_mode == import_draw_mode::k_merged) {
+      // Drawn whole if any of its meshes is visible
+      const bool visible =
+          std::any_of(batch.meshes.begin(), batch.meshes.end(),
+                      [&](size_t _mesh) { return m_visible[_mesh] != 0; });
+      if (!visible) {
+        continue;
+      }
+      for (size_t mesh_index : batch.meshes) {
+        if (!m_visible[mesh_index]) {
+          m_culled_count--;
+          m_submitted_count++;
+        }
+      }
+      m_meshes[batch.material_mesh].bind_textures(_shader);
+      batch.merged.draw();
+      m_triangle_count += batch.merged.get_index_count() / 3;
+      m_draw_call_count++;
+      continue;
+    }
+
+    // List the visible meshes at their level of detail for this frame
+    batch.counts.clear();
+    batch.offsets.clear();
+    batch.base_vertices.clear();
+    for (size_t i = 0; i < batch.meshes.size(); i++) {
+      if (!m_visible[batch.meshes[i]]) {
+        continue;
+      }
+      const import_lod &lod = level_of(batch.meshes[i]);
+      batch.counts.push_back(static_cast<GLsizei>(lod.index_count));
+      batch.offsets.push_back(reinterpret_cast<const void *>(
+          (batch.first_indices[i] + lod.first_index) * sizeof(unsigned int)));
+      batch.base_vertices.push_back(
+          static_cast<GLint>(batch.first_vertices[i]));
+      m_triangle_count += lod.index_count / 3;
+    }
+    if (batch.counts.empty()) {
+      continue;
+    }
+    m_meshes[batch.material_mesh].bind_textures(_shader);
+    arena.bind(batch.page);
+    glMultiDrawElementsBaseVertex(
+        GL_TRIANGLES, batch.counts.data(), GL_UNSIGNED_INT,
+        batch.offsets.data(), static_cast<GLsizei>(batch.counts.size()),
+        batch.base_vertices.data());
+    m_draw_call_count++;
+  }
+  for (size_t mesh_index : m_unbatched) {
+    if (!m_visible[mesh_index]) {
+      continue;
+    }
+    m_meshes[mesh_index].draw(_shader, m_levels[mesh_index]);
+    m_draw_call_count++;
+    m_triangle_count += level_of(mesh_index).index_count / 3;
+  }
+}
+
+bool import_model::raycast(const bvh_ray &_ray, float &_t, size_t &_mesh) {
+  update_mesh_bvh();
+  m_triangle_bvhs.resize(m_meshes.size());
+  return m_mesh_bvh.raycast(
+      _ray,
+      [&](size_t _index, float _max_t) {
+        return raycast_mesh(_index, _ray, _max_t);
+      },
+      _t, _mesh);
+}
+
+float import_model::raycast_mesh(size_t _mesh, const bvh_ray &_ray,
+                                 float _max_t) {
+  const import_mesh &mesh = m_meshes[_mesh];
+  const import_lod &lod = mesh.lods[0];
+  const unsigned int *indices = mesh.indices.data() + lod.first_index;
+  bvh &triangles = m_triangle_bvhs[_mesh];
+  if (triangles.empty()) {
+    triangles.build(triangle_boxes(mesh.vertices.data(), sizeof(import_vertex),
+                                   indices, lod.index_count));
+  }
+  float t = -1.0f;
+  size_t triangle = 0;
+  triangles.raycast(
+      _ray,
+      [&](size_t _triangle, float) {
+        const unsigned int *corners = indices + _triangle * 3;
+        return intersect_ray_triangle(_ray,
+                                      mesh.vertices[corners[0]].position,
+                                      mesh.vertices[corners[1]].position,
+                                      mesh.vertices[corners[2]].position);
+      },
+      t, triangle, _max_t);
+  return t;
+}
+
+void import_model::update_mesh_bvh() {
+  if (!m_mesh_bvh_dirty) {
+    return;
+  }
+  std::vector<aabb> boxes(m_meshes.size());
+  for (size_t i = 0; i < m_meshes.size(); i++) {
+    const bounding_volume &bounds = m_meshes[i].get_bounds();
+    if (bounds.valid) {
+      boxes[i].expand(bounds.min);
+      boxes[i].expand(bounds.max);
+    } else {
+      boxes[i].expand(glm::vec3(0.0f)); // Nothing to draw or hit
+    }
+  }
+  m_mesh_bvh.build(boxes);
+  m_mesh_bvh_dirty = false;
+}
+
+size_t import_model::select_lod(const import_mesh &_mesh,
+                                const camera &_camera,
+                                const glm::mat4 &_model) const {
+  if (_mesh.lods.size() <= 1) {
+    return 0;
+  }
+
+  // Model units to viewport heights at the mesh's nearest point.
+  // ProjectionMatrix[1][1] maps view space y to NDC, which spans 2 units.
+  const float scale =
+      std::max({glm::length(glm::vec3(_model[0])),
+                glm::length(glm::vec3(_model[1])),
+                glm::length(glm::vec3(_model[2]))});
+  float to_screen = _camera.ProjectionMatrix[1][1] * 0.5f * scale;
+  if (!_camera.Orthographic) {
+    const glm::vec3 center =
+        glm::vec3(_model * glm::vec4(_mesh.get_bounds().center, 1.0f));
+    const float distance = glm::length(center - _camera.Position) -
+                           _mesh.get_bounds().radius * scale;
+    to_screen /= std::max(distance, _camera.Near);
+  }
+
+  size_t level = 0;
+  while (level + 1 < _mesh.lods.size() &&
+         _mesh.lods[level + 1].error * to_screen <= m_lod_threshold) {
+    level++;
   }
+  return level;
 }
@@ -3,14 +3,81 @@
 #include "assimp/Importer.hpp"
 #include "assimp/postprocess.h"
 #include "assimp/scene.h"
+#include "basic/camera.h"
+#include "tests/component/bvh.h"
+#include "tests/component/thread_pool.h"
 #include "tests/scenes/import_mesh.h"
+#include <cstddef>
 #include <string>
 #include <vector>
 
+// Texture reference of a parsed mesh, resolved to a texture_2d on upload
+struct import_texture_source {
+  std::string path;
+  std::string type; // e.g., "uTextureDiffuse", "uTextureSpecular"
+};
+
+// CPU side of one mesh. Building it does not touch GL, so it can be done on
+// a worker thread.
+struct import_mesh_source {
+  std::vector<import_vertex> vertices;
+  std::vector<unsigned int> indices;
+  std::vector<import_texture_source> textures;
+  std::vector<import_lod> lods; // Empty until import_model::build_lods
+  bool triangle_list = true;    // Every face has three indices
+};
+
+// CPU side of a whole model, see import_model::parse
+struct import_model_source {
+  std::string directory;
+  std::vector<import_mesh_source> meshes;
+
+  // Set by import_model::optimize; ACMR averaged over all triangles
+  bool optimized = false;
+  float acmr_before = 0.0f;
+  float acmr_after = 0.0f;
+};
+
+// Processing applied to a model after parsing. The binary cache stores the
+// result, so a cache written with other options is not used.
+struct import_options {
+  // Run import_model::optimize
+  bool optimize = false;
+  // Simplified levels per mesh, see import_model::build_lods
+  int lod_levels = 0;
+  // Triangle ratio from one level to the next
+  float lod_reduction = 0.5f;
+  // Largest error of a level, relative to the mesh's bounding radius
+  float lod_max_error = 0.05f;
+  // Upload import_packed_vertex instead of import_vertex. Only changes the
+  // GPU copy, so it does not affect the cache.
+  bool quantize = false;
+
+  bool operator==(const import_options &) const = default;
+};
+
+// How import_model::draw submits its meshes
+enum class import_draw_mode : int {
+  k_per_mesh = 0,   // One draw call per mesh, textures bound per mesh
+  k_multi_draw = 1, // One glMultiDrawElementsBaseVertex per material bucket
+  k_merged = 2      // Buckets merged on the CPU into one mesh each
+};
+
+// How import_model::draw skips meshes outside the view
+enum class import_culling : int {
+  k_none = 0,
+  k_spheres = 1,  // Every mesh's sphere with simd.h, then its box
+  k_hierarchy = 2 // Walk a bvh over the meshes' boxes
+};
+
 // Model class for loading and managing 3D models using Assimp
 class import_model {
 public:
-  explicit import_model(const std::string &_path);
+  // Load synchronously; throws if the file cannot be imported
+  explicit import_model(const std::string &_path,
+                        const import_options &_options = {});
+  // Empty model, to be filled by import_model_loader
+  import_model() = default;
   ~import_model() = default;
 
   // Disable copy constructor and copy assignment
@@ -21,31 +88,150 @@ public:
   import_model(import_model &&other) noexcept = default;
   import_model &operator=(import_model &&other) noexcept = default;
 
-  // Draw all meshes in the model
-  void draw(shader *_shader);
+  // Draw all meshes in the model. With a camera, every mesh draws the
+  // coarsest level of detail whose error projects to at most
+  // m_lod_threshold of the viewport height; _model is the model matrix the
+  // shader uses. Meshes whose bounds are outside the camera's frustum are
+  // skipped as m_culling says. For k_packed models _shader must be the
+  // packed vertex variant; draw() sets its quantization uniforms.
+  void draw(shader *_shader, const camera *_camera = nullptr,
+            const glm::mat4 &_model = glm::mat4(1.0f));
+
+  // Nearest mesh hit by _ray, given in model space, at full detail. Sets
+  // _t to the distance along the ray and _mesh to the mesh's index.
+  // Triangle hierarchies are built the first time a mesh is reached.
+  bool raycast(const bvh_ray &_ray, float &_t, size_t &_mesh);
+
+  // Append a mesh; GL thread only. Its vertex format must match the
+  // model's, see set_vertex_format.
+  void add_mesh(import_mesh &&_mesh);
+
+  // Vertex format and quantization of the meshes; set before adding any
+  void set_vertex_format(import_vertex_format _format,
+                         const import_quantization &_quantization = {});
+  import_vertex_format get_vertex_format() const { return m_vertex_format; }
+  const import_quantization &get_quantization() const {
+    return m_quantization;
+  }
+
+  // Read the file with Assimp and build the vertex and index arrays of every
+  // mesh. Touches no GL state, so it may run on any thread; meshes are built
+  // in parallel on _pool if one is given. Throws if the file cannot be read.
+  static import_model_source parse(const std::string &_path,
+                                   thread_pool *_pool = nullptr);
+
+  // Reorder the triangles and vertices of every mesh for the vertex cache,
+  // for less overdraw and for linear vertex fetch (see mesh_optimizer.h),
+  // and record the ACMR before and after. Meshes are independent, so they
+  // are processed in parallel on _pool if one is given.
+  static void optimize(import_model_source &_source,
+                       thread_pool *_pool = nullptr);
+
+  // Append up to _options.lod_levels simplified versions of every mesh to
+  // its indices (see mesh_simplifier.h), each with about lod_reduction times
+  // the triangles of the previous one. Stops early for a mesh once a level
+  // would exceed lod_max_error or barely shrinks. Levels share the mesh's
+  // vertices and are vertex cache optimized if _options.optimize is set.
+  static void build_lods(import_model_source &_source,
+                         const import_options &_options,
+                         thread_pool *_pool = nullptr);
+
+  // Bounds of all meshes' positions, for packing them with one quantization
+  // so meshes of a model can still be drawn together
+  static import_quantization
+  compute_quantization(const import_model_source &_source);
+
+  // Extract directory from file path
+  static std::string extract_directory(const std::string &_path);
+
+  // Assimp post-processing applied by parse()
+  static constexpr unsigned int k_import_flags =
+      aiProcess_Triangulate | aiProcess_FlipUVs;
+
+  // Draw calls and triangles issued by the last draw()
+  size_t get_draw_call_count() const { return m_draw_call_count; }
+  size_t get_triangle_count() const { return m_triangle_count; }
+
+  // Meshes drawn and meshes skipped by frustum culling in the last draw()
+  size_t get_submitted_count() const { return m_submitted_count; }
+  size_t get_culled_count() const { return m_culled_count; }
+
+  import_draw_mode m_draw_mode = import_draw_mode::k_multi_draw;
+  // Screen-space error allowed when picking a level of detail, as a
+  // fraction of the viewport height; 0.001 is about a pixel at 1080p
+  float m_lod_threshold = 0.001f;
+  import_culling m_culling = import_culling::k_hierarchy;
 
   // Public data members
   std::vector<import_mesh> m_meshes;
   std::string m_directory;
 
 private:
-  // Load model from file path
-  void load_model(const std::string &_path);
+  // Meshes sharing an arena page and a texture set, drawn together
+  struct draw_batch {
+    size_t material_mesh = 0; // Mesh whose textures the batch binds
+    int page = -1;
+    std::vector<size_t> meshes;
+    std::vector<size_t> first_indices;  // Arena offsets of each mesh
+    std::vector<size_t> first_vertices;
+    // Draw lists of the visible meshes, refilled by every draw()
+    std::vector<GLsizei> counts;
+    std::vector<const void *> offsets;
+    std::vector<GLint> base_vertices;
+    mesh_manager merged; // k_merged only, full detail
+  };
 
-  // Extract directory from file path
-  static std::string extract_directory(const std::string &_path);
+  // Group the meshes into m_batches and fill the draw lists for _mode
+  void build_batches(import_draw_mode _mode);
+
+  // Rebuild m_mesh_bvh after meshes were added
+  void update_mesh_bvh();
 
-  // Process scene node recursively
-  void process_node(aiNode *_node, const aiScene *_scene);
-  void process_node_impl(aiNode *_node, const aiScene *_scene, int _depth);
+  // Distance along _ray to the nearest full detail triangle of a mesh
+  // closer than _max_t, or a negative value
+  float raycast_mesh(size_t _mesh, const bvh_ray &_ray, float _max_t);
+
+  // Level of detail of a mesh for the given view, see draw()
+  size_t select_lod(const import_mesh &_mesh, const camera &_camera,
+                    const glm::mat4 &_model) const;
+
+  // Collect the meshes referenced by a node and its children, in order
+  static void collect_meshes(aiNode *_node, const aiScene *_scene, int _depth,
+                             std::vector<unsigned int> &_mesh_indices);
 
   // Process a single mesh from Assimp
-  import_mesh process_mesh(aiMesh *_mesh, const aiScene *_scene);
+  static import_mesh_source process_mesh(aiMesh *_mesh, const aiScene *_scene,
+                                         const std::string &_directory);
 
-  // Load textures from material
-  void load_material_textures(aiMaterial *_material, aiTextureType _type,
-                              std::vector<import_texture> &_textures);
+  // Collect texture paths from material
+  static void
+  load_material_textures(aiMaterial *_material, aiTextureType _type,
+                         const std::string &_directory,
+                         std::vector<import_texture_source> &_textures);
 
   // Constants
   static constexpr int MAX_RECURSION_DEPTH = 100;
+
+  std::vector<draw_batch> m_batches;
+  std::vector<size_t> m_unbatched; // Meshes without indexed arena data
+  import_draw_mode m_batch_mode = import_draw_mode::k_per_mesh;
+  bool m_batches_dirty = true;
+  size_t m_batch_generation = 0;
+  size_t m_draw_call_count = 0;
+  size_t m_triangle_count = 0;
+  size_t m_submitted_count = 0;
+  size_t m_culled_count = 0;
+  std::vector<size_t> m_levels; // Level of every mesh in the current draw
+  std::vector<unsigned char> m_visible; // Per mesh, in the current draw
+
+  // Bounding spheres of m_meshes as separate arrays for
+  // frustum::test_spheres
+  std::vector<float> m_sphere_x, m_sphere_y, m_sphere_z, m_sphere_radius;
+  // Over the meshes' boxes, for culling and raycast()
+  bvh m_mesh_bvh;
+  bool m_mesh_bvh_dirty = true;
+  // Over each mesh's full detail triangles; empty until raycast() needs it
+  std::vector<bvh> m_triangle_bvhs;
+  import_vertex_format m_vertex_format = import_vertex_format::k_float;
+  import_quantization m_quantization;
 };
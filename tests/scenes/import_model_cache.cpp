@@ -0,0 +1,344 @@
+#include "import_model_cache.h"
+
+#include "tests/component/mapped_file.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+constexpr char k_magic[8] = {'L', 'O', 'G', 'L', 'M', 'E', 'S', 'H'};
+// Bump whenever the layout below or import_model::parse changes
+constexpr std::uint32_t k_version = 4;
+constexpr std::uint64_t k_blob_alignment = 16;
+
+struct cache_header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t vertex_size;
+  std::uint64_t source_hash;
+  std::uint32_t import_flags;
+  std::uint32_t mesh_count;
+  std::uint32_t texture_count;
+  std::uint32_t string_bytes;
+  std::uint64_t file_size;
+  std::uint32_t lod_count;
+  std::uint32_t optimized;
+  std::uint32_t lod_levels;
+  float lod_reduction;
+  float lod_max_error;
+  float acmr_before;
+  float acmr_after;
+  std::uint32_t reserved;
+};
+
+struct cache_mesh {
+  std::uint64_t vertex_offset;
+  std::uint64_t index_offset;
+  std::uint32_t vertex_count;
+  std::uint32_t index_count;
+  std::uint32_t first_texture;
+  std::uint32_t texture_count;
+  std::uint32_t first_lod;
+  std::uint32_t lod_count;
+};
+
+struct cache_lod {
+  std::uint32_t first_index;
+  std::uint32_t index_count;
+  float error;
+  std::uint32_t reserved;
+};
+
+struct cache_texture {
+  std::uint32_t path_offset;
+  std::uint32_t path_length;
+  std::uint32_t type_offset;
+  std::uint32_t type_length;
+};
+
+static_assert(std::is_trivially_copyable_v<import_vertex>);
+static_assert(sizeof(cache_header) % 8 == 0 && sizeof(cache_mesh) % 8 == 0 &&
+              sizeof(cache_texture) % 8 == 0 && sizeof(cache_lod) % 8 == 0);
+
+bool matches(const cache_header &_header, const import_options &_options) {
+  return _header.optimized == (_options.optimize ? 1u : 0u) &&
+         _header.lod_levels ==
+             static_cast<std::uint32_t>(_options.lod_levels) &&
+         _header.lod_reduction == _options.lod_reduction &&
+         _header.lod_max_error == _options.lod_max_error;
+}
+
+std::string cache_path(const std::string &_source_path) {
+  return _source_path + ".meshcache";
+}
+
+std::uint64_t align_up(std::uint64_t _offset) {
+  return (_offset + k_blob_alignment - 1) & ~(k_blob_alignment - 1);
+}
+
+// Strip the asset directory so the cache survives moving the asset folder
+std::string relative_texture_path(const std::string &_path,
+                                  const std::string &_directory) {
+  const std::string prefix = _directory + "/";
+  if (_path.compare(0, prefix.size(), prefix) == 0) {
+    return _path.substr(prefix.size());
+  }
+  return _path;
+}
+
+} // namespace
+
+std::uint64_t hash_model_source(const std::string &_source_path) {
+  mapped_file file(_source_path);
+  if (!file.is_open()) {
+    return 0;
+  }
+  std::uint64_t hash = 14695981039346656037ull;
+  const unsigned char *bytes = file.data();
+  for (size_t i = 0; i < file.size(); i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+bool load_model_cache(const std::string &_source_path,
+                      std::uint64_t _source_hash,
+                      const import_options &_options,
+                      import_model_source &_out) {
+  if (_source_hash == 0) {
+    return false;
+  }
+  mapped_file file(cache_path(_source_path));
+  if (!file.is_open() || file.size() < sizeof(cache_header)) {
+    return false;
+  }
+  const unsigned char *base = file.data();
+  const std::uint64_t size = file.size();
+
+  cache_header header;
+  std::memcpy(&header, base, sizeof(header));
+  if (std::memcmp(header.magic, k_magic, sizeof(k_magic)) != 0 ||
+      header.version != k_version ||
+      header.vertex_size != sizeof(import_vertex) ||
+      header.source_hash != _source_hash ||
+      header.import_flags != import_model::k_import_flags ||
+      !matches(header, _options) ||
+      header.file_size != size) {
+    return false;
+  }
+
+  const std::uint64_t meshes_offset = sizeof(cache_header);
+  const std::uint64_t textures_offset =
+      meshes_offset +
+      static_cast<std::uint64_t>(header.mesh_count) * sizeof(cache_mesh);
+  const std::uint64_t lods_offset =
+      textures_offset +
+      static_cast<std::uint64_t>(header.texture_count) * sizeof(cache_texture);
+  const std::uint64_t strings_offset =
+      lods_offset +
+      static_cast<std::uint64_t>(header.lod_count) * sizeof(cache_lod);
+  if (strings_offset + header.string_bytes > size) {
+    return false;
+  }
+  const char *strings = reinterpret_cast<const char *>(base + strings_offset);
+  auto in_file = [size](std::uint64_t _offset, std::uint64_t _bytes) {
+    return _offset <= size && _bytes <= size - _offset;
+  };
+
+  import_model_source source;
+  source.directory = import_model::extract_directory(_source_path);
+  source.optimized = _options.optimize;
+  source.acmr_before = header.acmr_before;
+  source.acmr_after = header.acmr_after;
+  source.meshes.resize(header.mesh_count);
+  for (std::uint32_t i = 0; i < header.mesh_count; i++) {
+    cache_mesh entry;
+    std::memcpy(&entry, base + meshes_offset + i * sizeof(cache_mesh),
+                sizeof(entry));
+    const std::uint64_t vertex_bytes =
+        static_cast<std::uint64_t>(entry.vertex_count) * sizeof(import_vertex);
+    const std::uint64_t index_bytes =
+        static_cast<std::uint64_t>(entry.index_count) * sizeof(unsigned int);
+    if (!in_file(entry.vertex_offset, vertex_bytes) ||
+        !in_file(entry.index_offset, index_bytes) ||
+        static_cast<std::uint64_t>(entry.first_texture) + entry.texture_count >
+            header.texture_count ||
+        static_cast<std::uint64_t>(entry.first_lod) + entry.lod_count >
+            header.lod_count) {
+      return false;
+    }
+
+    import_mesh_source &mesh = source.meshes[i];
+    mesh.vertices.resize(entry.vertex_count);
+    if (vertex_bytes > 0) {
+      std::memcpy(mesh.vertices.data(), base + entry.vertex_offset,
+                  vertex_bytes);
+    }
+    mesh.indices.resize(entry.index_count);
+    if (index_bytes > 0) {
+      std::memcpy(mesh.indices.data(), base + entry.index_offset,
+                  index_bytes);
+    }
+
+    for (std::uint32_t l = 0; l < entry.lod_count; l++) {
+      cache_lod lod;
+      std::memcpy(&lod,
+                  base + lods_offset +
+                      (entry.first_lod + l) * sizeof(cache_lod),
+                  sizeof(lod));
+      if (static_cast<std::uint64_t>(lod.first_index) + lod.index_count >
+          entry.index_count) {
+        return false;
+      }
+      mesh.lods.push_back(
+          import_lod{lod.first_index, lod.index_count, lod.error});
+    }
+
+    for (std::uint32_t t = 0; t < entry.texture_count; t++) {
+      cache_texture texture;
+      std::memcpy(&texture,
+                  base + textures_offset +
+                      (entry.first_texture + t) * sizeof(cache_texture),
+                  sizeof(texture));
+      if (static_cast<std::uint64_t>(texture.path_offset) +
+                  texture.path_length >
+              header.string_bytes ||
+          static_cast<std::uint64_t>(texture.type_offset) +
+                  texture.type_length >
+              header.string_bytes) {
+        return false;
+      }
+      mesh.textures.push_back(import_texture_source{
+          source.directory + "/" +
+              std::string(strings + texture.path_offset, texture.path_length),
+          std::string(strings + texture.type_offset, texture.type_length)});
+    }
+  }
+
+  _out = std::move(source);
+  return true;
+}
+
+bool save_model_cache(const std::string &_source_path,
+                      std::uint64_t _source_hash,
+                      const import_options &_options,
+                      const import_model_source &_source) {
+  if (_source_hash == 0) {
+    return false;
+  }
+
+  std::vector<cache_mesh> meshes;
+  std::vector<cache_texture> textures;
+  std::vector<cache_lod> lods;
+  std::string strings;
+  meshes.reserve(_source.meshes.size());
+  for (const auto &mesh : _source.meshes) {
+    cache_mesh entry{};
+    entry.vertex_count = static_cast<std::uint32_t>(mesh.vertices.size());
+    entry.index_count = static_cast<std::uint32_t>(mesh.indices.size());
+    entry.first_texture = static_cast<std::uint32_t>(textures.size());
+    entry.texture_count = static_cast<std::uint32_t>(mesh.textures.size());
+    entry.first_lod = static_cast<std::uint32_t>(lods.size());
+    entry.lod_count = static_cast<std::uint32_t>(mesh.lods.size());
+    for (const auto &lod : mesh.lods) {
+      lods.push_back(cache_lod{static_cast<std::uint32_t>(lod.first_index),
+                               static_cast<std::uint32_t>(lod.index_count),
+                               lod.error, 0});
+    }
+    for (const auto &texture : mesh.textures) {
+      const std::string path =
+          relative_texture_path(texture.path, _source.directory);
+      cache_texture record{};
+      record.path_offset = static_cast<std::uint32_t>(strings.size());
+      record.path_length = static_cast<std::uint32_t>(path.size());
+      strings += path;
+      record.type_offset = static_cast<std::uint32_t>(strings.size());
+      record.type_length = static_cast<std::uint32_t>(texture.type.size());
+      strings += texture.type;
+      textures.push_back(record);
+    }
+    meshes.push_back(entry);
+  }
+
+  // Place the blobs after the tables
+  std::uint64_t offset = sizeof(cache_header) +
+                         meshes.size() * sizeof(cache_mesh) +
+                         textures.size() * sizeof(cache_texture) +
+                         lods.size() * sizeof(cache_lod) + strings.size();
+  for (size_t i = 0; i < meshes.size(); i++) {
+    offset = align_up(offset);
+    meshes[i].vertex_offset = offset;
+    offset += _source.meshes[i].vertices.size() * sizeof(import_vertex);
+    offset = align_up(offset);
+    meshes[i].index_offset = offset;
+    offset += _source.meshes[i].indices.size() * sizeof(unsigned int);
+  }
+
+  cache_header header{};
+  std::memcpy(header.magic, k_magic, sizeof(k_magic));
+  header.version = k_version;
+  header.vertex_size = sizeof(import_vertex);
+  header.source_hash = _source_hash;
+  header.import_flags = import_model::k_import_flags;
+  header.mesh_count = static_cast<std::uint32_t>(meshes.size());
+  header.texture_count = static_cast<std::uint32_t>(textures.size());
+  header.string_bytes = static_cast<std::uint32_t>(strings.size());
+  header.file_size = offset;
+  header.lod_count = static_cast<std::uint32_t>(lods.size());
+  header.optimized = _options.optimize ? 1u : 0u;
+  header.lod_levels = static_cast<std::uint32_t>(_options.lod_levels);
+  header.lod_reduction = _options.lod_reduction;
+  header.lod_max_error = _options.lod_max_error;
+  header.acmr_before = _source.acmr_before;
+  header.acmr_after = _source.acmr_after;
+
+  // Write to a temporary file and rename it, so a reader never sees a
+  // partial cache
+  const std::string path = cache_path(_source_path);
+  const std::string temp_path = path + ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      return false;
+    }
+    std::uint64_t written = 0;
+    auto write = [&](const void *_data, std::uint64_t _bytes) {
+      out.write(static_cast<const char *>(_data),
+                static_cast<std::streamsize>(_bytes));
+      written += _bytes;
+    };
+    auto pad = [&]() {
+      static const char zeros[k_blob_alignment] = {};
+      write(zeros, align_up(written) - written);
+    };
+    write(&header, sizeof(header));
+    write(meshes.data(), meshes.size() * sizeof(cache_mesh));
+    write(textures.data(), textures.size() * sizeof(cache_texture));
+    write(lods.data(), lods.size() * sizeof(cache_lod));
+    write(strings.data(), strings.size());
+    for (const auto &mesh : _source.meshes) {
+      pad();
+      write(mesh.vertices.data(), mesh.vertices.size() * sizeof(import_vertex));
+      pad();
+      write(mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int));
+    }
+    if (!out) {
+      out.close();
+      std::remove(temp_path.c_str());
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temp_path, path, error);
+  if (error) {
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "tests/scenes/import_model.h"
+#include <cstdint>
+#include <string>
+
+// Binary cache of parsed models, stored next to the asset as
+// "<asset>.meshcache".
+//
+// The file is a header, a mesh table, a texture table, a level of detail
+// table, a string table and then the vertex and index arrays of every mesh,
+// 16-byte aligned. Loading
+// maps the file and copies each array with a single memcpy, with no Assimp
+// parse and no per-vertex conversion.
+//
+// The header records a hash of the source file's bytes, the Assimp
+// post-process flags, the import_vertex layout and the import_options the
+// meshes were processed with; a cache that does not match all four is
+// ignored. Files the asset references (such as an .obj's
+// .mtl) are not part of the hash. Texture paths are stored relative to the
+// asset's directory. Integers are stored in host byte order.
+
+// FNV-1a hash of a file's contents; 0 if it cannot be read
+std::uint64_t hash_model_source(const std::string &_source_path);
+
+// Fill _out from the cache of _source_path if it exists and matches
+// _source_hash and _options. Returns false on a miss or a damaged cache.
+bool load_model_cache(const std::string &_source_path,
+                      std::uint64_t _source_hash,
+                      const import_options &_options,
+                      import_model_source &_out);
+
+// Write the cache of _source_path, processed with _options. Returns false if
+// it cannot be written, e.g. in a read-only asset directory.
+bool save_model_cache(const std::string &_source_path,
+                      std::uint64_t _source_hash,
+                      const import_options &_options,
+                      const import_model_source &_source);
@@ -0,0 +1,197 @@
+#include "import_model_loader.h"
+
+#include "tests/component/texture_cache.h"
+#include "tests/scenes/import_model_cache.h"
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <utility>
+
+import_model_loader::import_model_loader(const std::string &_path,
+                                         const import_options &_options,
+                                         thread_pool &_pool)
+    : m_pool(_pool), m_path(_path), m_options(_options) {
+  m_pool.submit([this] { run(); });
+}
+
+import_model_loader::~import_model_loader() { wait(); }
+
+void import_model_loader::wait() {
+  std::unique_lock<std::mutex> lock(m_finished_mutex);
+  m_finished_condition.wait(lock, [this] { return m_finished; });
+}
+
+void import_model_loader::run() {
+  try {
+    const auto start = std::chrono::steady_clock::now();
+    const std::uint64_t source_hash = hash_model_source(m_path);
+    m_from_cache =
+        load_model_cache(m_path, source_hash, m_options, m_source);
+    if (!m_from_cache) {
+      m_source = import_model::parse(m_path, &m_pool);
+      if (m_options.optimize) {
+        import_model::optimize(m_source, &m_pool);
+      }
+      import_model::build_lods(m_source, m_options, &m_pool);
+      if (!save_model_cache(m_path, source_hash, m_options, m_source)) {
+        std::cerr << "Warning: Failed to write mesh cache for " << m_path
+                  << std::endl;
+      }
+    }
+    m_parse_seconds = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+    m_optimized = m_source.optimized;
+    m_acmr_before = m_source.acmr_before;
+    m_acmr_after = m_source.acmr_after;
+    if (m_options.quantize) {
+      m_quantization = import_model::compute_quantization(m_source);
+    }
+
+    // Decode every image once, even if several meshes use it, and skip the
+    // ones another model already keeps resident
+    std::set<std::string> paths;
+    for (const auto &mesh : m_source.meshes) {
+      for (const auto &texture : mesh.textures) {
+        paths.insert(texture.path);
+      }
+    }
+    m_texture_paths.assign(paths.begin(), paths.end());
+    m_images.resize(m_texture_paths.size());
+    m_texture_cached.assign(m_texture_paths.size(), 0);
+    m_stage = stage::k_decoding;
+
+    m_pool.parallel_for(m_texture_paths.size(), [this](size_t _i) {
+      if (texture_cache::instance().contains(m_texture_paths[_i])) {
+        m_texture_cached[_i] = 1;
+      } else {
+        m_images[_i] = image_data::load(m_texture_paths[_i].c_str());
+      }
+      m_textures_decoded.fetch_add(1);
+    });
+    m_stage = stage::k_uploading;
+  } catch (const std::exception &e) {
+    m_error = e.what();
+    m_stage = stage::k_failed;
+  }
+
+  // Notify under the lock: the waiter may destroy this object as soon as it
+  // sees m_finished.
+  std::lock_guard<std::mutex> lock(m_finished_mutex);
+  m_finished = true;
+  m_finished_condition.notify_all();
+}
+
+bool import_model_loader::upload(import_model &_model, size_t _byte_budget) {
+  const stage current = m_stage.load();
+  if (current == stage::k_done || current == stage::k_failed) {
+    return true;
+  }
+  if (current != stage::k_uploading) {
+    return false;
+  }
+
+  _model.m_directory = m_source.directory;
+  if (m_next_mesh == 0 && m_options.quantize) {
+    _model.set_vertex_format(import_vertex_format::k_packed, m_quantization);
+  }
+  size_t spent = 0;
+  bool first = true;
+  auto take_budget = [&](size_t _bytes) {
+    if (!first && spent + _bytes > _byte_budget) {
+      return false;
+    }
+    first = false;
+    spent += _bytes;
+    return true;
+  };
+
+  // Textures first, so every mesh can resolve its texture references
+  for (; m_next_texture < m_texture_paths.size(); m_next_texture++) {
+    image_data &image = m_images[m_next_texture];
+    if (!take_budget(image.size())) {
+      return false;
+    }
+    const std::string &path = m_texture_paths[m_next_texture];
+    if (image.pixels) {
+      m_textures[path] = texture_cache::instance().get(path, image);
+    } else if (m_texture_cached[m_next_texture]) {
+      // Loads again if it was freed since the decode pass checked
+      try {
+        m_textures[path] = texture_cache::instance().get(path);
+      } catch (const std::exception &e) {
+        std::cerr << "Warning: Failed to load texture: " << path << " - "
+                  << e.what() << std::endl;
+      }
+    } else {
+      // Continue loading other textures instead of failing the model
+      std::cerr << "Warning: Failed to load texture: " << path << std::endl;
+    }
+    image = image_data();
+  }
+
+  for (; m_next_mesh < m_source.meshes.size(); m_next_mesh++) {
+    import_mesh_source &source = m_source.meshes[m_next_mesh];
+    if (!take_budget(source.vertices.size() * sizeof(import_vertex) +
+                     source.indices.size() * sizeof(unsigned int))) {
+      return false;
+    }
+    std::vector<import_texture> textures;
+    for (const auto &texture : source.textures) {
+      auto it = m_textures.find(texture.path);
+      if (it != m_textures.end()) {
+        textures.push_back(import_texture{it->second, texture.type});
+      }
+    }
+    // The source is dropped right after, so its arrays move into the mesh
+    _model.add_mesh(import_mesh(
+        std::move(source.vertices), std::move(source.indices),
+        std::move(textures), std::move(source.lods),
+        _model.get_vertex_format(), _model.get_quantization()));
+    source = import_mesh_source();
+  }
+
+  m_stage = stage::k_done;
+  return true;
+}
+
+const char *import_model_loader::get_stage_name() const {
+  switch (m_stage.load()) {
+  case stage::k_parsing:
+    return "Parsing";
+  case stage::k_decoding:
+    return "Decoding textures";
+  case stage::k_uploading:
+    return "Uploading";
+  case stage::k_done:
+    return "Done";
+  case stage::k_failed:
+    return "Failed";
+  }
+  return "";
+}
+
+float import_model_loader::progress() const {
+  // Parsing has no progress of its own; decoding and uploading get half each
+  switch (m_stage.load()) {
+  case stage::k_parsing:
+    return 0.0f;
+  case stage::k_decoding: {
+    const size_t total = m_texture_paths.size();
+    return total == 0 ? 0.5f
+                      : 0.5f * static_cast<float>(m_textures_decoded.load()) /
+                            static_cast<float>(total);
+  }
+  case stage::k_uploading: {
+    const size_t total = m_texture_paths.size() + m_source.meshes.size();
+    const size_t done = m_next_texture + m_next_mesh;
+    return total == 0 ? 1.0f
+                      : 0.5f + 0.5f * static_cast<float>(done) /
+                                   static_cast<float>(total);
+  }
+  case stage::k_done:
+  case stage::k_failed:
+    return 1.0f;
+  }
+  return 0.0f;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "basic/texture.h"
+#include "tests/component/thread_pool.h"
+#include "tests/scenes/import_model.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Imports a model without blocking the render thread.
+//
+// The constructor queues a job on a thread pool that reads the model from its
+// binary cache (see import_model_cache.h) or, on a miss, parses the file with
+// Assimp, builds the vertex and index arrays of all meshes in parallel,
+// processes them as import_options asks and writes the cache. It then
+// decodes every referenced texture in parallel.
+// Once that is done, upload() is called once per frame on the render thread.
+// It creates the GL textures and meshes from the finished CPU data and stops
+// when the frame's byte budget is used up.
+class import_model_loader {
+public:
+  enum class stage : int {
+    k_parsing = 0,
+    k_decoding = 1,
+    k_uploading = 2,
+    k_done = 3,
+    k_failed = 4
+  };
+
+  explicit import_model_loader(const std::string &_path,
+                               const import_options &_options = {},
+                               thread_pool &_pool = thread_pool::instance());
+  // Waits for the background job to finish
+  ~import_model_loader();
+
+  import_model_loader(const import_model_loader &) = delete;
+  import_model_loader &operator=(const import_model_loader &) = delete;
+
+  // Render thread only. Create textures and meshes in _model from finished
+  // data, about _byte_budget bytes of it per call but at least one texture
+  // or mesh. Returns true once the model is complete or the import failed.
+  bool upload(import_model &_model, size_t _byte_budget);
+
+  // Block until the background job is finished
+  void wait();
+
+  stage get_stage() const { return m_stage.load(); }
+  const char *get_stage_name() const;
+
+  // Overall progress in [0, 1]; call from the render thread
+  float progress() const;
+
+  // Reason of the failure once get_stage() is k_failed
+  const std::string &error() const { return m_error; }
+
+  // Whether the meshes came from the binary cache, and how long reading or
+  // parsing them took. Valid once get_stage() is past k_parsing.
+  bool loaded_from_cache() const { return m_from_cache; }
+  double get_parse_seconds() const { return m_parse_seconds; }
+
+  // Whether the meshes were optimized, and their ACMR before and after.
+  // Valid once get_stage() is past k_parsing.
+  bool is_optimized() const { return m_optimized; }
+  float get_acmr_before() const { return m_acmr_before; }
+  float get_acmr_after() const { return m_acmr_after; }
+
+private:
+  void run();
+
+  thread_pool &m_pool;
+  std::string m_path;
+  import_options m_options;
+
+  // Written by the background job before it advances m_stage
+  import_model_source m_source;
+  std::vector<std::string> m_texture_paths;
+  std::vector<image_data> m_images;
+  std::vector<char> m_texture_cached; // Resident already, not decoded
+  std::string m_error;
+  bool m_from_cache = false;
+  double m_parse_seconds = 0.0;
+  bool m_optimized = false;
+  float m_acmr_before = 0.0f;
+  float m_acmr_after = 0.0f;
+  import_quantization m_quantization; // Used if m_options.quantize
+
+  std::atomic<stage> m_stage{stage::k_parsing};
+  std::atomic<size_t> m_textures_decoded{0};
+  std::mutex m_finished_mutex;
+  std::condition_variable m_finished_condition;
+  bool m_finished = false;
+
+  // Render thread state
+  std::map<std::string, std::shared_ptr<texture_2d>> m_textures;
+  size_t m_next_texture = 0;
+  size_t m_next_mesh = 0;
+};
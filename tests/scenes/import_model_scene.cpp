@@ -1,9 +1,14 @@
 #include "import_model_scene.h"
+#include "imgui.h"
+#include "tests/component/buffer_arena.h"
 #include "tests/component/shader_loader.h"
+#include "tests/component/texture_cache.h"
+#include <cstdio>
 
 import_model_scene::import_model_scene()
-    : renderable_scene_base("Import Model Scene"),
-      m_import_model("assets/models/tom/tom.obj") {}
+    : renderable_scene_base("Import Model Scene") {}
+
+import_model_scene::~import_model_scene() { delete m_packed_shader; }
 
 void import_model_scene::init(GLFWwindow *_window) {
   renderable_scene_base::init(_window);
@@ -13,24 +18,143 @@ void import_model_scene::init(GLFWwindow *_window) {
                    "shaders/import_model_test/fragment.shader",
                    "shaders/import_model_test/light_fragment.shader", m_shader,
                    m_light_shader);
+  m_packed_shader =
+      load_shader("shaders/import_model_test/vertex_packed.shader",
+                  "shaders/import_model_test/fragment.shader");
 
   // Setup camera - position it to view the model
   m_camera.Position = {0.0f, 0.0f, 5.0f};
   m_camera.Yaw = -90.0f;
   m_camera.Pitch = 0.0f;
   m_camera.update_view_matrix();
+
+  start_import();
+}
+
+void import_model_scene::start_import() {
+  // Finish any running import before its model goes away
+  m_loader.reset();
+  const import_draw_mode draw_mode = m_import_model.m_draw_mode;
+  const float lod_threshold = m_import_model.m_lod_threshold;
+  const import_culling culling = m_import_model.m_culling;
+  m_import_model = import_model();
+  m_import_model.m_draw_mode = draw_mode;
+  m_import_model.m_lod_threshold = lod_threshold;
+  m_import_model.m_culling = culling;
+  m_hovered_mesh = -1;
+  m_load_error.clear();
+  m_load_summary.clear();
+  // update() uploads the results as they become ready
+  m_loader = std::make_unique<import_model_loader>("assets/models/tom/tom.obj",
+                                                   m_import_options);
+}
+
+void import_model_scene::update(float _delta_time) {
+  renderable_scene_base::update(_delta_time);
+  if (!m_loader) {
+    return;
+  }
+  if (m_loader->upload(m_import_model,
+                       static_cast<size_t>(m_upload_budget_kb) * 1024)) {
+    if (m_loader->get_stage() == import_model_loader::stage::k_failed) {
+      m_load_error = m_loader->error();
+    } else {
+      m_load_summary = std::string(m_loader->loaded_from_cache()
+                                       ? "Loaded from mesh cache"
+                                       : "Parsed with Assimp") +
+                       " in " +
+                       std::to_string(static_cast<int>(
+                           m_loader->get_parse_seconds() * 1000.0)) +
+                       " ms";
+      if (m_loader->is_optimized()) {
+        char acmr[64];
+        std::snprintf(acmr, sizeof(acmr), ", ACMR %.3f -> %.3f",
+                      m_loader->get_acmr_before(), m_loader->get_acmr_after());
+        m_load_summary += acmr;
+      }
+    }
+    m_loader.reset();
+  }
+}
+
+bool import_model_scene::pick_object(float _clip_x, float _clip_y,
+                                     int &_object_id) {
+  // The model is drawn with an identity model matrix
+  float t = 0.0f;
+  size_t mesh = 0;
+  _object_id = m_import_model.raycast(make_pick_ray(m_camera, _clip_x, _clip_y),
+                                      t, mesh)
+                   ? static_cast<int>(mesh)
+                   : -1;
+  return true;
+}
+
+void import_model_scene::on_object_hovered(int _object_id) {
+  m_hovered_mesh = _object_id;
 }
 
 void import_model_scene::render() {
-  if (!m_shader) {
+  shader *model_shader =
+      m_import_model.get_vertex_format() == import_vertex_format::k_packed
+          ? m_packed_shader
+          : m_shader;
+  if (!model_shader) {
     return;
   }
 
-  set_matrices(m_shader);
-  m_import_model.draw(m_shader);
+  set_matrices(model_shader);
+  m_import_model.draw(model_shader, &m_camera);
 }
 
 void import_model_scene::render_ui() {
   renderable_scene_base::render_ui();
   render_camera_ui();
+
+  if (m_loader) {
+    ImGui::ProgressBar(m_loader->progress(), ImVec2(-1.0f, 0.0f),
+                       m_loader->get_stage_name());
+  } else if (!m_load_error.empty()) {
+    ImGui::TextColored(ImVec4(0.9f, 0.3f, 0.2f, 1.0f), "Import failed: %s",
+                       m_load_error.c_str());
+  } else if (!m_load_summary.empty()) {
+    ImGui::Text("%s", m_load_summary.c_str());
+  }
+  ImGui::SliderInt("Upload budget (KB/frame)", &m_upload_budget_kb, 64,
+                   65536);
+  ImGui::Checkbox("Optimize meshes", &m_import_options.optimize);
+  ImGui::Checkbox("Packed vertices", &m_import_options.quantize);
+  ImGui::SliderInt("LOD levels", &m_import_options.lod_levels, 0, 6);
+  if (ImGui::Button("Reload")) {
+    start_import();
+  }
+  ImGui::SliderFloat("LOD threshold", &m_import_model.m_lod_threshold, 0.0f,
+                     0.02f, "%.4f");
+
+  int draw_mode = static_cast<int>(m_import_model.m_draw_mode);
+  if (ImGui::Combo("Draw Mode", &draw_mode,
+                   "Per Mesh\0Multi Draw\0Merged\0")) {
+    m_import_model.m_draw_mode = static_cast<import_draw_mode>(draw_mode);
+  }
+  int culling = static_cast<int>(m_import_model.m_culling);
+  if (ImGui::Combo("Culling", &culling, "None\0Spheres (SIMD)\0BVH\0")) {
+    m_import_model.m_culling = static_cast<import_culling>(culling);
+  }
+  ImGui::Text("Meshes: %zu, draw calls: %zu, triangles: %zu",
+              m_import_model.m_meshes.size(),
+              m_import_model.get_draw_call_count(),
+              m_import_model.get_triangle_count());
+  ImGui::Text("Submitted: %zu, culled: %zu",
+              m_import_model.get_submitted_count(),
+              m_import_model.get_culled_count());
+  if (m_hovered_mesh >= 0) {
+    ImGui::Text("Hovered mesh: %d", m_hovered_mesh);
+  } else {
+    ImGui::Text("Hovered mesh: none");
+  }
+  ImGui::Text("Resident textures: %zu", texture_cache::instance().size());
+
+  const auto &arena = buffer_arena::instance();
+  ImGui::Text("Mesh arena: %zu pages, %.1f / %.1f MB", arena.page_count(),
+              static_cast<double>(arena.used_bytes()) / (1024.0 * 1024.0),
+              static_cast<double>(arena.capacity_bytes()) / (1024.0 * 1024.0));
 }
\ No newline at end of file
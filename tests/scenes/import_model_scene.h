@@ -2,12 +2,15 @@
 
 #include "renderable_scene_base.h"
 #include "tests/scenes/import_model.h"
+#include "tests/scenes/import_model_loader.h"
+#include <memory>
+#include <string>
 
 // Scene for testing model importing functionality
 class import_model_scene : public renderable_scene_base {
 public:
   import_model_scene();
-  virtual ~import_model_scene() = default;
+  virtual ~import_model_scene();
 
   // Disable copy constructor and copy assignment
   import_model_scene(const import_model_scene &) = delete;
@@ -15,9 +18,28 @@ public:
 
   // Scene interface
   void init(GLFWwindow *_window) override;
+  void update(float _delta_time) override;
   void render() override;
   void render_ui() override;
+  // Hover picking runs on the meshes' bvh instead of the object ID buffer
+  bool pick_object(float _clip_x, float _clip_y, int &_object_id) override;
+  void on_object_hovered(int _object_id) override;
 
 private:
+  // Drop the current model and import it again
+  void start_import();
+
   import_model m_import_model;
+
+  // Background import; finished meshes are uploaded within a byte budget
+  // per frame so the UI keeps running while a large model loads.
+  std::unique_ptr<import_model_loader> m_loader;
+  int m_upload_budget_kb = 4096;
+  // Applied on the next (re)load
+  import_options m_import_options = {true, 3, 0.5f, 0.05f, true};
+  // Shader for models with import_vertex_format::k_packed
+  shader *m_packed_shader = nullptr;
+  int m_hovered_mesh = -1;
+  std::string m_load_error;
+  std::string m_load_summary;
 };
\ No newline at end of file
@@ -33,6 +33,14 @@ void instance_scene::init(GLFWwindow *window) {
       std::make_unique<instance_uniform_pass_value_scene>(this));
   m_sub_scenes.add_sub_scene(
       std::make_unique<instance_attrib_pass_value_scene>(this));
+  m_sub_scenes.add_sub_scene(
+      std::make_unique<instance_recorded_draw_scene>(this));
+  m_sub_scenes.add_sub_scene(std::make_unique<instance_renderer_scene>(this));
+}
+
+void instance_scene::update(float _delta_time) {
+  renderable_scene_base::update(_delta_time);
+  m_sub_scenes.update(_delta_time);
 }
 
 void instance_scene::render() { m_sub_scenes.render(); }
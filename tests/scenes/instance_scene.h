@@ -6,16 +6,21 @@
 
 class instance_uniform_pass_value_scene;
 class instance_attrib_pass_value_scene;
+class instance_recorded_draw_scene;
+class instance_renderer_scene;
 
 class instance_scene : public renderable_scene_base {
   friend class instance_uniform_pass_value_scene;
   friend class instance_attrib_pass_value_scene;
+  friend class instance_recorded_draw_scene;
+  friend class instance_renderer_scene;
 
 public:
   instance_scene();
   virtual ~instance_scene() = default;
 
   void init(GLFWwindow *window) override;
+  void update(float _delta_time) override;
   void render() override;
   void render_ui() override;
 
@@ -1,10 +1,15 @@
 #include "instance_sub_scenes.h"
 #include "instance_scene.h"
 
+#include "basic/render_state.h"
 #include "glad/gl.h"
 #include "imgui.h"
 #include "tests/component/mesh_manager.h"
 #include "tests/component/prefab_cube.h"
+#include "tests/component/thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <glm/gtc/matrix_transform.hpp>
 
 instance_uniform_pass_value_scene::instance_uniform_pass_value_scene(
@@ -40,8 +45,7 @@ void instance_uniform_pass_value_scene::render() {
                          glm::scale(glm::mat4(1.0f), glm::vec3(0.1f)));
   m_shader->use();
   for (int i = 0; i < m_parent->m_row * m_parent->m_col; i++) {
-    m_shader->set_uniform(("uTranslations[" + std::to_string(i) + "]").c_str(),
-                          translations[i]);
+    m_shader->set_uniform_element("uTranslations"_uniform, i, translations[i]);
   }
   m_parent->m_mesh.bind();
   glDrawElementsInstanced(GL_TRIANGLES, m_parent->m_mesh.get_index_count(),
@@ -58,15 +62,15 @@ instance_attrib_pass_value_scene::instance_attrib_pass_value_scene(
 
   m_parent->m_mesh.bind();
   glGenBuffers(1, &m_instanceVBO);
-  glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(m_translations), m_translations,
-               GL_STATIC_DRAW);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  render_state::instance().bind_buffer(GL_ARRAY_BUFFER, m_instanceVBO);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(m_translations), nullptr,
+               GL_DYNAMIC_DRAW);
+  render_state::instance().bind_buffer(GL_ARRAY_BUFFER, 0);
 
   glEnableVertexAttribArray(2);
-  glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+  render_state::instance().bind_buffer(GL_ARRAY_BUFFER, m_instanceVBO);
   glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  render_state::instance().bind_buffer(GL_ARRAY_BUFFER, 0);
   glVertexAttribDivisor(2, 1);
 };
 
@@ -80,20 +84,26 @@ void instance_attrib_pass_value_scene::render() {
     return;
   }
 
-  int index = 0;
-  float offset = 0.1f;
-  for (int y = -m_parent->m_col; y < m_parent->m_col; y += 2) {
-    for (int x = -m_parent->m_row; x < m_parent->m_row; x += 2) {
-      glm::vec2 translation;
-      translation.x = x / (m_parent->m_row * 1.0f) * 5 + offset;
-      translation.y = y / (m_parent->m_col * 1.0f) * 5 + offset;
-      m_translations[index++] = translation;
+  // The translations only depend on the grid size, so they are uploaded
+  // when it changes instead of every frame
+  if (m_uploaded_row != m_parent->m_row || m_uploaded_col != m_parent->m_col) {
+    int index = 0;
+    float offset = 0.1f;
+    for (int y = -m_parent->m_col; y < m_parent->m_col; y += 2) {
+      for (int x = -m_parent->m_row; x < m_parent->m_row; x += 2) {
+        glm::vec2 translation;
+        translation.x = x / (m_parent->m_row * 1.0f) * 5 + offset;
+        translation.y = y / (m_parent->m_col * 1.0f) * 5 + offset;
+        m_translations[index++] = translation;
+      }
     }
+    render_state::instance().bind_buffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, index * sizeof(glm::vec2),
+                    m_translations);
+    render_state::instance().bind_buffer(GL_ARRAY_BUFFER, 0);
+    m_uploaded_row = m_parent->m_row;
+    m_uploaded_col = m_parent->m_col;
   }
-  glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(m_translations), m_translations,
-               GL_STATIC_DRAW);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
 
   m_parent->set_matrices(m_shader,
                          glm::scale(glm::mat4(1.0f), glm::vec3(0.1f)));
@@ -102,4 +112,190 @@ void instance_attrib_pass_value_scene::render() {
   glDrawElementsInstanced(GL_TRIANGLES, m_parent->m_mesh.get_index_count(),
                           GL_UNSIGNED_INT, 0,
                           m_parent->m_row * m_parent->m_col);
-}
\ No newline at end of file
+}
+
+instance_recorded_draw_scene::instance_recorded_draw_scene(
+    instance_scene *_parent)
+    : sub_scene<instance_scene>(_parent, "Recorded Draws") {
+
+  m_shader = new shader("shaders/instance_test/vertex_recorded.shader",
+                        "shaders/instance_test/fragment_recorded.shader");
+}
+
+instance_recorded_draw_scene::~instance_recorded_draw_scene() {
+  delete m_shader;
+}
+
+void instance_recorded_draw_scene::init() {
+  if (m_cube.get_index_count() == 0) {
+    prefab_cube::cube_mesh_data cube_data(
+        prefab_cube::vertex_format::position_normal);
+    m_cube.setup_mesh(*cube_data.mesh);
+  }
+  layout_cubes();
+}
+
+void instance_recorded_draw_scene::layout_cubes() {
+  const float spacing = 0.5f;
+  const float half_extent = 0.5f * spacing * static_cast<float>(m_side - 1);
+  m_cubes.resize(static_cast<size_t>(m_side) * m_side);
+  for (int y = 0; y < m_side; y++) {
+    for (int x = 0; x < m_side; x++) {
+      const size_t index = static_cast<size_t>(y) * m_side + x;
+      const float u = static_cast<float>(x) / std::max(m_side - 1, 1);
+      const float v = static_cast<float>(y) / std::max(m_side - 1, 1);
+      cube_state &cube = m_cubes[index];
+      cube.position = glm::vec3(x * spacing - half_extent,
+                                y * spacing - half_extent, -10.0f);
+      cube.axis = glm::normalize(glm::vec3(u - 0.5f, v - 0.5f, 1.0f));
+      cube.color = glm::vec3(u, v, 1.0f - 0.5f * (u + v));
+      cube.angle = 0.0f;
+      cube.speed = 0.5f + 1.5f * std::fmod(index * 0.618034f, 1.0f);
+    }
+  }
+}
+
+void instance_recorded_draw_scene::update(float _delta_time) {
+  const auto animate = [&](size_t _index) {
+    cube_state &cube = m_cubes[_index];
+    cube.angle = std::fmod(cube.angle + cube.speed * _delta_time, 6.2831853f);
+  };
+  if (m_parallel) {
+    thread_pool::instance().parallel_for(m_cubes.size(), animate, 1024);
+  } else {
+    for (size_t i = 0; i < m_cubes.size(); i++) {
+      animate(i);
+    }
+  }
+}
+
+void instance_recorded_draw_scene::record_cube(size_t _index,
+                                               render_queue &_queue) const {
+  const cube_state &cube = m_cubes[_index];
+  glm::mat4 model = glm::translate(glm::mat4(1.0f), cube.position);
+  model = glm::rotate(model, cube.angle, cube.axis);
+  model = glm::scale(model, glm::vec3(0.3f));
+  if (!frustum(m_view_projection * model).intersects(m_cube.get_bounds())) {
+    return;
+  }
+
+  draw_packet packet;
+  packet.program = m_shader;
+  packet.mesh = &m_cube;
+  packet.model = model;
+  _queue.submit(packet);
+  _queue.add_uniform("uObjectColor"_uniform, cube.color);
+}
+
+void instance_recorded_draw_scene::render() {
+  if (!m_shader) {
+    return;
+  }
+  if (m_cubes.size() != static_cast<size_t>(m_side) * m_side) {
+    layout_cubes();
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const camera &view_camera = m_parent->m_camera;
+  m_view_projection = view_camera.ProjectionMatrix * view_camera.ViewMatrix;
+  m_queue.begin(view_camera);
+  if (m_parallel) {
+    m_recorder.record(m_queue, m_cubes.size(),
+                      [this](size_t _index, render_queue &_queue) {
+                        record_cube(_index, _queue);
+                      });
+  } else {
+    for (size_t i = 0; i < m_cubes.size(); i++) {
+      record_cube(i, m_queue);
+    }
+  }
+  m_visible_count = m_queue.size();
+  m_record_milliseconds = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+
+  m_queue.execute();
+}
+
+void instance_recorded_draw_scene::render_ui() {
+  ImGui::SliderInt("Cubes per side", &m_side, 1, 160);
+  ImGui::Checkbox("Record on worker threads", &m_parallel);
+  ImGui::Text("%zu of %zu cubes visible", m_visible_count, m_cubes.size());
+  ImGui::Text("Recorded in %.2f ms (%zu chunks)", m_record_milliseconds,
+              m_parallel ? m_recorder.get_chunk_count() : size_t(1));
+}
+
+namespace {
+
+// Materials of instance_renderer_scene: ambient, diffuse, specular strength
+// and shininess
+const glm::vec4 k_instance_materials[instance_field::k_material_count] = {
+    {0.25f, 0.75f, 0.0f, 1.0f},
+    {0.15f, 0.7f, 0.4f, 16.0f},
+    {0.1f, 0.6f, 0.9f, 64.0f},
+    {0.4f, 0.4f, 0.2f, 4.0f},
+};
+
+} // namespace
+
+instance_renderer_scene::instance_renderer_scene(instance_scene *_parent)
+    : sub_scene<instance_scene>(_parent, "Instanced Renderer") {
+
+  m_shader = new shader("shaders/instance_test/vertex_instanced.shader",
+                        "shaders/instance_test/fragment_instanced.shader");
+}
+
+instance_renderer_scene::~instance_renderer_scene() { delete m_shader; }
+
+void instance_renderer_scene::init() {
+  if (m_cube.get_index_count() == 0) {
+    prefab_cube::cube_mesh_data cube_data(
+        prefab_cube::vertex_format::position_normal);
+    m_cube.setup_mesh(*cube_data.mesh);
+  }
+}
+
+void instance_renderer_scene::update(float _delta_time) {
+  m_time += _delta_time;
+}
+
+void instance_renderer_scene::render() {
+  if (!m_shader) {
+    return;
+  }
+  const auto count = static_cast<size_t>(m_instance_count);
+  if (m_field.size() != count) {
+    m_field.layout(count, 0.25f, glm::vec3(0.0f, 0.0f, -15.0f));
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  instance_data *instances = m_renderer.map(m_field.size());
+  if (!instances) {
+    return;
+  }
+  m_field.write(m_time, instances,
+                m_parallel ? &thread_pool::instance() : nullptr);
+  m_write_milliseconds = std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+  m_shader->use();
+  for (unsigned i = 0; i < instance_field::k_material_count; i++) {
+    m_shader->set_uniform_element("uMaterials"_uniform, i,
+                                  k_instance_materials[i]);
+  }
+  m_renderer.draw(m_cube);
+}
+
+void instance_renderer_scene::render_ui() {
+  ImGui::SliderInt("Instances", &m_instance_count, 1000, 250000);
+  ImGui::Checkbox("Write on worker threads", &m_parallel);
+  const double per_millisecond =
+      m_write_milliseconds > 0.0
+          ? static_cast<double>(m_field.size()) / m_write_milliseconds
+          : 0.0;
+  ImGui::Text("Wrote %zu instances in %.2f ms (%.0f per ms)", m_field.size(),
+              m_write_milliseconds, per_millisecond);
+  ImGui::Text("Ring: %zu instances per region, %zu waits for the GPU",
+              m_renderer.get_capacity(), m_renderer.get_wait_count());
+}
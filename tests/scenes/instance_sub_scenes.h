@@ -1,12 +1,17 @@
 #pragma once
 
 #include "basic/shader.h"
+#include "tests/component/instance_field.h"
+#include "tests/component/instanced_renderer.h"
 #include "tests/component/mesh_manager.h"
+#include "tests/component/parallel_recorder.h"
+#include "tests/component/render_queue.h"
 #include "tests/component/sub_scene.h"
 #include "tests/scenes/instance_scene.h"
 #include <glm/glm.hpp>
 #include <memory>
 #include <string>
+#include <vector>
 
 // Forward declaration
 class instance_scene;
@@ -38,4 +43,79 @@ private:
   shader *m_shader = nullptr;
   unsigned int m_instanceVBO;
   glm::vec2 m_translations[100];
-};
\ No newline at end of file
+  // Grid the translations were last uploaded for
+  int m_uploaded_row = 0;
+  int m_uploaded_col = 0;
+};
+
+/**
+ * @brief Sub-scene: a grid of spinning cubes drawn one by one
+ *
+ * Each frame the cubes are animated, culled and recorded into a render_queue
+ * on the thread pool, then drawn on the GL thread. Shows how far the CPU side
+ * of per-object drawing scales with parallel_recorder.
+ */
+class instance_recorded_draw_scene : public sub_scene<instance_scene> {
+public:
+  instance_recorded_draw_scene(instance_scene *_parent);
+  ~instance_recorded_draw_scene() override;
+
+  void init() override;
+  void update(float _delta_time) override;
+  void render() override;
+  void render_ui() override;
+
+private:
+  struct cube_state {
+    glm::vec3 position;
+    glm::vec3 axis;
+    glm::vec3 color;
+    float angle;
+    float speed;
+  };
+
+  // Lay out m_side * m_side cubes
+  void layout_cubes();
+
+  // Cull cube _index and record it into _queue if it may be visible
+  void record_cube(size_t _index, render_queue &_queue) const;
+
+  shader *m_shader = nullptr;
+  mesh_manager m_cube;
+  std::vector<cube_state> m_cubes;
+  render_queue m_queue;
+  parallel_recorder m_recorder;
+  glm::mat4 m_view_projection = glm::mat4(1.0f);
+  int m_side = 64;
+  bool m_parallel = true;
+  size_t m_visible_count = 0;
+  double m_record_milliseconds = 0.0;
+};
+
+/**
+ * @brief Sub-scene: a field of cubes drawn with instanced_renderer
+ *
+ * Every cube has its own model matrix, color and material. The instances are
+ * written on the thread pool straight into the renderer's ring buffer and
+ * drawn with one glDrawElementsInstanced call.
+ */
+class instance_renderer_scene : public sub_scene<instance_scene> {
+public:
+  instance_renderer_scene(instance_scene *_parent);
+  ~instance_renderer_scene() override;
+
+  void init() override;
+  void update(float _delta_time) override;
+  void render() override;
+  void render_ui() override;
+
+private:
+  shader *m_shader = nullptr;
+  mesh_manager m_cube;
+  instance_field m_field;
+  instanced_renderer m_renderer;
+  int m_instance_count = 100000;
+  bool m_parallel = true;
+  float m_time = 0.0f;
+  double m_write_milliseconds = 0.0;
+};
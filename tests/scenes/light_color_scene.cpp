@@ -44,7 +44,6 @@ void light_color_scene::render() {
   m_shader->set_uniform("uAmbientStrength", m_ambient_strength);
   m_shader->set_uniform("uLightPosition", m_light_position);
   m_shader->set_uniform("uSpecularStrength", m_specular_strength);
-  m_shader->set_uniform("uEyePosition", m_camera.Position);
   m_shader->set_uniform("uShininess", m_shininess);
   m_mesh.draw();
 
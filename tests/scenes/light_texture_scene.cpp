@@ -45,9 +45,8 @@ void light_texture_scene::render() {
 
   // Set matrices and render object
   set_matrices(m_shader);
-  uniform(*m_shader, m_light, "uLight");
+  upload_lights(&m_light, 1);
   uniform(*m_shader, m_texture_material, "uMaterial");
-  m_shader->set_uniform("uEyePosition", m_camera.Position);
   m_mesh.draw();
 
   // Render light source using helper
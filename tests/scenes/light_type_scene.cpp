@@ -39,9 +39,8 @@ void light_type_scene::render() {
 
   // Set matrices and render object
   set_matrices(m_shader);
-  uniform(*m_shader, m_light, "uLight");
-  uniform(*m_shader, m_material, "uMaterial");
-  m_shader->set_uniform("uEyePosition", m_camera.Position);
+  upload_lights(&m_light, 1);
+  upload_material(m_material);
   m_mesh.draw();
 
   // Render light source using helper
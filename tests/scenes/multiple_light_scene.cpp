@@ -45,12 +45,8 @@ void multiple_light_scene::render() {
 
   // Set matrices and render object
   set_matrices(m_shader);
-  for (int i = 0; i < 4; i++) {
-    std::string light_name = "uLight[" + std::to_string(i) + "]";
-    uniform(*m_shader, m_lights[i], light_name);
-  }
-  uniform(*m_shader, m_material, "uMaterial");
-  m_shader->set_uniform("uEyePosition", m_camera.Position);
+  upload_lights(m_lights, 4);
+  upload_material(m_material);
   m_mesh.draw();
 
   // Render light source using helper
@@ -209,9 +209,8 @@ void occt_demo_scene::render() {
 
   m_shader->use();
   set_matrices(m_shader);
-  uniform(*m_shader, m_light, "uLight");
-  uniform(*m_shader, m_material, "uMaterial");
-  m_shader->set_uniform("uEyePosition", m_camera.Position);
+  upload_lights(&m_light, 1);
+  upload_material(m_material);
   m_mesh.draw();
 }
 
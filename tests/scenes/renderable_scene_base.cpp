@@ -22,12 +22,41 @@ void renderable_scene_base::set_matrices(shader *_shader,
   }
   _shader->use();
   _shader->set_uniform("model", model);
-  _shader->set_uniform("view", m_camera.ViewMatrix);
-  _shader->set_uniform("projection", m_camera.ProjectionMatrix);
+}
+
+void renderable_scene_base::upload_lights(const light *_lights,
+                                          size_t _count) {
+  if (!m_light_block) {
+    m_light_block = std::make_unique<uniform_buffer<light_block>>(
+        uniform_block_binding::k_lights);
+  }
+  light_block block;
+  write_block(_lights, _count, block);
+  m_light_block->set(0, block);
+  m_light_block->upload();
+  m_light_block->bind();
+}
+
+void renderable_scene_base::upload_material(const material &_material) {
+  if (!m_material_block) {
+    m_material_block = std::make_unique<uniform_buffer<material_block>>(
+        uniform_block_binding::k_material);
+  }
+  material_block block;
+  write_block(_material, block);
+  m_material_block->set(0, block);
+  m_material_block->upload();
+  m_material_block->bind();
+}
+
+bool renderable_scene_base::is_visible(const glm::mat4 &model) const {
+  const frustum view_frustum(m_camera.ProjectionMatrix * m_camera.ViewMatrix *
+                             model);
+  return view_frustum.intersects(m_mesh.get_bounds());
 }
 
 void renderable_scene_base::render_mesh() {
-  if (m_shader) {
+  if (m_shader && is_visible()) {
     set_matrices(m_shader);
     m_mesh.draw();
   }
@@ -42,6 +71,9 @@ void renderable_scene_base::render_light_source(shader *_light_shader,
   glm::mat4 light_model = glm::mat4(1.0f);
   light_model = glm::translate(light_model, position);
   light_model = glm::scale(light_model, scale);
+  if (!is_visible(light_model)) {
+    return;
+  }
   set_matrices(_light_shader, light_model);
   m_mesh.draw();
 }
@@ -1,9 +1,13 @@
 #pragma once
 
+#include "basic/light.h"
+#include "basic/material.h"
 #include "basic/shader.h"
 #include "camera_scene_base.h"
 #include "tests/component/mesh_manager.h"
+#include <cstddef>
 #include <glm/glm.hpp>
+#include <memory>
 
 // Base class for scenes that render objects with model/view/projection matrices
 class renderable_scene_base : public camera_scene_base {
@@ -15,10 +19,21 @@ protected:
   // Setup mesh with vertex and index data
   void setup_mesh(const mesh_data &data);
 
-  // Set model/view/projection matrices for rendering
+  // Use _shader and set its model matrix; view and projection come from the
+  // camera block
   void set_matrices(shader *_shader, const glm::mat4 &model = glm::mat4(1.0f));
 
-  // Render mesh
+  // Upload lights to the light block and bind it. Call once per frame; the
+  // buffer is created on first use.
+  void upload_lights(const light *_lights, size_t _count);
+
+  // Upload a material to the material block and bind it
+  void upload_material(const material &_material);
+
+  // Whether m_mesh drawn with model can be on screen
+  bool is_visible(const glm::mat4 &model = glm::mat4(1.0f)) const;
+
+  // Render mesh, unless it is outside the view frustum
   void render_mesh();
 
   // Render light source at position with scale
@@ -29,4 +44,8 @@ protected:
   mesh_manager m_mesh;
   shader *m_shader = nullptr;
   shader *m_light_shader = nullptr;
+
+private:
+  std::unique_ptr<uniform_buffer<light_block>> m_light_block;
+  std::unique_ptr<uniform_buffer<material_block>> m_material_block;
 };
@@ -1,5 +1,6 @@
 #include "reveal_chess_scene.h"
 
+#include "basic/render_state.h"
 #include "glad/gl.h"
 #include "glm/fwd.hpp"
 #include "imgui.h"
@@ -660,20 +661,20 @@ void reveal_chess_scene::draw_valid_moves() {
 
   // Pass 1: large circle — write only to object_id; no color, no depth
   glColorMaski(0, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-  glDepthMask(GL_FALSE);
+  render_state::instance().depth_mask(false);
   m_valid_move_shader->set_uniform("u_radius", k_hit_radius);
   m_valid_move_shader->set_uniform("u_fill_color", k_board_bg);
   glDrawArrays(GL_POINTS, 0, m_valid_move_mesh_manager.get_index_count());
-  glDepthMask(GL_TRUE);
+  render_state::instance().depth_mask(true);
   glColorMaski(0, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 
   // Pass 2: small green circle — write color and object_id
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  render_state::instance().enable(GL_BLEND);
+  render_state::instance().blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   m_valid_move_shader->set_uniform("u_radius", k_display_radius);
   m_valid_move_shader->set_uniform("u_fill_color", k_hint_color);
   glDrawArrays(GL_POINTS, 0, m_valid_move_mesh_manager.get_index_count());
-  glDisable(GL_BLEND);
+  render_state::instance().disable(GL_BLEND);
 }
 
 void reveal_chess_scene::render() {
@@ -987,10 +988,10 @@ void reveal_chess_scene::draw_last_move() {
 
   m_last_move_shader->use();
   m_last_move_mesh_manager.bind();
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  render_state::instance().enable(GL_BLEND);
+  render_state::instance().blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   m_last_move_shader->set_uniform(
       "u_color", glm::vec4(0.95f, 0.85f, 0.45f, 0.75f)); // warm yellow bracket
   glDrawArrays(GL_POINTS, 0, m_last_move_mesh_manager.get_index_count());
-  glDisable(GL_BLEND);
+  render_state::instance().disable(GL_BLEND);
 }
\ No newline at end of file
@@ -17,6 +17,10 @@ public:
   // Update the scene
   virtual void update(float _delta_time) {}
 
+  // Called every frame before render(), e.g. to upload per-frame uniform
+  // blocks
+  virtual void begin_frame() {}
+
   // Render the scene
   virtual void render() = 0;
 
@@ -33,6 +37,12 @@ public:
   }
   virtual void on_framebuffer_resized(int _width, int _height) {}
   virtual void on_object_hovered(int _object_id) {}
+  // Find the object under the cursor, given in clip coordinates, on the CPU.
+  // Returns false to have the object ID attachment read back instead,
+  // which waits for the GPU.
+  virtual bool pick_object(float _clip_x, float _clip_y, int &_object_id) {
+    return false;
+  }
   virtual bool on_mouse_button(int _button, int _action, int _mods) {
     return false;
   }
@@ -0,0 +1,414 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include "soft_body_types.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Uniform-grid spatial hash over soft-body points.
+//
+// Cells are hashed into a fixed power-of-two bucket table. Every point
+// remembers its bucket and its slot inside it, so update() only touches the
+// points that crossed into another bucket since the last call; the table is
+// rebuilt from scratch only when the point count or cell size changes.
+// Different cells may share a bucket, which only adds narrow-phase
+// candidates.
+class soft_body_spatial_hash {
+public:
+  template <typename tView> void update(const tView &_view, float _cell_size) {
+    const size_t count = _view.size();
+    if (count != m_point_bucket.size() || _cell_size != m_cell_size) {
+      rebuild(_view, _cell_size);
+      return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      int bucket = bucket_of(_view.position(static_cast<int>(i)));
+      if (bucket != m_point_bucket[i]) {
+        remove(static_cast<int>(i));
+        insert(static_cast<int>(i), bucket);
+      }
+    }
+  }
+
+  // Call _fn(point_index) once for every point stored in a bucket overlapping
+  // the box [_min, _max]. Boxes wider than 8x8 cells are not expected (a cell
+  // should hold a segment plus its contact reach) and are clamped to that
+  // size.
+  template <typename tFn>
+  void query(glm::vec2 _min, glm::vec2 _max, tFn &&_fn) {
+    if (m_buckets.empty())
+      return;
+    const int x0 = cell_coord(_min.x);
+    const int y0 = cell_coord(_min.y);
+    const int x1 = std::min(cell_coord(_max.x), x0 + 7);
+    const int y1 = std::min(cell_coord(_max.y), y0 + 7);
+    // Cells of one box can share a bucket; stamp each bucket with the query
+    // number so that no point is reported twice.
+    if (++m_query_stamp == 0) {
+      std::fill(m_bucket_stamp.begin(), m_bucket_stamp.end(), 0u);
+      m_query_stamp = 1;
+    }
+    for (int cy = y0; cy <= y1; ++cy)
+      for (int cx = x0; cx <= x1; ++cx) {
+        const size_t bucket = static_cast<size_t>(hash(cx, cy));
+        if (m_bucket_stamp[bucket] == m_query_stamp)
+          continue;
+        m_bucket_stamp[bucket] = m_query_stamp;
+        for (int point : m_buckets[bucket])
+          _fn(point);
+      }
+  }
+
+  float cell_size() const { return m_cell_size; }
+
+private:
+  template <typename tView> void rebuild(const tView &_view, float _cell_size) {
+    const size_t count = _view.size();
+    m_cell_size = _cell_size;
+    size_t table = 64;
+    while (table < count * 2)
+      table <<= 1;
+    m_mask = static_cast<std::uint32_t>(table - 1);
+    m_buckets.assign(table, {});
+    m_bucket_stamp.assign(table, 0u);
+    m_query_stamp = 0;
+    m_point_bucket.assign(count, -1);
+    m_point_slot.assign(count, -1);
+    for (size_t i = 0; i < count; ++i)
+      insert(static_cast<int>(i),
+             bucket_of(_view.position(static_cast<int>(i))));
+  }
+
+  int cell_coord(float _v) const {
+    return static_cast<int>(std::floor(_v / m_cell_size));
+  }
+  int hash(int _cx, int _cy) const {
+    std::uint32_t h = static_cast<std::uint32_t>(_cx) * 73856093u ^
+                      static_cast<std::uint32_t>(_cy) * 19349663u;
+    return static_cast<int>(h & m_mask);
+  }
+  int bucket_of(glm::vec2 _p) const {
+    return hash(cell_coord(_p.x), cell_coord(_p.y));
+  }
+
+  void insert(int _point, int _bucket) {
+    auto &items = m_buckets[static_cast<size_t>(_bucket)];
+    m_point_bucket[static_cast<size_t>(_point)] = _bucket;
+    m_point_slot[static_cast<size_t>(_point)] = static_cast<int>(items.size());
+    items.push_back(_point);
+  }
+
+  void remove(int _point) {
+    auto &items = m_buckets[static_cast<size_t>(
+        m_point_bucket[static_cast<size_t>(_point)])];
+    int slot = m_point_slot[static_cast<size_t>(_point)];
+    int moved = items.back();
+    items[static_cast<size_t>(slot)] = moved;
+    m_point_slot[static_cast<size_t>(moved)] = slot;
+    items.pop_back();
+  }
+
+  float m_cell_size = 0.0f;
+  std::uint32_t m_mask = 0;
+  std::vector<std::vector<int>> m_buckets;
+  std::vector<std::uint32_t> m_bucket_stamp;
+  std::uint32_t m_query_stamp = 0;
+  std::vector<int> m_point_bucket;
+  std::vector<int> m_point_slot;
+};
+
+// Point access over the driver's own point array; _last_points holds the
+// positions from before integration.
+class soft_body_aos_view {
+public:
+  soft_body_aos_view(std::vector<soft_body_point> &_points,
+                     const std::vector<soft_body_point> &_last_points)
+      : m_points(_points), m_last_points(_last_points) {}
+  size_t size() const { return m_points.size(); }
+  glm::vec2 position(int _i) const {
+    return m_points[static_cast<size_t>(_i)].position;
+  }
+  void set_position(int _i, glm::vec2 _p) {
+    m_points[static_cast<size_t>(_i)].position = _p;
+  }
+  glm::vec2 previous_position(int _i) const {
+    return m_last_points[static_cast<size_t>(_i)].position;
+  }
+  float inverse_mass(int _i) const {
+    return m_points[static_cast<size_t>(_i)].inverse_mass;
+  }
+  void add_velocity(int _i, glm::vec2 _v) {
+    m_points[static_cast<size_t>(_i)].velocity += _v;
+  }
+
+private:
+  std::vector<soft_body_point> &m_points;
+  const std::vector<soft_body_point> &m_last_points;
+};
+
+// Point-versus-segment contacts between different bodies (islands) of one
+// driver, using soft_body_spatial_hash as the broad phase.
+//
+// The broad phase collects, per segment, the points of other bodies within a
+// padded box around it. The padding includes a skin of a quarter cell, so the
+// candidate pairs stay valid until some point has moved about half the skin;
+// they are reused by the substeps and the interval re-detects in between, and
+// the hash is only touched again once the bodies have moved that far.
+//
+// detect() runs after integration and records every point that is near a
+// segment of another body. project() then resolves those contacts
+// positionally and is meant to be interleaved with the distance constraint
+// iterations, so the shape constraints cannot push a point back through a
+// segment; detect() can be repeated between iterations as points move. The
+// velocity reconstruction at the end of the step turns the corrections into a
+// bounce.
+//
+// Each contact remembers which side of its segment the point belongs on. A
+// point that moved further than the contact radius in one step can end up on
+// the far side; comparing its side before and after the step catches that
+// and pushes it back the way it came.
+//
+// tView abstracts the point storage: size(), position(i), set_position(i, p),
+// previous_position(i) and inverse_mass(i).
+class soft_body_collider {
+public:
+  // Collect contacts for the current positions. A _swept pass also tests
+  // every point's path since the start of the step and widens the query by
+  // the largest motion; the crossings it finds are kept until the next swept
+  // pass, while the near contacts are replaced by every call.
+  template <typename tView>
+  void detect(const tView &_view,
+              const std::vector<soft_body_segment> &_segments,
+              const std::vector<int> &_point_body, float _radius,
+              float _cell_size, bool _swept) {
+    m_contacts.clear();
+    if (_swept)
+      m_crossings.clear();
+    m_radius = _radius;
+
+    float max_motion = 0.0f;
+    if (_swept) {
+      for (size_t i = 0; i < _view.size(); ++i) {
+        const glm::vec2 motion = _view.position(static_cast<int>(i)) -
+                                 _view.previous_position(static_cast<int>(i));
+        max_motion = std::max(max_motion, glm::dot(motion, motion));
+      }
+      max_motion = std::min(std::sqrt(max_motion), _cell_size);
+    }
+    // Contacts within twice the radius are kept, since the constraint
+    // iterations may still close the gap.
+    const float reach = 2.0f * _radius;
+    if (!pairs_valid(_view, _segments, _cell_size, reach + max_motion))
+      broad_phase(_view, _segments, _point_body, _cell_size,
+                  reach + max_motion + k_skin * _cell_size);
+
+    for (size_t si = 0; si < _segments.size(); ++si) {
+      const size_t first = m_pair_offsets[si];
+      const size_t last = m_pair_offsets[si + 1];
+      if (first == last)
+        continue;
+      const int a = _segments[si].index1;
+      const int b = _segments[si].index2;
+      const glm::vec2 pa = _view.position(a);
+      const glm::vec2 pb = _view.position(b);
+      const glm::vec2 ab = pb - pa;
+      const float ab2 = glm::dot(ab, ab);
+      if (ab2 < 1e-12f)
+        continue;
+      // Start positions are carried along with the segment's midpoint motion
+      // so that a point and a segment moving towards each other are handled.
+      const glm::vec2 carry =
+          (pa + pb - _view.previous_position(a) - _view.previous_position(b)) *
+          0.5f;
+      // Most candidates are out of reach; reject them with a box test on
+      // the point's path before the exact tests.
+      const glm::vec2 box_min = glm::min(pa, pb) - glm::vec2(reach);
+      const glm::vec2 box_max = glm::max(pa, pb) + glm::vec2(reach);
+      for (size_t k = first; k < last; ++k) {
+        const int p = m_pair_points[k];
+        const glm::vec2 pos = _view.position(p);
+        const glm::vec2 pos0 = _view.previous_position(p) + carry;
+        const glm::vec2 path_min = _swept ? glm::min(pos, pos0) : pos;
+        const glm::vec2 path_max = _swept ? glm::max(pos, pos0) : pos;
+        if (path_max.x < box_min.x || path_min.x > box_max.x ||
+            path_max.y < box_min.y || path_min.y > box_max.y)
+          continue;
+        const glm::vec2 ap = pos - pa;
+        const glm::vec2 ap0 = pos0 - pa;
+        // The side the point started on is where it has to stay.
+        const float side = cross(ab, ap0) < 0.0f ? -1.0f : 1.0f;
+        if (_swept && crossed(ab, ap0, ap)) {
+          m_crossings.push_back({p, a, b, side});
+          continue;
+        }
+        const float t = glm::clamp(glm::dot(ap, ab) / ab2, 0.0f, 1.0f);
+        const glm::vec2 d = ap - ab * t;
+        if (glm::dot(d, d) < reach * reach)
+          m_contacts.push_back({p, a, b, side});
+      }
+    }
+  }
+
+  // Resolve the contacts found by the last detect() against the current
+  // positions. Returns the number of contacts that needed a correction.
+  template <typename tView> size_t project(tView &_view) {
+    return project(_view, m_crossings) + project(_view, m_contacts);
+  }
+
+  void clear() {
+    m_contacts.clear();
+    m_crossings.clear();
+  }
+  // Drop the candidate pairs, e.g. after the segments changed.
+  void reset_pairs() { m_pair_offsets.clear(); }
+  size_t contact_count() const {
+    return m_contacts.size() + m_crossings.size();
+  }
+  size_t pair_count() const { return m_pair_points.size(); }
+  // Broad phase passes run since construction.
+  size_t broad_phase_count() const { return m_broad_phase_count; }
+
+private:
+  // Skin added to the broad phase padding, in cells.
+  static constexpr float k_skin = 0.25f;
+
+  // The pairs cover a query padded by _pad if every point stayed within
+  // half the unused padding of where the broad phase saw it: the point and
+  // the segment box can then each have moved that far.
+  template <typename tView>
+  bool pairs_valid(const tView &_view,
+                   const std::vector<soft_body_segment> &_segments,
+                   float _cell_size, float _pad) const {
+    if (m_pair_offsets.size() != _segments.size() + 1 ||
+        m_pair_positions.size() != _view.size() ||
+        _cell_size != m_hash.cell_size())
+      return false;
+    const float slack = 0.5f * (m_pair_pad - _pad);
+    if (slack <= 0.0f)
+      return false;
+    for (size_t i = 0; i < _view.size(); ++i) {
+      const glm::vec2 moved =
+          _view.position(static_cast<int>(i)) - m_pair_positions[i];
+      if (glm::dot(moved, moved) > slack * slack)
+        return false;
+    }
+    return true;
+  }
+
+  // Collect the points of other bodies in each segment's box padded by _pad.
+  template <typename tView>
+  void broad_phase(const tView &_view,
+                   const std::vector<soft_body_segment> &_segments,
+                   const std::vector<int> &_point_body, float _cell_size,
+                   float _pad) {
+    ++m_broad_phase_count;
+    m_hash.update(_view, _cell_size);
+    m_pair_pad = _pad;
+    m_pair_positions.resize(_view.size());
+    for (size_t i = 0; i < _view.size(); ++i)
+      m_pair_positions[i] = _view.position(static_cast<int>(i));
+    m_pair_points.clear();
+    m_pair_offsets.assign(1, 0);
+    const glm::vec2 pad(_pad);
+    for (const auto &s : _segments) {
+      const int body = _point_body[static_cast<size_t>(s.index1)];
+      const glm::vec2 pa = _view.position(s.index1);
+      const glm::vec2 pb = _view.position(s.index2);
+      m_hash.query(glm::min(pa, pb) - pad, glm::max(pa, pb) + pad, [&](int _p) {
+        if (_point_body[static_cast<size_t>(_p)] != body)
+          m_pair_points.push_back(_p);
+      });
+      m_pair_offsets.push_back(m_pair_points.size());
+    }
+  }
+
+  struct contact {
+    int point;
+    int a;
+    int b;
+    // +1 if the point belongs left of a->b (positive cross product), -1 if
+    // right.
+    float side;
+  };
+
+  template <typename tView>
+  size_t project(tView &_view, const std::vector<contact> &_contacts) {
+    size_t active = 0;
+    for (const auto &c : _contacts) {
+      const glm::vec2 pa = _view.position(c.a);
+      const glm::vec2 pb = _view.position(c.b);
+      const glm::vec2 p = _view.position(c.point);
+      const glm::vec2 ab = pb - pa;
+      const float ab2 = glm::dot(ab, ab);
+      if (ab2 < 1e-12f)
+        continue;
+      const float t = glm::clamp(glm::dot(p - pa, ab) / ab2, 0.0f, 1.0f);
+
+      glm::vec2 n;
+      float depth;
+      if (t > 0.0f && t < 1.0f) {
+        // Over the segment span: signed distance along the contact's side.
+        const float len = std::sqrt(ab2);
+        const float signed_dist = cross(ab, p - pa) / len * c.side;
+        if (signed_dist >= m_radius)
+          continue;
+        n = glm::vec2(-ab.y, ab.x) * (c.side / len);
+        depth = m_radius - signed_dist;
+      } else {
+        const glm::vec2 d = p - (pa + ab * t);
+        const float dist2 = glm::dot(d, d);
+        if (dist2 >= m_radius * m_radius || dist2 < 1e-12f)
+          continue;
+        const float dist = std::sqrt(dist2);
+        n = d / dist;
+        depth = m_radius - dist;
+      }
+
+      // Split the correction between the point and the two segment
+      // endpoints by inverse mass and barycentric weight.
+      const float wp = _view.inverse_mass(c.point);
+      const float wa = _view.inverse_mass(c.a) * (1.0f - t);
+      const float wb = _view.inverse_mass(c.b) * t;
+      const float w = wp + wa * (1.0f - t) + wb * t;
+      if (w <= 0.0f)
+        continue;
+      const float lambda = depth / w;
+      _view.set_position(c.point, p + n * (wp * lambda));
+      _view.set_position(c.a, pa - n * (wa * lambda));
+      _view.set_position(c.b, pb - n * (wb * lambda));
+      ++active;
+    }
+    return active;
+  }
+
+  static float cross(glm::vec2 _a, glm::vec2 _b) {
+    return _a.x * _b.y - _a.y * _b.x;
+  }
+
+  // Swept test in the segment's frame (segment from the origin along _ab):
+  // does the path from _ap0 to _ap pass through the segment?
+  static bool crossed(glm::vec2 _ab, glm::vec2 _ap0, glm::vec2 _ap) {
+    const glm::vec2 motion = _ap - _ap0;
+    const float denom = cross(motion, _ab);
+    if (std::fabs(denom) < 1e-12f)
+      return false;
+    const float u = cross(-_ap0, _ab) / denom;    // along the point's path
+    const float t = cross(-_ap0, motion) / denom; // along the segment
+    return u >= 0.0f && u <= 1.0f && t >= 0.0f && t <= 1.0f;
+  }
+
+  soft_body_spatial_hash m_hash;
+  // Candidate points of segment s are m_pair_points[m_pair_offsets[s]] up to
+  // m_pair_offsets[s + 1], found with padding m_pair_pad around the
+  // positions in m_pair_positions.
+  std::vector<size_t> m_pair_offsets;
+  std::vector<int> m_pair_points;
+  std::vector<glm::vec2> m_pair_positions;
+  float m_pair_pad = 0.0f;
+  size_t m_broad_phase_count = 0;
+  std::vector<contact> m_contacts;
+  std::vector<contact> m_crossings;
+  float m_radius = 0.0f;
+};
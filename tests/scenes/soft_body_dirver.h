@@ -2,79 +2,21 @@
 
 #include "glm/fwd.hpp"
 #include "glm/glm.hpp"
+#include "soft_body_collision.h"
+#include "soft_body_islands.h"
+#include "soft_body_soa_solver.h"
+#include "soft_body_types.h"
+#include <chrono>
 #include <cmath>
 #include <vector>
 
-struct soft_body_point {
-  glm::vec2 position;
-  glm::vec2 velocity;
-  glm::vec2 acceleration;
-};
-
-struct soft_body_segment {
-  int index1;
-  int index2;
-  float length;
-};
-
-struct soft_body_loop {
-  std::vector<int> segment_indices;
-  float area;
-  float rest_area;
-
-  float calc_area(const std::vector<soft_body_point> &_points,
-                  const std::vector<int> &_segment_indices,
-                  const std::vector<soft_body_segment> &_all_segments) const {
-    const size_t n = _points.size();
-    if (n < 3 || _segment_indices.empty())
-      return 0.0f;
-    std::vector<std::vector<int>> adj(n);
-    for (int si : _segment_indices) {
-      if (si < 0 || static_cast<size_t>(si) >= _all_segments.size())
-        continue;
-      const auto &s = _all_segments[static_cast<size_t>(si)];
-      size_t i1 = static_cast<size_t>(s.index1);
-      size_t i2 = static_cast<size_t>(s.index2);
-      if (i1 < n && i2 < n) {
-        adj[i1].push_back(static_cast<int>(s.index2));
-        adj[i2].push_back(static_cast<int>(s.index1));
-      }
-    }
-    int start = -1;
-    for (size_t i = 0; i < n; ++i)
-      if (!adj[i].empty()) {
-        start = static_cast<int>(i);
-        break;
-      }
-    if (start < 0)
-      return 0.0f;
-    std::vector<int> order;
-    order.push_back(start);
-    int prev = start;
-    int cur = adj[static_cast<size_t>(start)][0];
-    while (cur != start && order.size() <= n) {
-      order.push_back(cur);
-      const auto &neighbors = adj[static_cast<size_t>(cur)];
-      int next = prev;
-      for (int v : neighbors)
-        if (v != prev) {
-          next = v;
-          break;
-        }
-      prev = cur;
-      cur = next;
-    }
-    if (order.size() < 3)
-      return 0.0f;
-    float sum = 0.0f;
-    for (size_t i = 0; i < order.size(); ++i) {
-      size_t j = (i + 1) % order.size();
-      const glm::vec2 &a = _points[static_cast<size_t>(order[i])].position;
-      const glm::vec2 &b = _points[static_cast<size_t>(order[j])].position;
-      sum += a.x * b.y - b.x * a.y;
-    }
-    return 0.5f * std::abs(sum);
-  }
+// k_array_of_structs walks m_points/m_segments directly; k_structure_of_arrays
+// keeps the point state in soft_body_soa_solver for SIMD integration and
+// batched constraint projection, and copies it back to m_points only when the
+// points are read.
+enum class soft_body_solver_mode {
+  k_array_of_structs,
+  k_structure_of_arrays,
 };
 
 class soft_body_dirver {
@@ -85,6 +27,10 @@ public:
 
 public:
   void update_point(soft_body_point &_point, float _delta_time) {
+    if (_point.inverse_mass <= 0.0f) {
+      _point.velocity = glm::vec2(0.0f);
+      return;
+    }
     _point.velocity += _point.acceleration * _delta_time;
     _point.velocity *= (1.0f - m_drag * _delta_time);
 
@@ -114,17 +60,19 @@ public:
     _point.position = next_position;
   }
 
+  // Move both endpoints towards the rest length, each by its share of the
+  // inverse mass, like soft_body_soa_solver::project_one.
   void project_segment_length(soft_body_segment &_segment) {
-    glm::vec2 &p1 = get_point(_segment.index1).position;
-    glm::vec2 &p2 = get_point(_segment.index2).position;
-    glm::vec2 center = (p1 + p2) * 0.5f;
-    glm::vec2 edge = p2 - p1;
+    soft_body_point &a = get_point(_segment.index1);
+    soft_body_point &b = get_point(_segment.index2);
+    const float w = a.inverse_mass + b.inverse_mass;
+    glm::vec2 edge = b.position - a.position;
     float len = glm::length(edge);
-    if (len < 1e-6f)
+    if (len < 1e-6f || w <= 0.0f)
       return;
-    glm::vec2 direction = edge / len;
-    p1 = center - direction * _segment.length * 0.5f;
-    p2 = center + direction * _segment.length * 0.5f;
+    const float k = (len - _segment.length) / (len * w);
+    a.position += a.inverse_mass * k * edge;
+    b.position -= b.inverse_mass * k * edge;
   }
 
   void update_segment(soft_body_segment &_segment, float _delta_time) {
@@ -132,43 +80,89 @@ public:
     project_segment_length(_segment);
   }
 
-  void update_loop(soft_body_loop &_loop, float _delta_time) {
-    (void)_delta_time;
-    float new_area =
-        _loop.calc_area(m_points, _loop.segment_indices, m_segments);
+  template <typename tView>
+  void update_loop(soft_body_loop &_loop, tView &_view, float _delta_time) {
+    if (_loop.topology_dirty)
+      _loop.rebuild_topology(_view.size(), m_segments);
+    float new_area = _loop.calc_area(_view);
     float rest = std::max(_loop.rest_area, 1e-6f);
     float area_error = (_loop.rest_area - new_area) / rest;
-    float factor = area_error * m_area_correction_strength;
+    // The correction is a velocity kick per step; scale it so substepping
+    // does not change its strength per second.
+    float factor = area_error * m_area_correction_strength *
+                   (_delta_time / k_area_reference_step);
 
     for (int seg_idx : _loop.segment_indices) {
       if (seg_idx < 0 || static_cast<size_t>(seg_idx) >= m_segments.size())
         continue;
       soft_body_segment &segment = m_segments[static_cast<size_t>(seg_idx)];
-      glm::vec2 edge = get_point(segment.index2).position -
-                       get_point(segment.index1).position;
+      glm::vec2 edge =
+          _view.position(segment.index2) - _view.position(segment.index1);
       float len = glm::length(edge);
       if (len < 1e-6f)
         continue;
       glm::vec2 perpendicular = glm::vec2(-edge.y / len, edge.x / len);
 
-      get_point(segment.index1).velocity += factor * perpendicular;
-      get_point(segment.index2).velocity += factor * perpendicular;
+      _view.add_velocity(segment.index1, factor * perpendicular);
+      _view.add_velocity(segment.index2, factor * perpendicular);
     }
     _loop.area = new_area;
   }
 
+  // With m_fixed_step the frame time goes into an accumulator that is drained
+  // in steps of 1 / m_step_rate, each split into m_substeps substeps of
+  // m_substep_iterations constraint sweeps. Small substeps converge faster
+  // than more sweeps over one large step, so far fewer sweeps per frame give
+  // the same stiffness. Rendering should use get_render_points(), which
+  // blends the last two steps by the leftover time.
   void update(float _delta_time) {
-    m_last_points = m_points;
+    if (!m_fixed_step) {
+      step(_delta_time, m_segment_constraint_iterations);
+      return;
+    }
+    const float step_time = 1.0f / m_step_rate;
+    const int substeps = std::max(m_substeps, 1);
+    // After a frame spike, drop the time we cannot catch up on instead of
+    // spending ever longer frames on it.
+    const int max_steps = std::max(m_max_steps_per_frame, 1);
+    m_accumulator = std::min(m_accumulator + _delta_time,
+                             step_time * static_cast<float>(max_steps));
+    // The tolerance keeps a frame of exactly one step from rounding to zero
+    // steps one frame and two the next.
+    while (m_accumulator >= step_time * 0.999f) {
+      store_previous_positions();
+      for (int i = 0; i < substeps; ++i)
+        step(step_time / static_cast<float>(substeps), m_substep_iterations);
+      m_accumulator -= step_time;
+    }
+    m_accumulator = std::max(m_accumulator, 0.0f);
+    m_interpolation_alpha = m_accumulator / step_time;
+  }
+
+  // Advance the simulation by _delta_time with _iterations constraint sweeps.
+  void step(float _delta_time, int _iterations) {
+    m_sweep_count += static_cast<size_t>(_iterations);
+    if (m_solver_mode == soft_body_solver_mode::k_structure_of_arrays) {
+      update_soa(_delta_time, _iterations);
+      return;
+    }
+    sync_points();
+    soft_body_aos_view loop_view(m_points, m_points);
     for (auto &loop : m_loops) {
-      update_loop(loop, _delta_time);
+      update_loop(loop, loop_view, _delta_time);
     }
+    m_last_points = m_points;
     for (auto &point : m_points) {
       update_point(point, _delta_time);
     }
-    for (int iter = 0; iter < m_segment_constraint_iterations; ++iter) {
+    soft_body_aos_view view(m_points, m_last_points);
+    bool collide = detect_collisions(view);
+    for (int iter = 0; iter < _iterations; ++iter) {
       for (auto &segment : m_segments) {
         project_segment_length(segment);
       }
+      if (collide)
+        project_collisions(view, iter);
     }
     for (size_t i = 0; i < m_points.size(); ++i) {
       glm::vec2 delta = m_points[i].position - m_last_points[i].position;
@@ -176,59 +170,246 @@ public:
       if (glm::length(m_points[i].velocity) < m_velocity_stop_threshold)
         m_points[i].velocity = glm::vec2(0.0f);
     }
+    m_soa_stale = true;
+  }
+
+  void update_soa(float _delta_time, int _iterations) {
+    if (m_soa_batches_dirty) {
+      m_soa_solver.build_batches(m_segments, m_points.size());
+      m_soa_batches_dirty = false;
+    }
+    if (m_soa_stale) {
+      m_soa_solver.gather(m_points);
+      m_soa_stale = false;
+    }
+    auto view = m_soa_solver.points();
+    for (auto &loop : m_loops) {
+      update_loop(loop, view, _delta_time);
+    }
+    m_soa_solver.begin_step();
+    m_soa_solver.integrate(
+        _delta_time, {m_horizontal_bound, m_vertical_bound,
+                      m_boundary_tolerance, m_drag, m_bounce_damping,
+                      m_velocity_stop_threshold});
+    if (detect_collisions(view)) {
+      for (int iter = 0; iter < _iterations; ++iter) {
+        m_soa_solver.project_segments(1);
+        project_collisions(view, iter);
+      }
+    } else {
+      m_soa_solver.project_segments(_iterations);
+    }
+    m_soa_solver.update_velocities(_delta_time, m_velocity_stop_threshold);
+    m_points_stale = true;
+  }
+
+  // Broad phase for contacts between bodies, run after integration. Bodies
+  // are the islands of the segment graph, so a single driver can hold several
+  // independent blobs. Returns true if contacts were found; they are then
+  // resolved after every constraint iteration.
+  template <typename tView>
+  bool detect_collisions(const tView &_view, bool _swept = true) {
+    m_collider.clear();
+    if (!m_body_collision)
+      return false;
+    if (m_islands_dirty) {
+      m_islands.build(m_points.size(), m_segments);
+      m_max_segment_length = 0.0f;
+      for (const auto &segment : m_segments)
+        m_max_segment_length = std::max(m_max_segment_length, segment.length);
+      m_islands_dirty = false;
+      m_collider.reset_pairs();
+    }
+    if (m_islands.island_count < 2)
+      return false;
+    const auto start = std::chrono::steady_clock::now();
+    // A segment plus its contact reach fits in one cell, so a query touches
+    // at most 2x2 cells (3x3 while sweeping).
+    float cell_size = m_max_segment_length + 4.0f * m_collision_radius;
+    m_collider.detect(_view, m_segments, m_islands.point_island,
+                      m_collision_radius, cell_size, _swept);
+    m_collision_seconds += seconds_since(start);
+    return m_collider.contact_count() > 0;
   }
 
-  void add_point(const soft_body_point &_point) { m_points.push_back(_point); }
-  soft_body_point &get_point(int _index) { return m_points[_index]; }
+  // Resolve contacts after constraint iteration _iteration. The constraints
+  // can move points a long way within one step, so the broad phase is
+  // repeated every m_collision_detect_interval iterations.
+  template <typename tView>
+  void project_collisions(tView &_view, int _iteration) {
+    if (m_collision_detect_interval > 0 &&
+        (_iteration + 1) % m_collision_detect_interval == 0)
+      detect_collisions(_view, false);
+    const auto start = std::chrono::steady_clock::now();
+    m_collider.project(_view);
+    m_collision_seconds += seconds_since(start);
+  }
+
+  void add_point(const soft_body_point &_point) {
+    sync_points();
+    m_points.push_back(_point);
+    m_soa_stale = true;
+    m_soa_batches_dirty = true;
+    m_islands_dirty = true;
+  }
+  // The reference may be written through, so the SoA state is regathered
+  // before the next step.
+  soft_body_point &get_point(int _index) {
+    sync_points();
+    m_soa_stale = true;
+    return m_points[_index];
+  }
+  soft_body_loop &get_loop(size_t _index) { return m_loops[_index]; }
   void add_segment(const soft_body_segment &_segment) {
     m_segments.push_back(_segment);
+    m_soa_batches_dirty = true;
+    m_islands_dirty = true;
+    for (auto &loop : m_loops)
+      loop.topology_dirty = true;
   }
   void add_loop(const soft_body_loop &_loop) {
     m_loops.push_back(_loop);
-    if (!m_loops.back().segment_indices.empty()) {
-      float a = m_loops.back().calc_area(
-          m_points, m_loops.back().segment_indices, m_segments);
-      m_loops.back().area = a;
-      m_loops.back().rest_area = a;
+    soft_body_loop &loop = m_loops.back();
+    loop.rebuild_topology(m_points.size(), m_segments);
+    if (!loop.segment_indices.empty()) {
+      sync_points();
+      float a = loop.calc_area(soft_body_aos_view(m_points, m_points));
+      loop.area = a;
+      loop.rest_area = a;
     }
   }
-  const std::vector<soft_body_point> &get_points() const { return m_points; }
+  const std::vector<soft_body_point> &get_points() const {
+    sync_points();
+    return m_points;
+  }
   const std::vector<soft_body_segment> &get_segments() const {
     return m_segments;
   }
   const std::vector<soft_body_loop> &get_loops() const { return m_loops; }
 
+  // Cached walk order of a loop's points; empty if the loop is degenerate or
+  // its topology has not been rebuilt since the last add_segment().
+  const std::vector<int> &get_loop_point_order(size_t _loop_index) const {
+    static const std::vector<int> empty;
+    if (_loop_index >= m_loops.size() || m_loops[_loop_index].topology_dirty)
+      return empty;
+    return m_loops[_loop_index].point_order;
+  }
+
+  // Points with positions blended between the last two fixed steps; the
+  // simulated points themselves when not in fixed-step mode.
+  const std::vector<soft_body_point> &get_render_points() {
+    sync_points();
+    if (!m_fixed_step || m_previous_positions.size() != m_points.size())
+      return m_points;
+    m_render_points = m_points;
+    for (size_t i = 0; i < m_points.size(); ++i)
+      m_render_points[i].position = glm::mix(
+          m_previous_positions[i], m_points[i].position, m_interpolation_alpha);
+    return m_render_points;
+  }
+  float get_interpolation_alpha() const { return m_interpolation_alpha; }
+  // Constraint sweeps over all segments run since construction.
+  size_t get_sweep_count() const { return m_sweep_count; }
+
+  const soft_body_soa_solver &get_soa_solver() const { return m_soa_solver; }
+  size_t body_count() const {
+    return static_cast<size_t>(m_islands.island_count);
+  }
+  size_t contact_count() const { return m_collider.contact_count(); }
+  // Time spent in collision detection and projection since construction.
+  double get_collision_seconds() const { return m_collision_seconds; }
+  size_t get_broad_phase_count() const {
+    return m_collider.broad_phase_count();
+  }
+
   float m_area_correction_strength = 0.4f;
+  bool m_body_collision = true;
+  float m_collision_radius = 0.01f;
+  int m_collision_detect_interval = 4;
+  bool m_fixed_step = true;
+  float m_step_rate = 60.0f;
+  int m_substeps = 8;
+  int m_substep_iterations = 2;
+  int m_max_steps_per_frame = 4;
+  soft_body_solver_mode m_solver_mode =
+      soft_body_solver_mode::k_array_of_structs;
 
   void clear() {
     m_points.clear();
     m_segments.clear();
     m_loops.clear();
     m_last_points.clear();
+    m_previous_positions.clear();
+    m_accumulator = 0.0f;
+    m_points_stale = false;
+    m_soa_stale = true;
+    m_soa_batches_dirty = true;
+    m_islands_dirty = true;
   }
 
   void apply_offset(const glm::vec2 &_offset) {
+    sync_points();
     for (auto &point : m_points) {
       point.position += _offset;
     }
+    m_soa_stale = true;
   }
 
   void apply_velocity(const glm::vec2 &_velocity) {
+    sync_points();
     for (auto &point : m_points) {
       point.velocity += _velocity;
     }
+    m_soa_stale = true;
   }
 
   void apply_acceleration(const glm::vec2 &_acceleration) {
+    sync_points();
     for (auto &point : m_points) {
       point.acceleration += _acceleration;
     }
+    m_soa_stale = true;
   }
 
 protected:
+  // Step length the area correction strength was tuned for.
+  static constexpr float k_area_reference_step = 1.0f / 60.0f;
+
+  // Copy the SoA state back to m_points if an SoA step ran since they were
+  // last read. Const so that get_points() stays const; a driver must still
+  // not be read from several threads while it is stale.
+  void sync_points() const {
+    if (!m_points_stale)
+      return;
+    m_soa_solver.scatter(m_points);
+    m_points_stale = false;
+  }
+
+  static double seconds_since(std::chrono::steady_clock::time_point _start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         _start)
+        .count();
+  }
+
+  // Positions at the start of a fixed step, from whichever copy is current.
+  void store_previous_positions() {
+    if (m_points_stale) {
+      m_soa_solver.copy_positions(m_previous_positions);
+      return;
+    }
+    m_previous_positions.resize(m_points.size());
+    for (size_t i = 0; i < m_points.size(); ++i)
+      m_previous_positions[i] = m_points[i].position;
+  }
+
   glm::vec2 m_horizontal_bound;
   glm::vec2 m_vertical_bound;
-  std::vector<soft_body_point> m_points;
+  // At most one of the two copies is stale: m_points after an SoA step,
+  // the SoA arrays after m_points was written.
+  mutable std::vector<soft_body_point> m_points;
+  mutable bool m_points_stale = false;
+  bool m_soa_stale = true;
   std::vector<soft_body_segment> m_segments;
   std::vector<soft_body_loop> m_loops;
   std::vector<soft_body_point> m_last_points;
@@ -238,4 +419,19 @@ protected:
   float m_bounce_damping = 0.7f;
   float m_velocity_stop_threshold = 0.01f;
   int m_segment_constraint_iterations = 32;
+
+  soft_body_soa_solver m_soa_solver;
+  bool m_soa_batches_dirty = true;
+
+  soft_body_collider m_collider;
+  soft_body_islands m_islands;
+  float m_max_segment_length = 0.0f;
+  bool m_islands_dirty = true;
+  double m_collision_seconds = 0.0;
+
+  float m_accumulator = 0.0f;
+  float m_interpolation_alpha = 1.0f;
+  std::vector<glm::vec2> m_previous_positions;
+  std::vector<soft_body_point> m_render_points;
+  size_t m_sweep_count = 0;
 };
\ No newline at end of file
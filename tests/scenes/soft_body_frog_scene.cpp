@@ -1,5 +1,6 @@
 #include "soft_body_frog_scene.h"
 #include "GLFW/glfw3.h"
+#include "basic/render_state.h"
 #include "glad/gl.h"
 #include "glm/gtc/type_ptr.hpp"
 #include "tests/component/interaction_utils.h"
@@ -75,122 +76,82 @@ void soft_body_frog_scene::init_frog_loop() {
   m_driver.add_loop(loop);
 }
 
-std::vector<int>
-soft_body_frog_scene::get_loop_point_order(size_t _loop_index) const {
-  const auto &loops = m_driver.get_loops();
-  const auto &segments = m_driver.get_segments();
-  if (_loop_index >= loops.size())
-    return {};
-  const auto &loop = loops[_loop_index];
-  size_t np = m_driver.get_points().size();
-  std::vector<std::vector<int>> adj(np);
-  for (int si : loop.segment_indices) {
-    if (si < 0 || static_cast<size_t>(si) >= segments.size())
-      continue;
-    const auto &s = segments[static_cast<size_t>(si)];
-    size_t i1 = static_cast<size_t>(s.index1);
-    size_t i2 = static_cast<size_t>(s.index2);
-    if (i1 < np && i2 < np) {
-      adj[i1].push_back(static_cast<int>(s.index2));
-      adj[i2].push_back(static_cast<int>(s.index1));
-    }
-  }
-  int start = -1;
-  for (size_t i = 0; i < np; i++) {
-    if (!adj[i].empty()) {
-      start = static_cast<int>(i);
-      break;
-    }
-  }
-  if (start < 0)
-    return {};
-  std::vector<int> order;
-  order.push_back(start);
-  int prev = start;
-  int cur = adj[static_cast<size_t>(start)][0];
-  while (cur != start && order.size() <= np) {
-    order.push_back(cur);
-    int next = prev;
-    for (int v : adj[static_cast<size_t>(cur)])
-      if (v != prev) {
-        next = v;
-        break;
-      }
-    prev = cur;
-    cur = next;
-  }
-  return order;
-}
-
 void soft_body_frog_scene::update_mesh_data() {
-  const auto &points = m_driver.get_points();
+  const auto &points = m_driver.get_render_points();
   if (points.empty() || m_driver.get_loops().empty())
     return;
 
-  std::vector<int> order = get_loop_point_order(0);
+  const std::vector<int> &order = m_driver.get_loop_point_order(0);
   if (order.size() < 3)
     return;
 
-  glm::vec2 centroid(0.0f);
-  for (int i : order)
-    centroid += points[static_cast<size_t>(i)].position;
-  centroid /= static_cast<float>(order.size());
+  glm::vec2 centroid = m_driver.get_loops()[0].calc_centroid(points);
 
-  std::vector<glm::vec2> body_verts;
-  body_verts.push_back(centroid);
+  // Scratch buffers are members so their capacity survives across frames.
+  m_body_vertices.clear();
+  m_body_vertices.push_back(centroid);
   for (int i : order)
-    body_verts.push_back(points[static_cast<size_t>(i)].position);
-  body_verts.push_back(points[static_cast<size_t>(order[0])].position);
+    m_body_vertices.push_back(points[static_cast<size_t>(i)].position);
+  m_body_vertices.push_back(points[static_cast<size_t>(order[0])].position);
 
-  mesh_data body_data(body_verts.data(), body_verts.size() * sizeof(glm::vec2),
-                      body_verts.size(),
+  mesh_data body_data(m_body_vertices.data(),
+                      m_body_vertices.size() * sizeof(glm::vec2),
+                      m_body_vertices.size(),
                       {vertex_attribute{2, GL_FLOAT, false}});
-  m_body_mesh.setup_mesh(body_data);
-
-  std::vector<glm::vec2> outline_verts;
-  outline_verts.reserve(order.size());
-  for (int i : order) {
-    outline_verts.push_back(points[static_cast<size_t>(i)].position);
+  m_body_mesh.stream_mesh(body_data);
+
+  // Triangle i of the fan is the centroid, rim vertex i + 1 and i + 2
+  const size_t triangle_count = m_body_vertices.size() - 2;
+  const bool rebuild = m_body_boxes.size() != triangle_count;
+  m_body_boxes.assign(triangle_count, aabb());
+  for (size_t i = 0; i < triangle_count; i++) {
+    m_body_boxes[i].expand(glm::vec3(m_body_vertices[0], 0.0f));
+    m_body_boxes[i].expand(glm::vec3(m_body_vertices[i + 1], 0.0f));
+    m_body_boxes[i].expand(glm::vec3(m_body_vertices[i + 2], 0.0f));
   }
-  std::vector<unsigned int> outline_indices;
-  for (size_t i = 0; i < outline_verts.size(); i++) {
-    outline_indices.push_back(static_cast<unsigned int>(i));
-    outline_indices.push_back(
-        static_cast<unsigned int>((i + 1) % outline_verts.size()));
+  if (rebuild) {
+    m_body_bvh.build(m_body_boxes);
+  } else {
+    m_body_bvh.refit(m_body_boxes);
   }
-  mesh_data outline_data(outline_verts.data(),
-                         outline_verts.size() * sizeof(glm::vec2),
-                         outline_indices.data(), outline_indices.size(),
+
+  // The outline is the body rim without the fan center and closing vertex.
+  const glm::vec2 *outline_vertices = m_body_vertices.data() + 1;
+  const size_t outline_count = order.size();
+  if (m_outline_indices.size() != outline_count * 2) {
+    m_outline_indices.clear();
+    for (size_t i = 0; i < outline_count; i++) {
+      m_outline_indices.push_back(static_cast<unsigned int>(i));
+      m_outline_indices.push_back(
+          static_cast<unsigned int>((i + 1) % outline_count));
+    }
+  }
+  mesh_data outline_data(outline_vertices, outline_count * sizeof(glm::vec2),
+                         m_outline_indices.data(), m_outline_indices.size(),
                          {vertex_attribute{2, GL_FLOAT, false}});
-  m_outline_mesh.setup_mesh(outline_data);
+  m_outline_mesh.stream_mesh(outline_data);
 
   glm::vec2 left_eye = centroid + glm::vec2(-m_eye_offset_x, m_eye_offset_y);
   glm::vec2 right_eye = centroid + glm::vec2(m_eye_offset_x, m_eye_offset_y);
-  std::vector<glm::vec2> eye_centers = {left_eye, right_eye};
-  mesh_data eye_data(eye_centers.data(), eye_centers.size() * sizeof(glm::vec2),
-                     eye_centers.size(),
+  const glm::vec2 eye_centers[] = {left_eye, right_eye};
+  mesh_data eye_data(eye_centers, sizeof(eye_centers), 2,
                      {vertex_attribute{2, GL_FLOAT, false}});
-  m_eye_mesh.setup_mesh(eye_data);
+  m_eye_mesh.stream_mesh(eye_data);
 
   float mx = centroid.x;
   float my = centroid.y - 0.06f;
-  std::vector<glm::vec2> mouth_verts = {
+  const glm::vec2 mouth_verts[] = {
       glm::vec2(mx - m_mouth_scale, my + 0.01f),
       glm::vec2(mx - m_mouth_scale * 0.5f, my - 0.01f),
       glm::vec2(mx, my - 0.015f),
       glm::vec2(mx + m_mouth_scale * 0.5f, my - 0.01f),
       glm::vec2(mx + m_mouth_scale, my + 0.01f),
   };
-  std::vector<unsigned int> mouth_indices;
-  for (size_t i = 0; i + 1 < mouth_verts.size(); i++) {
-    mouth_indices.push_back(static_cast<unsigned int>(i));
-    mouth_indices.push_back(static_cast<unsigned int>(i + 1));
-  }
-  mesh_data mouth_data(mouth_verts.data(),
-                       mouth_verts.size() * sizeof(glm::vec2),
-                       mouth_indices.data(), mouth_indices.size(),
+  static const unsigned int mouth_indices[] = {0, 1, 1, 2, 2, 3, 3, 4};
+  mesh_data mouth_data(mouth_verts, sizeof(mouth_verts), mouth_indices,
+                       sizeof(mouth_indices) / sizeof(mouth_indices[0]),
                        {vertex_attribute{2, GL_FLOAT, false}});
-  m_mouth_mesh.setup_mesh(mouth_data);
+  m_mouth_mesh.stream_mesh(mouth_data);
 }
 
 void soft_body_frog_scene::render() {
@@ -201,13 +162,12 @@ void soft_body_frog_scene::render() {
 
   GLboolean depth_enabled = glIsEnabled(GL_DEPTH_TEST);
   if (depth_enabled)
-    glDisable(GL_DEPTH_TEST);
+    render_state::instance().disable(GL_DEPTH_TEST);
 
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  render_state::instance().enable(GL_BLEND);
+  render_state::instance().blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-  std::vector<int> order = get_loop_point_order(0);
-  if (order.size() < 3)
+  if (m_driver.get_loop_point_order(0).size() < 3)
     return;
 
   m_body_shader->use();
@@ -250,10 +210,10 @@ void soft_body_frog_scene::render() {
   m_mouth_mesh.bind();
   glDrawElements(GL_LINES, m_mouth_mesh.get_index_count(), GL_UNSIGNED_INT, 0);
 
-  glDisable(GL_BLEND);
+  render_state::instance().disable(GL_BLEND);
 
   if (depth_enabled)
-    glEnable(GL_DEPTH_TEST);
+    render_state::instance().enable(GL_DEPTH_TEST);
 }
 
 void soft_body_frog_scene::render_ui() {
@@ -264,6 +224,27 @@ void soft_body_frog_scene::render_ui() {
   ImGui::SliderFloat("Outline width", &m_outline_width, 0.002f, 0.02f);
   ImGui::SliderFloat("Area strength", &m_driver.m_area_correction_strength,
                      0.0f, 1.0f);
+  int solver_mode = static_cast<int>(m_driver.m_solver_mode);
+  if (ImGui::Combo("Solver", &solver_mode,
+                   "Array of structs\0Structure of arrays (SIMD)\0")) {
+    m_driver.m_solver_mode = static_cast<soft_body_solver_mode>(solver_mode);
+  }
+  if (m_driver.m_solver_mode == soft_body_solver_mode::k_structure_of_arrays) {
+    ImGui::Text("Segment batches: %zu (serial: %zu)",
+                m_driver.get_soa_solver().color_count(),
+                m_driver.get_soa_solver().serial_segment_count());
+  }
+  ImGui::Checkbox("Fixed step", &m_driver.m_fixed_step);
+  if (m_driver.m_fixed_step) {
+    ImGui::SliderInt("Substeps", &m_driver.m_substeps, 1, 16);
+    ImGui::SliderInt("Iterations per substep", &m_driver.m_substep_iterations,
+                     1, 32);
+  }
+  ImGui::Checkbox("Body collision", &m_driver.m_body_collision);
+  ImGui::SliderFloat("Collision radius", &m_driver.m_collision_radius, 0.002f,
+                     0.05f);
+  ImGui::Text("Bodies: %zu, contacts: %zu", m_driver.body_count(),
+              m_driver.contact_count());
 }
 
 void soft_body_frog_scene::update(float _delta_time) {
@@ -288,6 +269,25 @@ void soft_body_frog_scene::on_object_hovered(int _object_id) {
   }
 }
 
+bool soft_body_frog_scene::pick_object(float _clip_x, float _clip_y,
+                                       int &_object_id) {
+  const bvh_ray ray = make_pick_ray(m_camera, _clip_x, _clip_y);
+  float t = 0.0f;
+  size_t triangle = 0;
+  const bool hit = m_body_bvh.raycast(
+      ray,
+      [&](size_t _triangle, float) {
+        return intersect_ray_triangle(
+            ray, glm::vec3(m_body_vertices[0], 0.0f),
+            glm::vec3(m_body_vertices[_triangle + 1], 0.0f),
+            glm::vec3(m_body_vertices[_triangle + 2], 0.0f));
+      },
+      t, triangle);
+  // Same ID the body writes to the object ID buffer
+  _object_id = hit ? 1 : -1;
+  return true;
+}
+
 bool soft_body_frog_scene::on_mouse_button(int _button, int _action,
                                            int _mods) {
   (void)_mods;
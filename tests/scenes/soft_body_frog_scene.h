@@ -3,6 +3,7 @@
 #include "basic/shader.h"
 #include "renderable_scene_base.h"
 #include "soft_body_dirver.h"
+#include "tests/component/bvh.h"
 #include "tests/component/mesh_manager.h"
 #include <glm/glm.hpp>
 #include <vector>
@@ -20,9 +21,9 @@ public:
 
 private:
   void init_frog_loop();
-  std::vector<int> get_loop_point_order(size_t _loop_index) const;
   void update_mesh_data();
   void on_object_hovered(int _object_id) override;
+  bool pick_object(float _clip_x, float _clip_y, int &_object_id) override;
   bool on_mouse_button(int _button, int _action, int _mods) override;
 
   soft_body_dirver m_driver;
@@ -30,6 +31,13 @@ private:
   mesh_manager m_outline_mesh;
   mesh_manager m_eye_mesh;
   mesh_manager m_mouth_mesh;
+  std::vector<glm::vec2> m_body_vertices;
+  std::vector<unsigned int> m_outline_indices;
+  // Boxes of the body's fan triangles and a bvh over them, refit as the
+  // body moves and rebuilt when its point count changes. Hover picking uses
+  // it instead of reading the object ID buffer.
+  std::vector<aabb> m_body_boxes;
+  bvh m_body_bvh;
 
   bool m_hovered_object = false;
   glm::vec2 m_mouse_position = glm::vec2(0.0f);
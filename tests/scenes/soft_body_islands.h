@@ -0,0 +1,52 @@
+#pragma once
+
+#include "soft_body_types.h"
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+// Connected components of the point/segment graph. Points that share no
+// segment (directly or transitively) end up on different islands, so they
+// can be simulated independently.
+struct soft_body_islands {
+  // Island label per point, in [0, island_count).
+  std::vector<int> point_island;
+  int island_count = 0;
+
+  void build(size_t _point_count,
+             const std::vector<soft_body_segment> &_segments) {
+    std::vector<int> parent(_point_count);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](int _i) {
+      while (parent[static_cast<size_t>(_i)] != _i) {
+        // Path halving keeps the trees flat without recursion.
+        parent[static_cast<size_t>(_i)] =
+            parent[static_cast<size_t>(parent[static_cast<size_t>(_i)])];
+        _i = parent[static_cast<size_t>(_i)];
+      }
+      return _i;
+    };
+    for (const auto &s : _segments) {
+      if (s.index1 < 0 || s.index2 < 0 ||
+          static_cast<size_t>(s.index1) >= _point_count ||
+          static_cast<size_t>(s.index2) >= _point_count)
+        continue;
+      int a = find(s.index1);
+      int b = find(s.index2);
+      if (a != b)
+        parent[static_cast<size_t>(std::max(a, b))] = std::min(a, b);
+    }
+
+    // Relabel roots densely in order of first appearance.
+    point_island.assign(_point_count, -1);
+    std::vector<int> root_label(_point_count, -1);
+    island_count = 0;
+    for (size_t i = 0; i < _point_count; ++i) {
+      int root = find(static_cast<int>(i));
+      int &label = root_label[static_cast<size_t>(root)];
+      if (label < 0)
+        label = island_count++;
+      point_island[i] = label;
+    }
+  }
+};
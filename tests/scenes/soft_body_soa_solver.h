@@ -0,0 +1,322 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include "soft_body_types.h"
+#include "tests/component/simd.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Structure-of-arrays backend for soft_body_dirver.
+//
+// Points are mirrored into flat x/y arrays (padded to the SIMD width) so
+// integration runs four points per instruction. Segments are greedily
+// graph-colored so that no two segments of the same color share a point; each
+// color is then a batch whose segments can be projected in SIMD lanes without
+// write conflicts. Colors are processed one after another, which keeps the
+// Gauss-Seidel flavour of the AoS solver between batches.
+class soft_body_soa_solver {
+public:
+  struct integration_params {
+    glm::vec2 horizontal_bound;
+    glm::vec2 vertical_bound;
+    float boundary_tolerance;
+    float drag;
+    float bounce_damping;
+    float velocity_stop_threshold;
+  };
+
+public:
+  // Rebuild the colored segment batches. Call whenever segments or the point
+  // count change.
+  void build_batches(const std::vector<soft_body_segment> &_segments,
+                     size_t _point_count) {
+    m_segment_index1.clear();
+    m_segment_index2.clear();
+    m_segment_length.clear();
+    m_color_offsets.assign(1, 0);
+
+    // Greedy coloring with a 64-bit "colors in use" mask per point. Segments
+    // that find no free color (a point with more than 64 neighbours) are
+    // solved serially after the colored batches.
+    std::vector<std::uint64_t> used(_point_count, 0);
+    std::vector<int> segment_color(_segments.size(), -1);
+    std::vector<size_t> color_sizes;
+    std::vector<size_t> serial;
+    for (size_t i = 0; i < _segments.size(); ++i) {
+      const auto &s = _segments[i];
+      if (s.index1 < 0 || s.index2 < 0 ||
+          static_cast<size_t>(s.index1) >= _point_count ||
+          static_cast<size_t>(s.index2) >= _point_count ||
+          s.index1 == s.index2)
+        continue;
+      std::uint64_t taken = used[static_cast<size_t>(s.index1)] |
+                            used[static_cast<size_t>(s.index2)];
+      if (taken == ~std::uint64_t(0)) {
+        serial.push_back(i);
+        continue;
+      }
+      int color = 0;
+      while (taken & (std::uint64_t(1) << color))
+        ++color;
+      used[static_cast<size_t>(s.index1)] |= std::uint64_t(1) << color;
+      used[static_cast<size_t>(s.index2)] |= std::uint64_t(1) << color;
+      segment_color[i] = color;
+      if (static_cast<size_t>(color) >= color_sizes.size())
+        color_sizes.resize(static_cast<size_t>(color) + 1, 0);
+      ++color_sizes[static_cast<size_t>(color)];
+    }
+
+    // Stable counting sort of segments by color.
+    std::vector<size_t> cursor(color_sizes.size(), 0);
+    for (size_t c = 0; c < color_sizes.size(); ++c) {
+      cursor[c] = m_color_offsets.back();
+      m_color_offsets.push_back(m_color_offsets.back() + color_sizes[c]);
+    }
+    const size_t colored = m_color_offsets.back();
+    m_segment_index1.resize(colored + serial.size());
+    m_segment_index2.resize(colored + serial.size());
+    m_segment_length.resize(colored + serial.size());
+    for (size_t i = 0; i < _segments.size(); ++i) {
+      if (segment_color[i] < 0)
+        continue;
+      size_t slot = cursor[static_cast<size_t>(segment_color[i])]++;
+      m_segment_index1[slot] = _segments[i].index1;
+      m_segment_index2[slot] = _segments[i].index2;
+      m_segment_length[slot] = _segments[i].length;
+    }
+    for (size_t k = 0; k < serial.size(); ++k) {
+      const auto &s = _segments[serial[k]];
+      m_segment_index1[colored + k] = s.index1;
+      m_segment_index2[colored + k] = s.index2;
+      m_segment_length[colored + k] = s.length;
+    }
+  }
+
+  // Copy point state into the SoA arrays. Between gathers the arrays are the
+  // primary state; scatter() copies it back when the points are needed.
+  void gather(const std::vector<soft_body_point> &_points) {
+    m_point_count = _points.size();
+    const size_t padded =
+        (m_point_count + simd::k_lanes - 1) / simd::k_lanes * simd::k_lanes;
+    for (auto *array : {&m_x, &m_y, &m_vx, &m_vy, &m_ax, &m_ay, &m_last_x,
+                        &m_last_y, &m_inv_mass})
+      array->assign(padded, 0.0f);
+    for (size_t i = 0; i < m_point_count; ++i) {
+      const auto &p = _points[i];
+      m_x[i] = m_last_x[i] = p.position.x;
+      m_y[i] = m_last_y[i] = p.position.y;
+      m_vx[i] = p.velocity.x;
+      m_vy[i] = p.velocity.y;
+      m_ax[i] = p.acceleration.x;
+      m_ay[i] = p.acceleration.y;
+      m_inv_mass[i] = p.inverse_mass;
+    }
+  }
+
+  // Write positions and velocities back to the AoS points.
+  void scatter(std::vector<soft_body_point> &_points) const {
+    for (size_t i = 0; i < m_point_count && i < _points.size(); ++i) {
+      _points[i].position = glm::vec2(m_x[i], m_y[i]);
+      _points[i].velocity = glm::vec2(m_vx[i], m_vy[i]);
+    }
+  }
+
+  // Remember the start positions for velocity reconstruction; call before
+  // integrate().
+  void begin_step() {
+    m_last_x = m_x;
+    m_last_y = m_y;
+  }
+
+  void copy_positions(std::vector<glm::vec2> &_out) const {
+    _out.resize(m_point_count);
+    for (size_t i = 0; i < m_point_count; ++i)
+      _out[i] = glm::vec2(m_x[i], m_y[i]);
+  }
+
+  // Same integration as soft_body_dirver::update_point, four points at a
+  // time. Points with zero inverse mass keep their position and stop.
+  void integrate(float _delta_time, const integration_params &_params) {
+    using namespace simd;
+    const f32x4 dt = set1(_delta_time);
+    const f32x4 damping = set1(1.0f - _params.drag * _delta_time);
+    const f32x4 bounce = set1(-_params.bounce_damping);
+    const f32x4 x_lo =
+        set1(_params.horizontal_bound.x + _params.boundary_tolerance);
+    const f32x4 x_hi =
+        set1(_params.horizontal_bound.y - _params.boundary_tolerance);
+    const f32x4 y_lo =
+        set1(_params.vertical_bound.x + _params.boundary_tolerance);
+    const f32x4 y_hi =
+        set1(_params.vertical_bound.y - _params.boundary_tolerance);
+    const f32x4 stop2 = set1(_params.velocity_stop_threshold *
+                             _params.velocity_stop_threshold);
+    const f32x4 zero = set1(0.0f);
+
+    for (size_t i = 0; i < m_x.size(); i += k_lanes) {
+      f32x4 vx = mul(add(load(&m_vx[i]), mul(load(&m_ax[i]), dt)), damping);
+      f32x4 vy = mul(add(load(&m_vy[i]), mul(load(&m_ay[i]), dt)), damping);
+      f32x4 nx = add(load(&m_x[i]), mul(vx, dt));
+      f32x4 ny = add(load(&m_y[i]), mul(vy, dt));
+
+      f32x4 hit_x = mask_or(cmp_lt(nx, x_lo), cmp_gt(nx, x_hi));
+      f32x4 hit_y = mask_or(cmp_lt(ny, y_lo), cmp_gt(ny, y_hi));
+      vx = select(hit_x, mul(vx, bounce), vx);
+      vy = select(hit_y, mul(vy, bounce), vy);
+      nx = min(max(nx, x_lo), x_hi);
+      ny = min(max(ny, y_lo), y_hi);
+
+      f32x4 speed2 = add(mul(vx, vx), mul(vy, vy));
+      f32x4 stop = mask_and(mask_or(hit_x, hit_y), cmp_lt(speed2, stop2));
+      f32x4 free = cmp_gt(load(&m_inv_mass[i]), zero);
+      store(&m_vx[i], select(free, select(stop, zero, vx), zero));
+      store(&m_vy[i], select(free, select(stop, zero, vy), zero));
+      store(&m_x[i], select(free, nx, load(&m_x[i])));
+      store(&m_y[i], select(free, ny, load(&m_y[i])));
+    }
+  }
+
+  // Run _iterations sweeps of the distance constraints, batch by batch.
+  void project_segments(int _iterations) {
+    const size_t colors = color_count();
+    for (int iter = 0; iter < _iterations; ++iter) {
+      for (size_t c = 0; c < colors; ++c)
+        project_batch(m_color_offsets[c], m_color_offsets[c + 1]);
+      for (size_t s = m_color_offsets.back(); s < m_segment_length.size(); ++s)
+        project_one(s);
+    }
+  }
+
+  // Velocity = displacement over the step; tiny velocities snap to zero.
+  void update_velocities(float _delta_time, float _velocity_stop_threshold) {
+    using namespace simd;
+    const f32x4 inv_dt = set1(1.0f / _delta_time);
+    const f32x4 stop2 = set1(_velocity_stop_threshold * _velocity_stop_threshold);
+    const f32x4 zero = set1(0.0f);
+    for (size_t i = 0; i < m_x.size(); i += k_lanes) {
+      f32x4 vx = mul(sub(load(&m_x[i]), load(&m_last_x[i])), inv_dt);
+      f32x4 vy = mul(sub(load(&m_y[i]), load(&m_last_y[i])), inv_dt);
+      f32x4 slow = cmp_lt(add(mul(vx, vx), mul(vy, vy)), stop2);
+      store(&m_vx[i], select(slow, zero, vx));
+      store(&m_vy[i], select(slow, zero, vy));
+    }
+  }
+
+  // Point access for passes over the SoA state, such as the loop area
+  // correction and collision.
+  class point_view {
+  public:
+    explicit point_view(soft_body_soa_solver &_solver) : m_solver(_solver) {}
+    size_t size() const { return m_solver.m_point_count; }
+    glm::vec2 position(int _i) const {
+      return {m_solver.m_x[static_cast<size_t>(_i)],
+              m_solver.m_y[static_cast<size_t>(_i)]};
+    }
+    void set_position(int _i, glm::vec2 _p) {
+      m_solver.m_x[static_cast<size_t>(_i)] = _p.x;
+      m_solver.m_y[static_cast<size_t>(_i)] = _p.y;
+    }
+    glm::vec2 previous_position(int _i) const {
+      return {m_solver.m_last_x[static_cast<size_t>(_i)],
+              m_solver.m_last_y[static_cast<size_t>(_i)]};
+    }
+    float inverse_mass(int _i) const {
+      return m_solver.m_inv_mass[static_cast<size_t>(_i)];
+    }
+    void add_velocity(int _i, glm::vec2 _v) {
+      m_solver.m_vx[static_cast<size_t>(_i)] += _v.x;
+      m_solver.m_vy[static_cast<size_t>(_i)] += _v.y;
+    }
+
+  private:
+    soft_body_soa_solver &m_solver;
+  };
+
+  point_view points() { return point_view(*this); }
+
+  size_t color_count() const {
+    return m_color_offsets.empty() ? 0 : m_color_offsets.size() - 1;
+  }
+  size_t serial_segment_count() const {
+    return m_color_offsets.empty()
+               ? 0
+               : m_segment_length.size() - m_color_offsets.back();
+  }
+
+private:
+  void project_one(size_t _s) {
+    const size_t a = static_cast<size_t>(m_segment_index1[_s]);
+    const size_t b = static_cast<size_t>(m_segment_index2[_s]);
+    const float w1 = m_inv_mass[a];
+    const float w2 = m_inv_mass[b];
+    const float w = w1 + w2;
+    const float dx = m_x[b] - m_x[a];
+    const float dy = m_y[b] - m_y[a];
+    const float len = std::sqrt(dx * dx + dy * dy);
+    if (len < 1e-6f || w <= 0.0f)
+      return;
+    const float k = (len - m_segment_length[_s]) / (len * w);
+    m_x[a] += w1 * k * dx;
+    m_y[a] += w1 * k * dy;
+    m_x[b] -= w2 * k * dx;
+    m_y[b] -= w2 * k * dy;
+  }
+
+  void project_batch(size_t _begin, size_t _end) {
+    using namespace simd;
+    const f32x4 eps = set1(1e-6f);
+    const f32x4 zero = set1(0.0f);
+    size_t s = _begin;
+    for (; s + k_lanes <= _end; s += k_lanes) {
+      const int *ia = &m_segment_index1[s];
+      const int *ib = &m_segment_index2[s];
+      f32x4 xa = set(m_x[ia[0]], m_x[ia[1]], m_x[ia[2]], m_x[ia[3]]);
+      f32x4 ya = set(m_y[ia[0]], m_y[ia[1]], m_y[ia[2]], m_y[ia[3]]);
+      f32x4 xb = set(m_x[ib[0]], m_x[ib[1]], m_x[ib[2]], m_x[ib[3]]);
+      f32x4 yb = set(m_y[ib[0]], m_y[ib[1]], m_y[ib[2]], m_y[ib[3]]);
+      f32x4 w1 = set(m_inv_mass[ia[0]], m_inv_mass[ia[1]], m_inv_mass[ia[2]],
+                     m_inv_mass[ia[3]]);
+      f32x4 w2 = set(m_inv_mass[ib[0]], m_inv_mass[ib[1]], m_inv_mass[ib[2]],
+                     m_inv_mass[ib[3]]);
+
+      f32x4 dx = sub(xb, xa);
+      f32x4 dy = sub(yb, ya);
+      f32x4 len = sqrt(add(mul(dx, dx), mul(dy, dy)));
+      f32x4 w = add(w1, w2);
+      f32x4 valid = mask_and(cmp_gt(len, eps), cmp_gt(w, zero));
+      f32x4 k = div(sub(len, load(&m_segment_length[s])),
+                    mul(max(len, eps), max(w, eps)));
+      k = select(valid, k, zero);
+
+      float out[4][k_lanes];
+      store(out[0], add(xa, mul(mul(w1, k), dx)));
+      store(out[1], add(ya, mul(mul(w1, k), dy)));
+      store(out[2], sub(xb, mul(mul(w2, k), dx)));
+      store(out[3], sub(yb, mul(mul(w2, k), dy)));
+      for (int l = 0; l < k_lanes; ++l) {
+        m_x[ia[l]] = out[0][l];
+        m_y[ia[l]] = out[1][l];
+        m_x[ib[l]] = out[2][l];
+        m_y[ib[l]] = out[3][l];
+      }
+    }
+    for (; s < _end; ++s)
+      project_one(s);
+  }
+
+  size_t m_point_count = 0;
+  std::vector<float> m_x, m_y;
+  std::vector<float> m_vx, m_vy;
+  std::vector<float> m_ax, m_ay;
+  std::vector<float> m_last_x, m_last_y;
+  std::vector<float> m_inv_mass;
+
+  // Segments sorted by color; color c spans [m_color_offsets[c],
+  // m_color_offsets[c + 1]). Entries past m_color_offsets.back() are solved
+  // serially.
+  std::vector<int> m_segment_index1;
+  std::vector<int> m_segment_index2;
+  std::vector<float> m_segment_length;
+  std::vector<size_t> m_color_offsets;
+};
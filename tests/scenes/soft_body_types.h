@@ -0,0 +1,104 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include <cmath>
+#include <vector>
+
+struct soft_body_point {
+  glm::vec2 position;
+  glm::vec2 velocity;
+  glm::vec2 acceleration;
+  // Weight of the point in constraint and contact projection; 0 pins it in
+  // place. Both solver modes honor it.
+  float inverse_mass = 1.0f;
+};
+
+struct soft_body_segment {
+  int index1;
+  int index2;
+  float length;
+};
+
+// A closed ring of segments. The walk order of its points is cached in
+// point_order by rebuild_topology(); it only has to be redone when the
+// segment list changes (topology_dirty), so area/centroid queries and mesh
+// generation are single linear passes.
+struct soft_body_loop {
+  std::vector<int> segment_indices;
+  float area = 0.0f;
+  float rest_area = 0.0f;
+
+  std::vector<int> point_order;
+  bool topology_dirty = true;
+
+  void rebuild_topology(size_t _point_count,
+                        const std::vector<soft_body_segment> &_all_segments) {
+    topology_dirty = false;
+    point_order.clear();
+    const size_t n = _point_count;
+    if (n < 3 || segment_indices.empty())
+      return;
+    std::vector<std::vector<int>> adj(n);
+    for (int si : segment_indices) {
+      if (si < 0 || static_cast<size_t>(si) >= _all_segments.size())
+        continue;
+      const auto &s = _all_segments[static_cast<size_t>(si)];
+      size_t i1 = static_cast<size_t>(s.index1);
+      size_t i2 = static_cast<size_t>(s.index2);
+      if (i1 < n && i2 < n) {
+        adj[i1].push_back(static_cast<int>(s.index2));
+        adj[i2].push_back(static_cast<int>(s.index1));
+      }
+    }
+    int start = -1;
+    for (size_t i = 0; i < n; ++i)
+      if (!adj[i].empty()) {
+        start = static_cast<int>(i);
+        break;
+      }
+    if (start < 0)
+      return;
+    point_order.push_back(start);
+    int prev = start;
+    int cur = adj[static_cast<size_t>(start)][0];
+    while (cur != start && point_order.size() <= n) {
+      point_order.push_back(cur);
+      const auto &neighbors = adj[static_cast<size_t>(cur)];
+      int next = prev;
+      for (int v : neighbors)
+        if (v != prev) {
+          next = v;
+          break;
+        }
+      prev = cur;
+      cur = next;
+    }
+    if (point_order.size() < 3)
+      point_order.clear();
+  }
+
+  // Shoelace area over the cached point order. tView only needs
+  // position(i), so this works on either solver's point storage.
+  template <typename tView> float calc_area(const tView &_view) const {
+    const size_t count = point_order.size();
+    if (count < 3)
+      return 0.0f;
+    float sum = 0.0f;
+    glm::vec2 a = _view.position(point_order[count - 1]);
+    for (size_t i = 0; i < count; ++i) {
+      const glm::vec2 b = _view.position(point_order[i]);
+      sum += a.x * b.y - b.x * a.y;
+      a = b;
+    }
+    return 0.5f * std::abs(sum);
+  }
+
+  glm::vec2 calc_centroid(const std::vector<soft_body_point> &_points) const {
+    glm::vec2 centroid(0.0f);
+    if (point_order.empty())
+      return centroid;
+    for (int i : point_order)
+      centroid += _points[static_cast<size_t>(i)].position;
+    return centroid / static_cast<float>(point_order.size());
+  }
+};
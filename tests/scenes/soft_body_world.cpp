@@ -0,0 +1,132 @@
+#include "soft_body_world.h"
+
+#include "soft_body_islands.h"
+
+soft_body_world::soft_body_world(glm::vec2 _horizontal_bound,
+                                 glm::vec2 _vertical_bound, thread_pool *_pool)
+    : m_pool(_pool), m_prototype(_horizontal_bound, _vertical_bound) {}
+
+soft_body_dirver &soft_body_world::add_body() {
+  m_bodies.push_back(std::make_unique<soft_body_dirver>(m_prototype));
+  return *m_bodies.back();
+}
+
+void soft_body_world::split_islands() {
+  std::vector<std::unique_ptr<soft_body_dirver>> bodies;
+  bodies.reserve(m_bodies.size());
+  for (auto &body : m_bodies) {
+    auto parts = split_body(*body);
+    if (parts.empty()) {
+      bodies.push_back(std::move(body));
+      continue;
+    }
+    for (auto &part : parts)
+      bodies.push_back(std::move(part));
+  }
+  m_bodies = std::move(bodies);
+}
+
+std::vector<std::unique_ptr<soft_body_dirver>>
+soft_body_world::split_body(const soft_body_dirver &_body) const {
+  const auto &points = _body.get_points();
+  const auto &segments = _body.get_segments();
+  const auto &loops = _body.get_loops();
+
+  soft_body_islands islands;
+  islands.build(points.size(), segments);
+  if (islands.island_count <= 1)
+    return {};
+
+  // Islands without any segment are single loose points; keep them together
+  // in one body instead of spawning a job per point.
+  std::vector<bool> has_segment(static_cast<size_t>(islands.island_count),
+                                false);
+  for (const auto &s : segments) {
+    if (s.index1 >= 0 && static_cast<size_t>(s.index1) < points.size())
+      has_segment[static_cast<size_t>(
+          islands.point_island[static_cast<size_t>(s.index1)])] = true;
+  }
+  std::vector<int> island_group(static_cast<size_t>(islands.island_count), -1);
+  int group_count = 0;
+  int loose_group = -1;
+  for (int i = 0; i < islands.island_count; ++i) {
+    if (has_segment[static_cast<size_t>(i)]) {
+      island_group[static_cast<size_t>(i)] = group_count++;
+    } else {
+      if (loose_group < 0)
+        loose_group = group_count++;
+      island_group[static_cast<size_t>(i)] = loose_group;
+    }
+  }
+  if (group_count <= 1)
+    return {};
+
+  std::vector<std::unique_ptr<soft_body_dirver>> parts;
+  for (int g = 0; g < group_count; ++g) {
+    // Copy-then-clear keeps bounds, damping and solver settings.
+    parts.push_back(std::make_unique<soft_body_dirver>(_body));
+    parts.back()->clear();
+  }
+
+  auto group_of_point = [&](int _point) {
+    return island_group[static_cast<size_t>(
+        islands.point_island[static_cast<size_t>(_point)])];
+  };
+
+  std::vector<int> point_remap(points.size(), -1);
+  std::vector<int> group_point_count(static_cast<size_t>(group_count), 0);
+  for (size_t i = 0; i < points.size(); ++i) {
+    int g = group_of_point(static_cast<int>(i));
+    point_remap[i] = group_point_count[static_cast<size_t>(g)]++;
+    parts[static_cast<size_t>(g)]->add_point(points[i]);
+  }
+
+  std::vector<int> segment_remap(segments.size(), -1);
+  std::vector<int> group_segment_count(static_cast<size_t>(group_count), 0);
+  for (size_t i = 0; i < segments.size(); ++i) {
+    const auto &s = segments[i];
+    if (s.index1 < 0 || s.index2 < 0 ||
+        static_cast<size_t>(s.index1) >= points.size() ||
+        static_cast<size_t>(s.index2) >= points.size())
+      continue;
+    int g = group_of_point(s.index1);
+    soft_body_segment remapped = s;
+    remapped.index1 = point_remap[static_cast<size_t>(s.index1)];
+    remapped.index2 = point_remap[static_cast<size_t>(s.index2)];
+    segment_remap[i] = group_segment_count[static_cast<size_t>(g)]++;
+    parts[static_cast<size_t>(g)]->add_segment(remapped);
+  }
+
+  for (const auto &loop : loops) {
+    int g = -1;
+    soft_body_loop remapped;
+    for (int si : loop.segment_indices) {
+      if (si < 0 || static_cast<size_t>(si) >= segments.size() ||
+          segment_remap[static_cast<size_t>(si)] < 0)
+        continue;
+      if (g < 0)
+        g = group_of_point(segments[static_cast<size_t>(si)].index1);
+      remapped.segment_indices.push_back(
+          segment_remap[static_cast<size_t>(si)]);
+    }
+    if (g < 0)
+      continue;
+    soft_body_dirver &part = *parts[static_cast<size_t>(g)];
+    part.add_loop(remapped);
+    soft_body_loop &added = part.get_loop(part.get_loops().size() - 1);
+    added.area = loop.area;
+    added.rest_area = loop.rest_area;
+  }
+  return parts;
+}
+
+void soft_body_world::update(float _delta_time) {
+  if (!m_pool || m_bodies.size() < 2) {
+    for (auto &body : m_bodies)
+      body->update(_delta_time);
+    return;
+  }
+  m_pool->parallel_for(m_bodies.size(), [this, _delta_time](size_t _i) {
+    m_bodies[_i]->update(_delta_time);
+  });
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "soft_body_dirver.h"
+#include "tests/component/thread_pool.h"
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+// Owns many independent soft bodies and steps them in parallel.
+//
+// Each body is a soft_body_dirver filled through add_point/add_segment/
+// add_loop. split_islands() breaks bodies into their connected components so
+// that unconnected loops become separate bodies: they are then stepped as
+// separate jobs and never share solver state.
+class soft_body_world {
+public:
+  soft_body_world(glm::vec2 _horizontal_bound, glm::vec2 _vertical_bound,
+                  thread_pool *_pool = &thread_pool::instance());
+
+  // Create an empty body sharing the world's bounds and solver settings.
+  soft_body_dirver &add_body();
+
+  soft_body_dirver &get_body(size_t _index) { return *m_bodies[_index]; }
+  const soft_body_dirver &get_body(size_t _index) const {
+    return *m_bodies[_index];
+  }
+  size_t body_count() const { return m_bodies.size(); }
+
+  // Replace every body that has more than one island by one body per island.
+  // Loops keep their rest area; isolated points stay together in one body.
+  void split_islands();
+
+  // Step all bodies, one job per body.
+  void update(float _delta_time);
+
+  void clear() { m_bodies.clear(); }
+
+  // Settings copied into bodies created by add_body().
+  soft_body_dirver &prototype() { return m_prototype; }
+
+private:
+  std::vector<std::unique_ptr<soft_body_dirver>>
+  split_body(const soft_body_dirver &_body) const;
+
+  thread_pool *m_pool = nullptr;
+  soft_body_dirver m_prototype;
+  std::vector<std::unique_ptr<soft_body_dirver>> m_bodies;
+};
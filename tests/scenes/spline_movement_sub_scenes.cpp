@@ -1,5 +1,6 @@
 #include "spline_movement_sub_scenes.h"
 #include "GLFW/glfw3.h"
+#include "basic/render_state.h"
 #include "basic/shader.h"
 #include "glad/gl.h"
 #include "glm/fwd.hpp"
@@ -84,8 +85,8 @@ void spline_movement_snake_sub_scene::draw_spline() {
   {
     // Draw Spline
     // Render smooth connecting lines with better appearance
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    render_state::instance().enable(GL_BLEND);
+    render_state::instance().blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     m_shaders[spline_shader_type::k_spline]->use();
     m_shaders[spline_shader_type::k_spline]->set_uniform(
         "uLineWidth", m_snake_spline.m_init_length * 0.015f);
@@ -96,15 +97,16 @@ void spline_movement_snake_sub_scene::draw_spline() {
     m_line_strip_mesh_manager.bind();
     glDrawElements(GL_LINES, m_line_strip_mesh_manager.get_index_count(),
                    GL_UNSIGNED_INT, 0);
-    glDisable(GL_BLEND);
+    render_state::instance().disable(GL_BLEND);
   }
 }
 
 void spline_movement_snake_sub_scene::render() {
-  glEnable(GL_STENCIL_TEST);
-  glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-  glStencilFunc(GL_ALWAYS, 1, 0xFF);
-  glStencilMask(0xFF);
+  render_state &state = render_state::instance();
+  state.enable(GL_STENCIL_TEST);
+  state.stencil_op(GL_KEEP, GL_KEEP, GL_REPLACE);
+  state.stencil_func(GL_ALWAYS, 1, 0xFF);
+  state.stencil_mask(0xFF);
 
   for (auto &shader : m_shaders) {
     if (shader.first == spline_shader_type::k_control_points) {
@@ -116,9 +118,9 @@ void spline_movement_snake_sub_scene::render() {
   draw_spline();
   draw_attachments();
 
-  glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
-  glStencilMask(0x00);
-  glDisable(GL_DEPTH_TEST);
+  state.stencil_func(GL_NOTEQUAL, 1, 0xFF);
+  state.stencil_mask(0x00);
+  state.disable(GL_DEPTH_TEST);
 
   for (auto &shader : m_shaders) {
     if (shader.first == spline_shader_type::k_control_points) {
@@ -130,9 +132,9 @@ void spline_movement_snake_sub_scene::render() {
   draw_spline();
   draw_attachments();
 
-  glEnable(GL_DEPTH_TEST);
-  glStencilMask(0xFF);
-  glDisable(GL_STENCIL_TEST);
+  state.enable(GL_DEPTH_TEST);
+  state.stencil_mask(0xFF);
+  state.disable(GL_STENCIL_TEST);
 }
 
 void spline_movement_snake_sub_scene::render_ui() {
@@ -194,7 +196,7 @@ void spline_movement_snake_sub_scene::update_mesh_data() {
                              m_snake_spline.m_points.size() * sizeof(glm::vec3),
                              m_snake_spline.m_points.size(),
                              {vertex_attribute{3, GL_FLOAT, false}});
-  m_points_mesh_manager.setup_mesh(points_mesh_data);
+  m_points_mesh_manager.stream_mesh(points_mesh_data);
 
   // Setup line
   // Generate more points for smoother curve using Catmull-Rom spline
@@ -210,7 +212,7 @@ void spline_movement_snake_sub_scene::update_mesh_data() {
       m_smooth_points.data(), m_smooth_points.size() * sizeof(glm::vec3),
       line_strip_indices.data(), line_strip_indices.size(),
       {vertex_attribute{3, GL_FLOAT, false}});
-  m_line_strip_mesh_manager.setup_mesh(line_strip_mesh_data);
+  m_line_strip_mesh_manager.stream_mesh(line_strip_mesh_data);
 }
 
 spline_movement_lizard_sub_scene::spline_movement_lizard_sub_scene(
@@ -298,7 +300,7 @@ void spline_movement_lizard_sub_scene::update_mesh_data() {
                                  sizeof(glm::vec3),
                              attached_leg->get_points().size(),
                              {vertex_attribute{3, GL_FLOAT, false}});
-    m_legs_control_points_manager[i].setup_mesh(legs_mesh_data);
+    m_legs_control_points_manager[i].stream_mesh(legs_mesh_data);
 
     std::vector<unsigned int> line_strip_indices;
     // Create indices for line
@@ -311,7 +313,7 @@ void spline_movement_lizard_sub_scene::update_mesh_data() {
         attached_leg->get_points().size() * sizeof(glm::vec3),
         line_strip_indices.data(), line_strip_indices.size(),
         {vertex_attribute{3, GL_FLOAT, false}});
-    m_legs_line_strip_manager[i].setup_mesh(legs_line_strip_mesh_data);
+    m_legs_line_strip_manager[i].stream_mesh(legs_line_strip_mesh_data);
   }
 }
 
@@ -379,11 +381,14 @@ void soft_body_sub_scene::update(float _delta_time) {
 }
 
 void soft_body_sub_scene::update_mesh_data() {
-  std::vector<glm::vec2> coordinates;
-  for (auto &point : m_soft_body_dirver.get_points()) {
+  // Scratch buffers are members so their capacity survives across frames.
+  auto &coordinates = m_coordinates;
+  coordinates.clear();
+  for (auto &point : m_soft_body_dirver.get_render_points()) {
     coordinates.push_back(point.position);
   }
-  std::vector<unsigned int> segment_indices;
+  auto &segment_indices = m_segment_indices;
+  segment_indices.clear();
   for (auto &segment : m_soft_body_dirver.get_segments()) {
     segment_indices.push_back(segment.index1);
     segment_indices.push_back(segment.index2);
@@ -401,13 +406,13 @@ void soft_body_sub_scene::update_mesh_data() {
   mesh_data points_mesh_data(
       coordinates.data(), coordinates.size() * sizeof(glm::vec2),
       coordinates.size(), {vertex_attribute{2, GL_FLOAT, false}});
-  m_point_mesh.setup_mesh(points_mesh_data);
+  m_point_mesh.stream_mesh(points_mesh_data);
 
   mesh_data segment_mesh_data(coordinates.data(),
                               coordinates.size() * sizeof(glm::vec2),
                               segment_indices.data(), segment_indices.size(),
                               {vertex_attribute{2, GL_FLOAT, false}});
-  m_segment_mesh.setup_mesh(segment_mesh_data);
+  m_segment_mesh.stream_mesh(segment_mesh_data);
 }
 
 bool soft_body_sub_scene::on_mouse_button(int _button, int _action, int _mods) {
@@ -10,6 +10,7 @@
 #include <memory>
 #include <random>
 #include <string>
+#include <vector>
 
 // Forward declaration
 class spline_movement_scene;
@@ -105,6 +106,8 @@ protected:
   shader *m_segment_shader = nullptr;
   mesh_manager m_point_mesh;
   mesh_manager m_segment_mesh;
+  std::vector<glm::vec2> m_coordinates;
+  std::vector<unsigned int> m_segment_indices;
   object_type m_object_type = object_type::k_point;
 
   std::random_device m_random_device;
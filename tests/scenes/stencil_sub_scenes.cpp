@@ -1,6 +1,7 @@
 #include "stencil_sub_scenes.h"
 #include "stencil_test_scene.h"
 
+#include "basic/render_state.h"
 #include "glad/gl.h"
 #include "imgui.h"
 #include <glm/gtc/matrix_transform.hpp>
@@ -18,11 +19,12 @@ void stencil_object_outline_sub_scene::render() {
   if (!p->m_shader) {
     return;
   }
+  render_state &state = render_state::instance();
 
   // Configure stencil test for writing
-  glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-  glStencilFunc(GL_ALWAYS, 1, 0xFF);
-  glStencilMask(0xFF);
+  state.stencil_op(GL_KEEP, GL_KEEP, GL_REPLACE);
+  state.stencil_func(GL_ALWAYS, 1, 0xFF);
+  state.stencil_mask(0xFF);
 
   // Draw normal object and write to stencil buffer
   p->m_shader->use();
@@ -33,15 +35,14 @@ void stencil_object_outline_sub_scene::render() {
   p->m_shader->set_uniform("uAmbientStrength", p->m_ambient_strength);
   p->m_shader->set_uniform("uLightPosition", p->m_light_position);
   p->m_shader->set_uniform("uSpecularStrength", p->m_specular_strength);
-  p->m_shader->set_uniform("uEyePosition", p->m_camera.Position);
   p->m_shader->set_uniform("uShininess", p->m_shininess);
   p->m_shader->set_uniform("uDrawBoundaries", 0); // false = 0
   p->m_mesh.draw();
 
   // Draw boundary outline using stencil test
-  glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
-  glStencilMask(0x00); // Disable writing to stencil buffer
-  glDisable(GL_DEPTH_TEST);
+  state.stencil_func(GL_NOTEQUAL, 1, 0xFF);
+  state.stencil_mask(0x00); // Disable writing to stencil buffer
+  state.disable(GL_DEPTH_TEST);
 
   p->set_matrices(p->m_shader,
                   glm::translate(glm::mat4(1.0f), m_object_position) *
@@ -50,8 +51,8 @@ void stencil_object_outline_sub_scene::render() {
   p->m_shader->set_uniform("uBoundaryColor", m_boundary_color);
   p->m_mesh.draw();
 
-  glEnable(GL_DEPTH_TEST);
-  glStencilMask(0xFF); // Re-enable stencil writing for next frame
+  state.enable(GL_DEPTH_TEST);
+  state.stencil_mask(0xFF); // Re-enable stencil writing for next frame
 }
 
 void stencil_object_outline_sub_scene::render_ui() {
@@ -75,9 +76,10 @@ void stencil_mirror_sub_scene::render() {
   if (!p->m_shader) {
     return;
   }
+  render_state &state = render_state::instance();
 
   // Step 1: Draw scene normally (objects that will be reflected)
-  glStencilMask(0x00); // Disable writing to stencil buffer
+  state.stencil_mask(0x00); // Disable writing to stencil buffer
   p->m_shader->use();
   p->set_matrices(p->m_shader,
                   glm::translate(glm::mat4(1.0f), m_object_position));
@@ -86,19 +88,18 @@ void stencil_mirror_sub_scene::render() {
   p->m_shader->set_uniform("uAmbientStrength", p->m_ambient_strength);
   p->m_shader->set_uniform("uLightPosition", p->m_light_position);
   p->m_shader->set_uniform("uSpecularStrength", p->m_specular_strength);
-  p->m_shader->set_uniform("uEyePosition", p->m_camera.Position);
   p->m_shader->set_uniform("uShininess", p->m_shininess);
   p->m_shader->set_uniform("uDrawBoundaries", 0);
   p->m_mesh.draw();
 
   // Step 2: Draw mirror plane to stencil buffer (write stencil only, no
   // color/depth)
-  glStencilFunc(GL_ALWAYS, 1, 0xFF);
-  glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-  glStencilMask(0xFF); // Enable writing to stencil buffer
+  state.stencil_func(GL_ALWAYS, 1, 0xFF);
+  state.stencil_op(GL_KEEP, GL_KEEP, GL_REPLACE);
+  state.stencil_mask(0xFF); // Enable writing to stencil buffer
   glColorMask(GL_FALSE, GL_FALSE, GL_FALSE,
               GL_FALSE); // Disable color writing
-  glDepthMask(GL_FALSE); // Disable depth writing
+  state.depth_mask(false); // Disable depth writing
 
   // Draw mirror plane (using cube as placeholder - should be quad in future)
   glm::mat4 mirror_model = glm::translate(glm::mat4(1.0f), m_mirror_position) *
@@ -110,12 +111,12 @@ void stencil_mirror_sub_scene::render() {
 
   // Restore color and depth masks, disable stencil writing
   glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE); // Re-enable color writing
-  glDepthMask(GL_TRUE);                            // Re-enable depth writing
-  glStencilMask(0x00); // Disable writing to stencil buffer
+  state.depth_mask(true);                          // Re-enable depth writing
+  state.stencil_mask(0x00); // Disable writing to stencil buffer
 
   // Step 3: Draw reflected objects (clipped by stencil, with reflection
   // transform)
-  glStencilFunc(GL_EQUAL, 1, 0xFF); // Only draw where stencil == 1
+  state.stencil_func(GL_EQUAL, 1, 0xFF); // Only draw where stencil == 1
 
   // Calculate reflection matrix (reflect across X axis for YZ plane)
   glm::mat4 reflection_matrix = glm::mat4(1.0f);
@@ -133,7 +134,6 @@ void stencil_mirror_sub_scene::render() {
   p->m_shader->set_uniform("uAmbientStrength", p->m_ambient_strength);
   p->m_shader->set_uniform("uLightPosition", p->m_light_position);
   p->m_shader->set_uniform("uSpecularStrength", p->m_specular_strength);
-  p->m_shader->set_uniform("uEyePosition", p->m_camera.Position);
   p->m_shader->set_uniform("uShininess", p->m_shininess);
   p->m_shader->set_uniform("uDrawBoundaries", 0);
   // Scale down color to simulate reflection
@@ -142,11 +142,11 @@ void stencil_mirror_sub_scene::render() {
   p->m_mesh.draw();
 
   // Step 4: Draw mirror plane surface (with transparency, clipped by stencil)
-  glStencilFunc(GL_EQUAL, 1, 0xFF);       // Only draw where stencil == 1
-  glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP); // Don't modify stencil
-  glDisable(GL_DEPTH_TEST); // Disable depth test for mirror surface
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  state.stencil_func(GL_EQUAL, 1, 0xFF);       // Only draw where stencil == 1
+  state.stencil_op(GL_KEEP, GL_KEEP, GL_KEEP); // Don't modify stencil
+  state.disable(GL_DEPTH_TEST); // Disable depth test for mirror surface
+  state.enable(GL_BLEND);
+  state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
   p->set_matrices(p->m_shader, mirror_model);
   p->m_shader->set_uniform("uObjectColor",
@@ -155,9 +155,9 @@ void stencil_mirror_sub_scene::render() {
   p->m_mesh.draw(); // Draw mirror surface
 
   // Restore state
-  glDisable(GL_BLEND);
-  glEnable(GL_DEPTH_TEST);
-  glStencilMask(0xFF); // Re-enable stencil writing for next frame
+  state.disable(GL_BLEND);
+  state.enable(GL_DEPTH_TEST);
+  state.stencil_mask(0xFF); // Re-enable stencil writing for next frame
 }
 
 void stencil_mirror_sub_scene::render_ui() {
@@ -1,6 +1,7 @@
 #include "stencil_test_scene.h"
 #include "stencil_sub_scenes.h"
 
+#include "basic/render_state.h"
 #include "glad/gl.h"
 #include "imgui.h"
 #include "tests/component/mesh_manager.h"
@@ -18,7 +19,7 @@ void stencil_test_scene::init(GLFWwindow *_window) {
   renderable_scene_base::init(_window);
 
   // Enable stencil test
-  glEnable(GL_STENCIL_TEST);
+  render_state::instance().enable(GL_STENCIL_TEST);
 
   // Setup mesh using cube helper
   prefab_cube::cube_mesh_data cube_data(
@@ -1,5 +1,6 @@
 #include "texture_cube_scene.h"
 
+#include "basic/render_state.h"
 #include "glad/gl.h"
 #include "imgui.h"
 #include "tests/component/mesh_manager.h"
@@ -86,13 +87,12 @@ void texture_cube_scene::render() {
   set_matrices(m_shader);
   m_texture_cube->bind();
   m_shader->set_uniform("uTestMode", m_test_mode);
-  m_shader->set_uniform("uEyePosition", m_camera.Position);
   m_shader->set_uniform("uCubeMap", 0);
   m_shader->set_uniform("uRefractRatio", m_refract_ratio);
   m_mesh.draw();
 
-  glDepthMask(GL_FALSE);
-  glDepthFunc(GL_LEQUAL);
+  render_state::instance().depth_mask(false);
+  render_state::instance().depth_func(GL_LEQUAL);
   m_skybox_shader->use();
   m_skybox_shader->set_uniform("model", glm::mat4(1.0f));
   m_skybox_shader->set_uniform("view",
@@ -102,8 +102,8 @@ void texture_cube_scene::render() {
   m_texture_cube->bind();
   m_skybox_shader->set_uniform("uCubeMap", 0);
   m_skybox_mesh_manager.draw();
-  glDepthMask(GL_TRUE);
-  glDepthFunc(GL_LESS);
+  render_state::instance().depth_mask(true);
+  render_state::instance().depth_func(GL_LESS);
 }
 
 void texture_cube_scene::render_ui() {
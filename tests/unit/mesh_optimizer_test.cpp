@@ -0,0 +1,258 @@
+// Headless tests of tests/component/mesh_optimizer on a grid mesh.
+
+#include "tests/component/mesh_optimizer.h"
+#include "tests/unit/unit_check.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct grid_vertex {
+  float position[3];
+};
+
+// _size x _size quads of two triangles each, in row-major order
+struct grid_mesh {
+  std::vector<grid_vertex> vertices;
+  std::vector<unsigned int> indices;
+
+  explicit grid_mesh(unsigned int _size) {
+    for (unsigned int y = 0; y <= _size; ++y)
+      for (unsigned int x = 0; x <= _size; ++x)
+        vertices.push_back({{static_cast<float>(x), static_cast<float>(y),
+                             0.0f}});
+    for (unsigned int y = 0; y < _size; ++y) {
+      for (unsigned int x = 0; x < _size; ++x) {
+        const unsigned int v = y * (_size + 1) + x;
+        indices.insert(indices.end(), {v, v + 1, v + _size + 1});
+        indices.insert(indices.end(),
+                       {v + 1, v + _size + 2, v + _size + 1});
+      }
+    }
+  }
+};
+
+using triangle = std::array<unsigned int, 3>;
+
+std::vector<triangle> triangles_of(const std::vector<unsigned int> &_indices) {
+  std::vector<triangle> triangles(_indices.size() / 3);
+  for (size_t t = 0; t < triangles.size(); ++t)
+    triangles[t] = {_indices[t * 3], _indices[t * 3 + 1], _indices[t * 3 + 2]};
+  return triangles;
+}
+
+// Same triangles with the same winding, in any order
+bool same_triangles(const std::vector<unsigned int> &_a,
+                    const std::vector<unsigned int> &_b) {
+  std::vector<triangle> a = triangles_of(_a);
+  std::vector<triangle> b = triangles_of(_b);
+  std::sort(a.begin(), a.end());
+  std::sort(b.begin(), b.end());
+  return a == b;
+}
+
+void shuffle_triangles(std::vector<unsigned int> &_indices,
+                       std::uint32_t _seed) {
+  std::vector<triangle> triangles = triangles_of(_indices);
+  std::mt19937 rng(_seed);
+  // std::shuffle is implementation defined; a Fisher-Yates pass with the raw
+  // generator output keeps the input the same on every platform
+  for (size_t i = triangles.size(); i > 1; --i)
+    std::swap(triangles[i - 1], triangles[rng() % i]);
+  for (size_t t = 0; t < triangles.size(); ++t)
+    std::copy(triangles[t].begin(), triangles[t].end(),
+              _indices.begin() + static_cast<std::ptrdiff_t>(t * 3));
+}
+
+void test_analyze_vertex_cache() {
+  // Two triangles sharing an edge, then a disjoint one: 3 + 1 + 3 misses
+  const std::vector<unsigned int> shared = {0, 1, 2, 2, 1, 3, 4, 5, 6};
+  const vertex_cache_stats stats = analyze_vertex_cache(shared, 7);
+  check(stats.acmr == 7.0f / 3.0f, "ACMR of a shared edge is 7/3");
+  check(stats.atvr == 1.0f, "ATVR is 1 when every vertex misses once");
+
+  // With three entries the cache is FIFO, not LRU: vertex 0 is hit by the
+  // second triangle but still leaves first, so the third triangle misses it
+  const std::vector<unsigned int> fifo = {0, 1, 2, 0, 3, 4, 0, 5, 6};
+  check(analyze_vertex_cache(fifo, 7, 3).acmr == 8.0f / 3.0f,
+        "a hit does not refresh a vertex in the FIFO cache");
+
+  check(analyze_vertex_cache({}, 0).acmr == 0.0f,
+        "an empty index buffer has no misses");
+}
+
+void test_optimize_vertex_cache() {
+  const grid_mesh grid(32);
+  std::vector<unsigned int> indices = grid.indices;
+  shuffle_triangles(indices, 7);
+  const size_t vertex_count = grid.vertices.size();
+  const float shuffled_acmr = analyze_vertex_cache(indices, vertex_count).acmr;
+  const float row_major_acmr =
+      analyze_vertex_cache(grid.indices, vertex_count).acmr;
+
+  const std::vector<unsigned int> before = indices;
+  const std::vector<size_t> clusters =
+      optimize_vertex_cache(indices, vertex_count);
+  const float optimized_acmr = analyze_vertex_cache(indices, vertex_count).acmr;
+  std::printf("grid ACMR: shuffled %.3f, row-major %.3f, optimized %.3f\n",
+              shuffled_acmr, row_major_acmr, optimized_acmr);
+
+  check(same_triangles(before, indices),
+        "vertex cache optimization keeps every triangle and its winding");
+  check(optimized_acmr < shuffled_acmr,
+        "vertex cache optimization lowers ACMR of a shuffled grid");
+  check(optimized_acmr < row_major_acmr,
+        "vertex cache optimization beats row-major order");
+  check(!clusters.empty() && clusters.front() == 0,
+        "the first cluster starts at the first triangle");
+  check(std::is_sorted(clusters.begin(), clusters.end()) &&
+            clusters.back() < indices.size() / 3,
+        "clusters are ascending triangle offsets");
+}
+
+void test_optimize_overdraw() {
+  const grid_mesh grid(32);
+  std::vector<unsigned int> indices = grid.indices;
+  shuffle_triangles(indices, 11);
+  const size_t vertex_count = grid.vertices.size();
+  const std::vector<size_t> clusters =
+      optimize_vertex_cache(indices, vertex_count);
+  const std::vector<unsigned int> optimized = indices;
+
+  // A threshold of 0 never splits a cluster, so the output must be the
+  // clusters themselves in some order
+  std::vector<unsigned int> whole = optimized;
+  optimize_overdraw(whole, clusters, grid.vertices[0].position,
+                    sizeof(grid_vertex), vertex_count, 0.0f);
+  const std::vector<triangle> input = triangles_of(optimized);
+  const std::vector<triangle> output = triangles_of(whole);
+  bool whole_clusters = output.size() == input.size();
+  std::vector<bool> placed(clusters.size(), false);
+  for (size_t t = 0; whole_clusters && t < output.size();) {
+    // The cluster that starts with this triangle
+    size_t c = 0;
+    while (c < clusters.size() && input[clusters[c]] != output[t])
+      ++c;
+    if (c == clusters.size() || placed[c]) {
+      whole_clusters = false;
+      break;
+    }
+    placed[c] = true;
+    const size_t end =
+        c + 1 < clusters.size() ? clusters[c + 1] : input.size();
+    for (size_t i = clusters[c]; i < end; ++i, ++t) {
+      if (t >= output.size() || output[t] != input[i]) {
+        whole_clusters = false;
+        break;
+      }
+    }
+  }
+  check(whole_clusters, "overdraw optimization moves whole clusters only");
+
+  // With the default threshold clusters may be split, but triangles are
+  // still only moved, never changed
+  std::vector<unsigned int> split = optimized;
+  optimize_overdraw(split, clusters, grid.vertices[0].position,
+                    sizeof(grid_vertex), vertex_count);
+  check(same_triangles(optimized, split),
+        "overdraw optimization keeps every triangle and its winding");
+}
+
+void test_optimize_vertex_fetch() {
+  const grid_mesh grid(16);
+  std::vector<unsigned int> indices = grid.indices;
+  shuffle_triangles(indices, 3);
+  // An extra vertex no triangle uses is dropped
+  std::vector<grid_vertex> vertices = grid.vertices;
+  vertices.push_back({{-1.0f, -1.0f, -1.0f}});
+  const std::vector<unsigned int> old_indices = indices;
+  const std::vector<grid_vertex> old_vertices = vertices;
+
+  optimize_vertex_fetch(indices, vertices);
+
+  unsigned int next = 0;
+  bool first_use_order = true;
+  for (unsigned int index : indices) {
+    if (index > next)
+      first_use_order = false;
+    else if (index == next)
+      ++next;
+  }
+  check(first_use_order, "vertices are numbered in order of first use");
+  check(vertices.size() == grid.vertices.size(),
+        "unreferenced vertices are dropped");
+
+  bool same_geometry = indices.size() == old_indices.size();
+  for (size_t i = 0; same_geometry && i < indices.size(); ++i) {
+    const float *now = vertices[indices[i]].position;
+    const float *was = old_vertices[old_indices[i]].position;
+    same_geometry = std::equal(now, now + 3, was);
+  }
+  check(same_geometry, "every triangle corner keeps its position");
+}
+
+
+// Imported OBJ meshes are triangle soups, one vertex per corner, so the
+// cache never hits until the corners are welded back together
+void test_weld_vertices() {
+  const grid_mesh grid(16);
+  std::vector<unsigned int> indices;
+  std::vector<grid_vertex> vertices;
+  for (unsigned int index : grid.indices) {
+    indices.push_back(static_cast<unsigned int>(vertices.size()));
+    vertices.push_back(grid.vertices[index]);
+  }
+  shuffle_triangles(indices, 5);
+  const std::vector<unsigned int> soup_indices = indices;
+  const std::vector<grid_vertex> soup_vertices = vertices;
+  const float soup_acmr = analyze_vertex_cache(indices, vertices.size()).acmr;
+  check(soup_acmr == 3.0f, "every corner of a soup misses the cache");
+
+  weld_vertices(indices, vertices);
+  check(vertices.size() == grid.vertices.size(),
+        "welding merges the soup back to the grid vertices");
+  bool same_geometry = indices.size() == soup_indices.size();
+  for (size_t i = 0; same_geometry && i < indices.size(); ++i) {
+    const float *now = vertices[indices[i]].position;
+    const float *was = soup_vertices[soup_indices[i]].position;
+    same_geometry = std::equal(now, now + 3, was);
+  }
+  check(same_geometry, "welding keeps every triangle corner in place");
+  // Walking the soup vertices in order, each welded vertex first shows up
+  // right after the previous one
+  std::vector<unsigned int> welded_of(soup_vertices.size());
+  for (size_t i = 0; i < indices.size(); ++i)
+    welded_of[soup_indices[i]] = indices[i];
+  unsigned int next = 0;
+  bool first_copy_order = true;
+  for (unsigned int welded : welded_of) {
+    if (welded > next)
+      first_copy_order = false;
+    else if (welded == next)
+      ++next;
+  }
+  check(first_copy_order, "welded vertices keep the order of their first copy");
+
+  optimize_vertex_cache(indices, vertices.size());
+  const float welded_acmr = analyze_vertex_cache(indices, vertices.size()).acmr;
+  std::printf("soup ACMR: unwelded %.3f, welded and optimized %.3f\n",
+              soup_acmr, welded_acmr);
+  check(welded_acmr < 1.0f, "a welded soup optimizes like an indexed mesh");
+}
+
+} // namespace
+
+int main() {
+  test_analyze_vertex_cache();
+  test_optimize_vertex_cache();
+  test_optimize_overdraw();
+  test_optimize_vertex_fetch();
+  test_weld_vertices();
+  return check_result("mesh_optimizer_test");
+}
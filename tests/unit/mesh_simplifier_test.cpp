@@ -0,0 +1,160 @@
+// Headless tests of tests/component/mesh_simplifier on grid meshes, as
+// imported: a triangle soup that has to be welded first, and a grid with a
+// texture seam.
+
+#include "tests/component/mesh_optimizer.h"
+#include "tests/component/mesh_simplifier.h"
+#include "tests/unit/unit_check.h"
+
+#include <cmath>
+#include <cstdio>
+#include <set>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+struct grid_vertex {
+  float position[3];
+  float texture_coords[2];
+};
+
+// _size x _size quads of two triangles each, gently curved so that
+// simplification has some error to weigh
+grid_vertex grid_point(unsigned int _x, unsigned int _y, unsigned int _size) {
+  const float u = static_cast<float>(_x) / static_cast<float>(_size);
+  const float v = static_cast<float>(_y) / static_cast<float>(_size);
+  return {{u, v, 0.05f * std::sin(u * 3.0f) * std::cos(v * 2.0f)}, {u, v}};
+}
+
+// Every triangle corner is a vertex of its own, as OBJ files import
+void build_soup(unsigned int _size, std::vector<grid_vertex> &_vertices,
+                std::vector<unsigned int> &_indices) {
+  auto corner = [&](unsigned int _x, unsigned int _y) {
+    _indices.push_back(static_cast<unsigned int>(_vertices.size()));
+    _vertices.push_back(grid_point(_x, _y, _size));
+  };
+  for (unsigned int y = 0; y < _size; ++y) {
+    for (unsigned int x = 0; x < _size; ++x) {
+      corner(x, y);
+      corner(x + 1, y);
+      corner(x, y + 1);
+      corner(x + 1, y);
+      corner(x + 1, y + 1);
+      corner(x, y + 1);
+    }
+  }
+}
+
+// Indexed grid whose middle column of vertices exists twice: the left half
+// uses one copy and the right half the other, with its own texture
+// coordinates, like the seam between two texture charts
+struct seam_grid {
+  std::vector<grid_vertex> vertices;
+  std::vector<unsigned int> indices;
+  std::vector<char> right; // Vertex belongs to the right half
+
+  explicit seam_grid(unsigned int _size) {
+    const unsigned int seam = _size / 2;
+    std::vector<unsigned int> left_id((_size + 1) * (_size + 1));
+    std::vector<unsigned int> right_id(left_id.size());
+    for (unsigned int y = 0; y <= _size; ++y) {
+      for (unsigned int x = 0; x <= _size; ++x) {
+        const unsigned int g = y * (_size + 1) + x;
+        if (x <= seam) {
+          left_id[g] = add(grid_point(x, y, _size), false);
+        }
+        if (x >= seam) {
+          grid_vertex vertex = grid_point(x, y, _size);
+          vertex.texture_coords[0] += 1.0f;
+          right_id[g] = add(vertex, true);
+        }
+      }
+    }
+    for (unsigned int y = 0; y < _size; ++y) {
+      for (unsigned int x = 0; x < _size; ++x) {
+        const std::vector<unsigned int> &id = x < seam ? left_id : right_id;
+        const unsigned int g = y * (_size + 1) + x;
+        const unsigned int up = g + _size + 1;
+        indices.insert(indices.end(), {id[g], id[g + 1], id[up]});
+        indices.insert(indices.end(), {id[g + 1], id[up + 1], id[up]});
+      }
+    }
+  }
+
+  unsigned int add(const grid_vertex &_vertex, bool _right) {
+    vertices.push_back(_vertex);
+    right.push_back(_right ? 1 : 0);
+    return static_cast<unsigned int>(vertices.size() - 1);
+  }
+};
+
+void test_welded_soup() {
+  std::vector<grid_vertex> vertices;
+  std::vector<unsigned int> indices;
+  build_soup(16, vertices, indices);
+  const size_t target = indices.size() / 4 / 3 * 3;
+
+  // Unwelded, almost every vertex is a seam that no collapse can keep
+  // closed; only the two grid corners that belong to one triangle can move
+  const std::vector<unsigned int> unwelded =
+      simplify_mesh(indices, vertices[0].position, sizeof(grid_vertex),
+                    vertices.size(), target, 1.0f);
+  check(unwelded.size() + 6 >= indices.size(),
+        "an unwelded soup barely simplifies");
+
+  weld_vertices(indices, vertices);
+  check(vertices.size() == 17 * 17, "welding merges the soup to a grid");
+  float error = 0.0f;
+  const std::vector<unsigned int> welded =
+      simplify_mesh(indices, vertices[0].position, sizeof(grid_vertex),
+                    vertices.size(), target, 1.0f, &error);
+  std::printf("welded soup: %zu -> %zu triangles, error %.5f\n",
+              indices.size() / 3, welded.size() / 3, error);
+  check(welded.size() <= target, "a welded soup simplifies to the target");
+  check(error < 0.01f, "simplifying the gently curved grid stays close");
+}
+
+void test_seam() {
+  const seam_grid grid(16);
+  const size_t target = grid.indices.size() / 8 / 3 * 3;
+  float error = 0.0f;
+  const std::vector<unsigned int> indices =
+      simplify_mesh(grid.indices, grid.vertices[0].position,
+                    sizeof(grid_vertex), grid.vertices.size(), target, 1.0f,
+                    &error);
+  std::printf("seam grid: %zu -> %zu triangles, error %.5f\n",
+              grid.indices.size() / 3, indices.size() / 3, error);
+  check(indices.size() <= target,
+        "a mesh with a seam simplifies to the target");
+
+  // Every triangle keeps to one side, and both sides meet at the same seam
+  // positions, so no gap or texture smear opens along the seam
+  using position = std::tuple<float, float, float>;
+  std::set<position> seam_positions[2];
+  bool one_side = true;
+  for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+    const char side = grid.right[indices[t]];
+    for (int c = 0; c < 3; ++c) {
+      const unsigned int v = indices[t + c];
+      one_side = one_side && grid.right[v] == side;
+      const float *p = grid.vertices[v].position;
+      if (std::fabs(p[0] - 0.5f) < 1e-6f) {
+        seam_positions[static_cast<int>(side)].insert({p[0], p[1], p[2]});
+      }
+    }
+  }
+  check(one_side, "triangles use the vertices of their own side only");
+  check(seam_positions[0] == seam_positions[1],
+        "both sides meet at the same seam vertices");
+  check(seam_positions[0].size() < 17,
+        "vertices on the seam are collapsed along it");
+}
+
+} // namespace
+
+int main() {
+  test_welded_soup();
+  test_seam();
+  return check_result("mesh_simplifier_test");
+}
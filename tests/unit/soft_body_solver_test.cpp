@@ -0,0 +1,171 @@
+// Headless tests that the array-of-structs and structure-of-arrays modes of
+// soft_body_dirver simulate the same thing, including inverse mass.
+
+#include "tests/scenes/soft_body_dirver.h"
+#include "tests/unit/unit_check.h"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+const soft_body_solver_mode k_modes[] = {
+    soft_body_solver_mode::k_array_of_structs,
+    soft_body_solver_mode::k_structure_of_arrays,
+};
+
+soft_body_dirver make_driver(soft_body_solver_mode _mode) {
+  soft_body_dirver driver({-10.0f, 10.0f}, {-10.0f, 10.0f});
+  driver.m_solver_mode = _mode;
+  driver.m_body_collision = false;
+  return driver;
+}
+
+void add_segment(soft_body_dirver &_driver, int _a, int _b, float _length) {
+  soft_body_segment segment;
+  segment.index1 = _a;
+  segment.index2 = _b;
+  segment.length = _length;
+  _driver.add_segment(segment);
+}
+
+float max_distance(const std::vector<soft_body_point> &_a,
+                   const std::vector<soft_body_point> &_b) {
+  float worst = 0.0f;
+  for (size_t i = 0; i < _a.size() && i < _b.size(); ++i)
+    worst = std::max(worst, glm::length(_a[i].position - _b[i].position));
+  return _a.size() == _b.size() ? worst : INFINITY;
+}
+
+// One stretched segment, no gravity: the endpoints move by their share of
+// the inverse mass, the same in both modes.
+void test_weighted_segment() {
+  std::vector<soft_body_point> results[2];
+  for (int m = 0; m < 2; ++m) {
+    soft_body_dirver driver = make_driver(k_modes[m]);
+    driver.m_fixed_step = false;
+    soft_body_point a;
+    a.position = {0.0f, 0.0f};
+    soft_body_point b;
+    b.position = {1.0f, 0.0f};
+    b.inverse_mass = 0.25f;
+    driver.add_point(a);
+    driver.add_point(b);
+    add_segment(driver, 0, 1, 0.5f);
+    driver.step(1.0f / 60.0f, 1);
+    results[m] = driver.get_points();
+  }
+  for (const auto &points : results) {
+    // Total weight 1.25: the light end covers 0.4, the heavy end 0.1
+    check(std::fabs(points[0].position.x - 0.4f) < 1e-5f,
+          "the light endpoint takes four fifths of the correction");
+    check(std::fabs(points[1].position.x - 0.9f) < 1e-5f,
+          "the heavy endpoint takes one fifth of the correction");
+  }
+  check(max_distance(results[0], results[1]) < 1e-6f,
+        "both modes weight a single segment the same");
+}
+
+// A chain pinned at one end hangs under gravity. Segment order differs
+// between the modes (the SoA solver sweeps by color), so they only agree
+// once the chain has settled.
+void test_pinned_chain() {
+  const int count = 8;
+  std::vector<soft_body_point> results[2];
+  for (int m = 0; m < 2; ++m) {
+    soft_body_dirver driver = make_driver(k_modes[m]);
+    for (int i = 0; i < count; ++i) {
+      soft_body_point p;
+      p.position = {0.1f * static_cast<float>(i), 0.0f};
+      p.acceleration = {0.0f, -9.8f};
+      p.inverse_mass = i == 0 ? 0.0f : 1.0f;
+      driver.add_point(p);
+    }
+    for (int i = 0; i + 1 < count; ++i)
+      add_segment(driver, i, i + 1, 0.1f);
+    for (int frame = 0; frame < 600; ++frame)
+      driver.update(1.0f / 60.0f);
+    results[m] = driver.get_points();
+
+    const auto &points = results[m];
+    check(points[0].position == glm::vec2(0.0f) &&
+              points[0].velocity == glm::vec2(0.0f),
+          "a point with zero inverse mass stays pinned");
+    // Velocities below the stop threshold snap to zero, so the chain can
+    // come to rest slightly off vertical
+    check(std::fabs(points[count - 1].position.x) < 0.1f &&
+              points[count - 1].position.y < -0.6f,
+          "the chain hangs straight down from the pinned point");
+  }
+  check(max_distance(results[0], results[1]) < 0.01f,
+        "both modes settle the pinned chain in the same place");
+}
+
+// A free loop falling onto the floor comes to rest in the same place in both
+// modes.
+void test_falling_loop() {
+  const int count = 24;
+  std::vector<soft_body_point> results[2];
+  for (int m = 0; m < 2; ++m) {
+    soft_body_dirver driver = make_driver(k_modes[m]);
+    soft_body_loop loop;
+    for (int i = 0; i < count; ++i) {
+      const float t = static_cast<float>(i) * 2.0f * 3.14159265f /
+                      static_cast<float>(count);
+      soft_body_point p;
+      p.position = {0.5f * std::cos(t), 2.0f + 0.5f * std::sin(t)};
+      p.acceleration = {0.0f, -9.8f};
+      driver.add_point(p);
+    }
+    for (int i = 0; i < count; ++i) {
+      const int j = (i + 1) % count;
+      add_segment(driver, i, j,
+                  glm::length(driver.get_point(i).position -
+                              driver.get_point(j).position));
+      loop.segment_indices.push_back(i);
+    }
+    driver.add_loop(loop);
+    for (int frame = 0; frame < 600; ++frame)
+      driver.update(1.0f / 60.0f);
+    results[m] = driver.get_points();
+  }
+  glm::vec2 centroid[2] = {glm::vec2(0.0f), glm::vec2(0.0f)};
+  for (int m = 0; m < 2; ++m) {
+    for (const auto &p : results[m])
+      centroid[m] += p.position / static_cast<float>(count);
+    check(centroid[m].y < -9.0f, "the loop falls to the floor");
+  }
+  check(glm::length(centroid[0] - centroid[1]) < 0.02f,
+        "both modes bring the loop to rest in the same place");
+}
+
+// The SoA mode keeps its own copy of the points between steps; reads and
+// writes through the driver's accessors have to see and reach that copy.
+void test_point_access() {
+  for (auto mode : k_modes) {
+    soft_body_dirver driver = make_driver(mode);
+    driver.m_fixed_step = false;
+    soft_body_point p;
+    p.acceleration = {0.0f, -9.8f};
+    driver.add_point(p);
+    driver.update(1.0f / 60.0f);
+    const float fallen = driver.get_points()[0].position.y;
+    check(fallen < 0.0f, "get_points() sees the last step");
+
+    driver.get_point(0).position = {1.0f, 5.0f};
+    driver.update(1.0f / 60.0f);
+    const glm::vec2 moved = driver.get_points()[0].position;
+    check(moved.x == 1.0f && moved.y < 5.0f && moved.y > 4.9f,
+          "a write through get_point() is used by the next step");
+  }
+}
+
+} // namespace
+
+int main() {
+  test_weighted_segment();
+  test_pinned_chain();
+  test_falling_loop();
+  test_point_access();
+  return check_result("soft_body_solver_test");
+}
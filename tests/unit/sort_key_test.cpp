@@ -0,0 +1,125 @@
+// Headless tests of draw packet keys and their radix sort in
+// tests/component/sort_key.
+
+#include "tests/component/sort_key.h"
+#include "tests/unit/unit_check.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+bool sorts_like_stable_sort(std::vector<keyed_index> _items) {
+  std::vector<keyed_index> expected = _items;
+  std::stable_sort(expected.begin(), expected.end(),
+                   [](const keyed_index &_a, const keyed_index &_b) {
+                     return _a.key < _b.key;
+                   });
+  std::vector<keyed_index> scratch;
+  radix_sort(_items, scratch);
+  return std::equal(_items.begin(), _items.end(), expected.begin(),
+                    expected.end(),
+                    [](const keyed_index &_a, const keyed_index &_b) {
+                      return _a.key == _b.key && _a.index == _b.index;
+                    });
+}
+
+// _count items with the key bits outside _mask cleared; a narrow mask gives
+// many equal keys and leaves most byte passes to be skipped
+std::vector<keyed_index> random_items(std::mt19937_64 &_rng, size_t _count,
+                                      sort_key _mask) {
+  std::vector<keyed_index> items(_count);
+  for (size_t i = 0; i < _count; ++i)
+    items[i] = {_rng() & _mask, static_cast<std::uint32_t>(i)};
+  return items;
+}
+
+void test_radix_sort() {
+  std::mt19937_64 rng(1);
+  for (size_t count : {0, 1, 2, 3, 17, 1000, 100000}) {
+    check(sorts_like_stable_sort(random_items(rng, count, ~sort_key(0))),
+          "random 64-bit keys sort like std::stable_sort");
+  }
+  // Equal keys keep their order, so many duplicates test stability
+  check(sorts_like_stable_sort(random_items(rng, 5000, 0x7)),
+        "duplicate keys keep their submission order");
+  // Only one byte differs, so seven passes are skipped
+  check(sorts_like_stable_sort(random_items(rng, 5000, 0xff0000)),
+        "keys that differ in one byte sort in a single pass");
+  check(sorts_like_stable_sort(
+            random_items(rng, 5000, 0xff000000000000ffull)),
+        "keys that differ in the lowest and highest bytes sort");
+  check(sorts_like_stable_sort(random_items(rng, 5000, 0)),
+        "identical keys are left in place");
+
+  // Real keys: a few programs and textures, random depths, some transparent
+  std::vector<keyed_index> packets(20000);
+  for (size_t i = 0; i < packets.size(); ++i) {
+    const float depth = static_cast<float>(rng() % 1000) / 1000.0f;
+    const auto program = static_cast<std::uint32_t>(rng() % 4);
+    const auto texture = static_cast<std::uint32_t>(rng() % 8);
+    packets[i].key = rng() % 4 == 0
+                         ? make_transparent_key(program, 1, texture, depth)
+                         : make_opaque_key(program, 1, texture, depth);
+    packets[i].index = static_cast<std::uint32_t>(i);
+  }
+  check(sorts_like_stable_sort(packets),
+        "draw packet keys sort like std::stable_sort");
+}
+
+void test_opaque_keys() {
+  check(make_opaque_key(0x7fff, 0xffff, 0xffff, 1.0f) <
+            make_transparent_key(0, 0, 0, 0.0f),
+        "every opaque key sorts before every transparent key");
+  check(!is_transparent_key(make_opaque_key(3, 4, 5, 0.5f)) &&
+            is_transparent_key(make_transparent_key(3, 4, 5, 0.5f)),
+        "keys record whether they are transparent");
+  check(make_opaque_key(1, 2, 3, 0.1f) < make_opaque_key(1, 2, 3, 0.9f),
+        "opaque packets with the same state sort front to back");
+  check(make_opaque_key(1, 2, 3, 1.0f) < make_opaque_key(2, 0, 0, 0.0f),
+        "program takes precedence over depth");
+  check(make_opaque_key(1, 2, 9, 1.0f) < make_opaque_key(1, 3, 0, 0.0f),
+        "vertex array takes precedence over texture");
+  check(make_opaque_key(1, 2, 3, 1.0f) < make_opaque_key(1, 2, 4, 0.0f),
+        "texture takes precedence over depth");
+}
+
+void test_transparent_keys() {
+  check(make_transparent_key(1, 2, 3, 0.9f) <
+            make_transparent_key(1, 2, 3, 0.1f),
+        "transparent packets sort back to front");
+  check(make_transparent_key(7, 7, 7, 0.9f) <
+            make_transparent_key(0, 0, 0, 0.1f),
+        "depth takes precedence over state for transparent packets");
+  check(make_transparent_key(0, 0, 0, 0.5f) <
+            make_transparent_key(1, 0, 0, 0.5f),
+        "transparent packets at one depth are grouped by program");
+}
+
+void test_quantize_depth() {
+  check(quantize_depth(0.0f, 16) == 0 && quantize_depth(1.0f, 16) == 0xffff,
+        "the near and far planes map to the ends of the range");
+  check(quantize_depth(-3.0f, 16) == 0 && quantize_depth(3.0f, 16) == 0xffff,
+        "depths outside [0, 1] are clamped");
+  check(quantize_depth(std::numeric_limits<float>::quiet_NaN(), 16) == 0 &&
+            quantize_depth(std::numeric_limits<float>::quiet_NaN(), 24) == 0,
+        "NaN maps to 0");
+  check(quantize_depth(std::numeric_limits<float>::infinity(), 24) ==
+            0xffffff,
+        "infinity is clamped to the far plane");
+  check(quantize_depth(0.5f, 16) == 0x8000,
+        "the middle of the range rounds to the nearest step");
+}
+
+} // namespace
+
+int main() {
+  test_radix_sort();
+  test_opaque_keys();
+  test_transparent_keys();
+  test_quantize_depth();
+  return check_result("sort_key_test");
+}
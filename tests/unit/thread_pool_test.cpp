@@ -0,0 +1,86 @@
+// Headless tests of tests/component/thread_pool.
+
+#include "tests/component/thread_pool.h"
+#include "tests/unit/unit_check.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void test_parallel_for() {
+  thread_pool pool(3);
+  for (size_t count : {1, 7, 1000, 100000}) {
+    for (size_t grain : {1, 16, 4096}) {
+      std::vector<std::atomic<int>> visits(count);
+      pool.parallel_for(
+          count, [&](size_t _i) { visits[_i].fetch_add(1); }, grain);
+      bool once = true;
+      for (const auto &v : visits)
+        once = once && v.load() == 1;
+      check(once, "parallel_for visits every index exactly once");
+    }
+  }
+}
+
+void test_nested_parallel_for() {
+  thread_pool pool(3);
+  std::atomic<size_t> sum{0};
+  pool.parallel_for(
+      16,
+      [&](size_t _outer) {
+        pool.parallel_for(
+            100, [&](size_t _inner) { sum.fetch_add(_outer * 100 + _inner); },
+            10);
+      },
+      1);
+  check(sum.load() == 1600 * 1599 / 2,
+        "parallel_for inside a parallel_for chunk completes");
+}
+
+// A parallel_for must not pick up unrelated queued jobs. The worker takes
+// chunk 1, queues a long job and stays busy for a while; the caller, done
+// with chunk 0, has to wait for chunk 1 without running the long job.
+void test_parallel_for_skips_foreign_jobs() {
+  thread_pool pool(1);
+  std::atomic<bool> release{false};
+  std::atomic<int> foreign_on_caller{0};
+  const std::thread::id caller = std::this_thread::get_id();
+  auto long_job = [&] {
+    if (std::this_thread::get_id() == caller)
+      foreign_on_caller.fetch_add(1);
+    // Bounded, so a regression fails the check instead of hanging
+    const auto give_up =
+        std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!release.load() && std::chrono::steady_clock::now() < give_up)
+      std::this_thread::yield();
+  };
+
+  pool.parallel_for(
+      2,
+      [&](size_t _i) {
+        if (_i == 0) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(20));
+          return;
+        }
+        pool.submit(long_job);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      },
+      1);
+  check(foreign_on_caller.load() == 0,
+        "parallel_for does not run queued jobs of others");
+
+  release = true;
+  pool.wait_idle();
+}
+
+} // namespace
+
+int main() {
+  test_parallel_for();
+  test_nested_parallel_for();
+  test_parallel_for_skips_foreign_jobs();
+  return check_result("thread_pool_test");
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// Checks for the headless unit tests in this directory. A failed check is
+// reported and counted instead of aborting, so one run lists every failure;
+// main() returns check_result() for ctest.
+
+#include <cstdio>
+
+inline int &check_failures() {
+  static int failures = 0;
+  return failures;
+}
+
+inline void check(bool _condition, const char *_what) {
+  if (!_condition) {
+    std::printf("FAILED: %s\n", _what);
+    ++check_failures();
+  }
+}
+
+// Print a summary and return the process exit code
+inline int check_result(const char *_test_name) {
+  if (check_failures() == 0) {
+    std::printf("%s: all checks passed\n", _test_name);
+    return 0;
+  }
+  std::printf("%s: %d checks failed\n", _test_name, check_failures());
+  return 1;
+}
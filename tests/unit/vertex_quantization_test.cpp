@@ -0,0 +1,169 @@
+// Headless tests of the round-trip error of the conversions in
+// tests/component/vertex_quantization.
+
+#include "tests/component/vertex_quantization.h"
+#include "tests/unit/unit_check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+
+namespace {
+
+void test_unorm16() {
+  // Half a step, plus the float rounding of the division in the decoder
+  const double bound = 0.5 / 65535.0 + 1e-7;
+  double worst = 0.0;
+  const int samples = 1 << 20;
+  for (int i = 0; i <= samples; ++i) {
+    const float value = static_cast<float>(i) / samples;
+    const double error =
+        std::fabs(static_cast<double>(dequantize_unorm16(
+                      quantize_unorm16(value))) -
+                  value);
+    worst = std::max(worst, error);
+  }
+  std::printf("unorm16: worst error %.3g steps\n", worst * 65535.0);
+  check(worst <= bound, "unorm16 round trip is within half a step");
+  check(quantize_unorm16(0.0f) == 0 && quantize_unorm16(1.0f) == 65535,
+        "unorm16 maps the ends of [0, 1] exactly");
+  check(quantize_unorm16(-0.5f) == 0 && quantize_unorm16(2.0f) == 65535,
+        "unorm16 clamps values outside [0, 1]");
+}
+
+bool is_half_nan(std::uint16_t _half) {
+  return (_half & 0x7c00) == 0x7c00 && (_half & 0x3ff) != 0;
+}
+
+void test_half() {
+  check(float_to_half(1.0f) == 0x3c00, "1 converts to 0x3c00");
+  check(float_to_half(-2.0f) == 0xc000, "-2 converts to 0xc000");
+  check(float_to_half(65504.0f) == 0x7bff, "the largest half is exact");
+
+  // Ties go to the even mantissa
+  check(float_to_half(1.0f + std::ldexp(1.0f, -11)) == 0x3c00,
+        "a tie between 0x3c00 and 0x3c01 rounds to 0x3c00");
+  check(float_to_half(1.0f + 3.0f * std::ldexp(1.0f, -11)) == 0x3c02,
+        "a tie between 0x3c01 and 0x3c02 rounds to 0x3c02");
+  check(float_to_half(1.0f + std::ldexp(1.0f, -11) + std::ldexp(1.0f, -20)) ==
+            0x3c01,
+        "just above a tie rounds up");
+
+  // Subnormal halves
+  check(float_to_half(std::ldexp(1.0f, -24)) == 0x0001,
+        "2^-24 is the smallest subnormal half");
+  check(half_to_float(0x0001) == std::ldexp(1.0f, -24),
+        "the smallest subnormal half converts back exactly");
+  check(float_to_half(std::ldexp(1.0f, -25)) == 0x0000,
+        "a tie between zero and the smallest subnormal rounds to zero");
+  check(float_to_half(3.0f * std::ldexp(1.0f, -25)) == 0x0002,
+        "a subnormal tie rounds to the even mantissa");
+  check(float_to_half(std::ldexp(1.0f, -30)) == 0x0000,
+        "values far below the subnormal range become zero");
+  check(float_to_half(-std::ldexp(1.0f, -30)) == 0x8000,
+        "negative values that underflow keep their sign");
+  check(float_to_half(std::ldexp(1023.0f, -24)) == 0x03ff,
+        "the largest subnormal half is exact");
+
+  // Overflow, infinity and NaN
+  check(float_to_half(65520.0f) == 0x7c00,
+        "the tie above the largest half rounds to infinity");
+  check(float_to_half(1e6f) == 0x7c00, "overflow becomes infinity");
+  check(float_to_half(-1e6f) == 0xfc00, "negative overflow becomes -infinity");
+  check(float_to_half(std::numeric_limits<float>::infinity()) == 0x7c00,
+        "infinity stays infinity");
+  check(is_half_nan(float_to_half(std::numeric_limits<float>::quiet_NaN())),
+        "NaN stays NaN");
+  check(std::isnan(half_to_float(0x7e00)), "a NaN half converts to NaN");
+
+  // Every half that is not NaN survives a round trip through float
+  bool exact = true;
+  for (std::uint32_t half = 0; half <= 0xffff; ++half) {
+    const auto value = static_cast<std::uint16_t>(half);
+    if (!is_half_nan(value) && float_to_half(half_to_float(value)) != value)
+      exact = false;
+  }
+  check(exact, "every half converts to float and back unchanged");
+
+  // Normal values are within half an ulp, 2^-11 relative
+  double worst = 0.0;
+  for (float value = std::ldexp(1.0f, -14); value < 65504.0f;
+       value *= 1.000173f) {
+    const double error =
+        std::fabs(static_cast<double>(half_to_float(float_to_half(value))) -
+                  value) /
+        value;
+    worst = std::max(worst, error);
+  }
+  std::printf("half: worst relative error %.3g\n", worst);
+  check(worst <= std::ldexp(1.0, -11),
+        "half round trip of normal values is within half an ulp");
+}
+
+// Angle between two vectors in degrees, accurate for small angles
+double angle_degrees(const glm::vec3 &_a, const glm::vec3 &_b) {
+  const double dx = static_cast<double>(_a.x) - _b.x;
+  const double dy = static_cast<double>(_a.y) - _b.y;
+  const double dz = static_cast<double>(_a.z) - _b.z;
+  const double chord = std::sqrt(dx * dx + dy * dy + dz * dz);
+  return 2.0 * std::asin(std::min(chord * 0.5, 1.0)) * 180.0 /
+         3.14159265358979323846;
+}
+
+double octahedral_error(const glm::vec3 &_normal) {
+  std::uint16_t encoded[2];
+  encode_octahedral_unorm16(_normal, encoded);
+  return angle_degrees(decode_octahedral_unorm16(encoded), _normal);
+}
+
+void test_octahedral() {
+  // Grid points are 2/65535 apart; picking the best of the four around the
+  // exact encoding keeps every direction within a hundredth of a degree
+  const double bound = 0.01;
+
+  const glm::vec3 axes[] = {{1, 0, 0},  {-1, 0, 0}, {0, 1, 0},
+                            {0, -1, 0}, {0, 0, 1},  {0, 0, -1}};
+  double worst_axis = 0.0;
+  for (const glm::vec3 &axis : axes)
+    worst_axis = std::max(worst_axis, octahedral_error(axis));
+  check(worst_axis <= bound, "the six axes encode within the bound");
+
+  // Sphere sweep by latitude and longitude; the lower half goes through the
+  // fold of the encoding
+  double worst_upper = 0.0;
+  double worst_lower = 0.0;
+  const int rings = 256;
+  const int segments = 512;
+  for (int ring = 0; ring <= rings; ++ring) {
+    const double theta = 3.14159265358979323846 * ring / rings;
+    for (int segment = 0; segment < segments; ++segment) {
+      const double phi = 2.0 * 3.14159265358979323846 * segment / segments;
+      const glm::vec3 normal(
+          static_cast<float>(std::sin(theta) * std::cos(phi)),
+          static_cast<float>(std::sin(theta) * std::sin(phi)),
+          static_cast<float>(std::cos(theta)));
+      const double error = octahedral_error(normal);
+      if (normal.z < 0.0f)
+        worst_lower = std::max(worst_lower, error);
+      else
+        worst_upper = std::max(worst_upper, error);
+    }
+  }
+  std::printf("octahedral: worst error %.3g deg (z >= 0), %.3g deg (z < 0), "
+              "%.3g deg (axes)\n",
+              worst_upper, worst_lower, worst_axis);
+  check(worst_upper <= bound, "upper hemisphere encodes within the bound");
+  check(worst_lower <= bound,
+        "lower hemisphere, folded, encodes within the bound");
+}
+
+} // namespace
+
+int main() {
+  test_unorm16();
+  test_half();
+  test_octahedral();
+  return check_result("vertex_quantization_test");
+}